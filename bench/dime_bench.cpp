@@ -0,0 +1,822 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+//
+// dime_bench - reproducible benchmarks for DIME.
+//
+// Builds a synthetic model from a fixed seed (or loads a DXF file given
+// with -i), and times parsing, reading, writing, traversal and
+// conversion. Results are written as JSON, one object per benchmark,
+// with the best time of all repetitions. Allocation counts are for a
+// single repetition, and count calls to operator new only. Peak RSS is
+// the peak of the whole process so far.
+//
+// With -t, read_parallel reads and converts one model per thread at the
+// same time and checks that all threads get the same result. Build with
+// -DDIME_SANITIZER=thread to use it as a stress test for thread safety.
+//
+
+#include <dime/Input.h>
+#include <dime/Output.h>
+#include <dime/Model.h>
+#include <dime/State.h>
+#include <dime/convert/convert.h>
+#include <dime/entities/3DFace.h>
+#include <dime/entities/Arc.h>
+#include <dime/entities/Block.h>
+#include <dime/entities/Circle.h>
+#include <dime/entities/Insert.h>
+#include <dime/entities/Line.h>
+#include <dime/records/Record.h>
+#include <dime/sections/BlocksSection.h>
+#include <dime/sections/EntitiesSection.h>
+#include <dime/sections/TablesSection.h>
+#include <dime/tables/LayerTable.h>
+#include <dime/tables/Table.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#define NUM_LAYERS 16
+#define NUM_BLOCKS 32
+#define BLOCK_SIZE 16
+
+//
+// allocation counting. operator new is replaced on all platforms. With
+// glibc, malloc(), calloc() and realloc() are interposed as well, so
+// that buffers the library allocates directly are counted. Elsewhere,
+// and in sanitizer builds which interpose malloc themselves, only
+// operator new is counted.
+//
+
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+#define BENCH_SANITIZER
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer) || __has_feature(thread_sanitizer)
+#define BENCH_SANITIZER
+#endif
+#endif
+
+#if defined(__GLIBC__) && !defined(BENCH_SANITIZER)
+#define BENCH_COUNT_MALLOC
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t num, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+extern "C" void __libc_free(void* ptr);
+#define RAW_MALLOC __libc_malloc
+#define RAW_FREE __libc_free
+#else
+// free() is kept out of line, since GCC warns when it sees free()
+// called on a pointer from operator new
+#ifdef __GNUC__
+__attribute__((noinline))
+#endif
+static void
+bench_free(void* ptr)
+{
+	free(ptr);
+}
+#define RAW_MALLOC malloc
+#define RAW_FREE bench_free
+#endif
+
+static std::atomic<long long> numallocs(0);
+static std::atomic<long long> allocbytes(0);
+
+static void
+count_alloc(const size_t size)
+{
+	numallocs++;
+	allocbytes += size;
+}
+
+#ifdef BENCH_COUNT_MALLOC
+
+extern "C" void*
+malloc(size_t size) noexcept
+{
+	count_alloc(size);
+	return __libc_malloc(size);
+}
+
+extern "C" void*
+calloc(size_t num, size_t size) noexcept
+{
+	count_alloc(num * size);
+	return __libc_calloc(num, size);
+}
+
+extern "C" void*
+realloc(void* ptr, size_t size) noexcept
+{
+	if (size) count_alloc(size);
+	return __libc_realloc(ptr, size);
+}
+
+extern "C" void
+free(void* ptr) noexcept
+{
+	__libc_free(ptr);
+}
+
+#endif // BENCH_COUNT_MALLOC
+
+void*
+operator new(size_t size)
+{
+	count_alloc(size);
+	void* ptr = RAW_MALLOC(size ? size : 1);
+	if (!ptr) throw std::bad_alloc();
+	return ptr;
+}
+
+void*
+operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void*
+operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	count_alloc(size);
+	return RAW_MALLOC(size ? size : 1);
+}
+
+void*
+operator new[](size_t size, const std::nothrow_t& tag) noexcept
+{
+	return operator new(size, tag);
+}
+
+void
+operator delete(void* ptr) noexcept
+{
+	RAW_FREE(ptr);
+}
+
+void
+operator delete[](void* ptr) noexcept
+{
+	RAW_FREE(ptr);
+}
+
+void
+operator delete(void* ptr, size_t) noexcept
+{
+	RAW_FREE(ptr);
+}
+
+void
+operator delete[](void* ptr, size_t) noexcept
+{
+	RAW_FREE(ptr);
+}
+
+//
+// returns the peak resident set size of the process in kB
+//
+
+static long
+peak_rss()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS pmc;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+		return static_cast<long>(pmc.PeakWorkingSetSize / 1024);
+	return 0;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+	return usage.ru_maxrss / 1024; // bytes on macOS
+#else
+	return usage.ru_maxrss;
+#endif
+#endif
+}
+
+static long
+file_size(const char* filename)
+{
+	FILE* fp = fopen(filename, "rb");
+	if (!fp) return 0;
+	fseek(fp, 0, SEEK_END);
+	long size = ftell(fp);
+	fclose(fp);
+	return size;
+}
+
+//
+// small LCG, so the synthetic model is the same on every platform
+//
+
+static unsigned int seed = 1;
+
+static double
+random01()
+{
+	seed = seed * 1664525u + 1013904223u;
+	return (seed >> 8) * (1.0 / 16777216.0);
+}
+
+static dimeVec3
+random_point(double size)
+{
+	double x = random01() * size;
+	double y = random01() * size;
+	double z = random01() * size * 0.01;
+	return dimeVec3(x, y, z);
+}
+
+static void
+add_layer(DimeModel& model, DimeTable* table, const char* name, int16_t colnum)
+{
+	DimeLayerTable* layer = new DimeLayerTable;
+	layer->setLayerName(name);
+	layer->setColorNumber(colnum);
+	dimeParam param;
+	param.string_data = "CONTINUOUS";
+	layer->setRecord(6, param);
+	param.int16_data = 64;
+	layer->setRecord(70, param);
+	layer->registerLayer(&model);
+	table->insertTableEntry(layer);
+}
+
+//
+// Builds a model with numentities entities in the ENTITIES section:
+// lines, circles, arcs, 3D faces and inserts of small blocks.
+//
+
+static void
+build_model(DimeModel& model, int numentities)
+{
+	int i, j;
+	char name[64];
+
+	DimeTablesSection* tables = new DimeTablesSection;
+	model.insertSection(tables);
+	DimeTable* layertable = new DimeTable;
+	for (i = 0; i < NUM_LAYERS; i++)
+	{
+		sprintf(name, "LAYER%d", i);
+		add_layer(model, layertable, name, static_cast<int16_t>(i + 1));
+	}
+	tables->insertTable(layertable);
+
+	DimeBlocksSection* blocks = new DimeBlocksSection;
+	model.insertSection(blocks);
+	DimeBlock* blocklist[NUM_BLOCKS];
+	for (i = 0; i < NUM_BLOCKS; i++)
+	{
+		DimeBlock* block = new DimeBlock;
+		sprintf(name, "BLOCK%d", i);
+		block->setName(model.addBlock(name, block));
+		for (j = 0; j < BLOCK_SIZE; j++)
+		{
+			DimeLine* line = new DimeLine;
+			line->setCoords(0, random_point(1.0));
+			line->setCoords(1, random_point(1.0));
+			block->insertEntity(line);
+		}
+		blocks->insertBlock(block);
+		blocklist[i] = block;
+	}
+
+	DimeEntitiesSection* entities = new DimeEntitiesSection;
+	model.insertSection(entities);
+	for (i = 0; i < numentities; i++)
+	{
+		DimeEntity* entity;
+		const double type = random01();
+		if (type < 0.4)
+		{
+			DimeLine* line = new DimeLine;
+			dimeVec3 p = random_point(1000.0);
+			line->setCoords(0, p);
+			line->setCoords(1, p + random_point(10.0));
+			entity = line;
+		}
+		else if (type < 0.55)
+		{
+			DimeCircle* circle = new DimeCircle;
+			circle->setCenter(random_point(1000.0));
+			circle->setRadius(random01() * 10.0 + 0.1);
+			entity = circle;
+		}
+		else if (type < 0.7)
+		{
+			DimeArc* arc = new DimeArc;
+			arc->setCenter(random_point(1000.0));
+			arc->setRadius(random01() * 10.0 + 0.1);
+			arc->setStartAngle(random01() * 180.0);
+			arc->setEndAngle(180.0 + random01() * 180.0);
+			entity = arc;
+		}
+		else if (type < 0.9)
+		{
+			dime3DFace* face = new dime3DFace;
+			dimeVec3 p = random_point(1000.0);
+			face->setTriangle(p, p + random_point(10.0), p + random_point(10.0));
+			entity = face;
+		}
+		else
+		{
+			DimeInsert* insert = new DimeInsert;
+			insert->setBlock(blocklist[static_cast<int>(random01() * NUM_BLOCKS)]);
+			insert->setInsertionPoint(random_point(1000.0));
+			insert->setRotAngle(random01() * 360.0);
+			entity = insert;
+		}
+		sprintf(name, "LAYER%d", static_cast<int>(random01() * NUM_LAYERS));
+		entity->setLayer(model.getLayer(name));
+		entities->insertEntity(entity);
+	}
+}
+
+//
+// benchmark bookkeeping
+//
+
+struct bench_result
+{
+	double seconds;
+	long long allocs;
+	long long allocbytes;
+};
+
+class bench_timer
+{
+public:
+	bench_timer()
+		: allocs(numallocs.load()), bytes(allocbytes.load()),
+		  start(std::chrono::steady_clock::now())
+	{
+	}
+
+	void stop(bench_result& result) const
+	{
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - this->start;
+		if (result.seconds < 0.0 || elapsed.count() < result.seconds)
+			result.seconds = elapsed.count();
+		result.allocs = numallocs.load() - this->allocs;
+		result.allocbytes = allocbytes.load() - this->bytes;
+	}
+
+private:
+	long long allocs;
+	long long bytes;
+	std::chrono::steady_clock::time_point start;
+};
+
+static FILE* jsonfp = nullptr;
+static int numresults = 0;
+
+static void
+report(const char* name, const bench_result& result, long bytes, long entities)
+{
+	const double secs = result.seconds > 0.0 ? result.seconds : 1e-9;
+	fprintf(jsonfp, "%s\n    {\"name\": \"%s\", \"seconds\": %.6f", numresults++ ? "," : "", name, result.seconds);
+	if (bytes > 0)
+		fprintf(jsonfp, ", \"bytes\": %ld, \"mb_per_s\": %.3f", bytes, bytes / secs / (1024.0 * 1024.0));
+	if (entities > 0)
+		fprintf(jsonfp, ", \"entities\": %ld, \"entities_per_s\": %.1f", entities, entities / secs);
+	fprintf(jsonfp, ", \"allocations\": %lld, \"allocated_bytes\": %lld, \"peak_rss_kb\": %ld}",
+	        result.allocs, result.allocbytes, peak_rss());
+	fprintf(stderr, "%-20s %10.4f s\n", name, result.seconds);
+}
+
+static bool
+read_model(DimeModel& model, const char* filename, int readahead = 0)
+{
+	DimeInput in;
+	in.setReadAhead(readahead);
+	return in.setFile(filename) && model.read(&in);
+}
+
+static long
+count_entities(DimeModel& model, bool explode)
+{
+	long count = 0;
+	model.traverseEntities([&count](const DimeState*, DimeEntity*) -> bool
+	{
+		count++;
+		return true;
+	}, false, explode);
+	return count;
+}
+
+//
+// returns the first LINE in the ENTITIES section, or nullptr
+//
+
+static DimeLine*
+first_line(DimeModel& model)
+{
+	auto es = static_cast<DimeEntitiesSection*>(model.findSection("ENTITIES"));
+	const int n = es ? es->getNumEntities() : 0;
+	for (int i = 0; i < n; i++)
+	{
+		if (es->getEntity(i)->typeId() == DimeBase::dimeLineType)
+			return static_cast<DimeLine*>(es->getEntity(i));
+	}
+	return nullptr;
+}
+
+//
+// counts the diagnostics reported for one model
+//
+
+static void
+count_diagnostic(const char*, void* userdata)
+{
+	(*static_cast<long*>(userdata))++;
+}
+
+//
+// reads, traverses and converts filename in its own model, as done by
+// each thread in the read_parallel benchmark
+//
+
+struct parallel_result
+{
+	bool ok;
+	long entities;
+	long exploded;
+	long diagnostics;
+};
+
+static void
+read_convert(const char* filename, parallel_result& result)
+{
+	DimeModel model;
+	result.diagnostics = 0;
+	model.setDiagnosticHandler(count_diagnostic, &result.diagnostics);
+	result.ok = read_model(model, filename);
+	result.entities = result.ok ? count_entities(model, false) : 0;
+	result.exploded = result.ok ? count_entities(model, true) : 0;
+	if (result.ok)
+	{
+		dxfConverter converter;
+		converter.findHeaderVariables(model);
+		converter.setFillmode(true);
+		result.ok = converter.doConvert(model);
+	}
+}
+
+static int
+usage(const char* progname)
+{
+	fprintf(stderr,
+	        "Usage: %s [-n numentities] [-r repetitions] [-t threads] [-i infile] [-o outfile] [-d dir]\n\n"
+	        "Options:\n"
+	        "-n <num>     Number of entities in the synthetic model (default 100000)\n"
+	        "-r <num>     Repetitions of each benchmark, the best time is reported (default 3)\n"
+	        "-t <num>     Threads reading and converting models concurrently (default 1, no test)\n"
+	        "-i <infile>  Benchmark an ASCII DXF file instead of a synthetic model\n"
+	        "-o <outfile> Write JSON results to outfile (default stdout)\n"
+	        "-d <dir>     Directory for temporary files (default .)\n",
+	        progname);
+	return -1;
+}
+
+int
+main(int argc, char** argv)
+{
+	int numentities = 100000;
+	int reps = 3;
+	int numthreads = 1;
+	const char* infile = nullptr;
+	const char* outfile = nullptr;
+	const char* dir = ".";
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (argv[i][0] != '-' || argv[i][1] == 0 || argv[i][2] != 0 || i + 1 >= argc)
+			return usage(argv[0]);
+		const char* arg = argv[++i];
+		switch (argv[i - 1][1])
+		{
+		case 'n':
+			numentities = atoi(arg);
+			break;
+		case 'r':
+			reps = atoi(arg);
+			break;
+		case 't':
+			numthreads = atoi(arg);
+			break;
+		case 'i':
+			infile = arg;
+			break;
+		case 'o':
+			outfile = arg;
+			break;
+		case 'd':
+			dir = arg;
+			break;
+		default:
+			return usage(argv[0]);
+		}
+	}
+	if (numentities < 0 || reps < 1 || numthreads < 1) return usage(argv[0]);
+
+	char asciifile[1024], binaryfile[1024], passfile[1024], vrmlfile[1024];
+	snprintf(asciifile, sizeof(asciifile), "%s/dime_bench.dxf", dir);
+	snprintf(passfile, sizeof(passfile), "%s/dime_bench_passthrough.dxf", dir);
+	snprintf(binaryfile, sizeof(binaryfile), "%s/dime_bench_binary.dxf", dir);
+	snprintf(vrmlfile, sizeof(vrmlfile), "%s/dime_bench.wrl", dir);
+
+	jsonfp = stdout;
+	if (outfile && !(jsonfp = fopen(outfile, "w")))
+	{
+		fprintf(stderr, "Error opening file for writing: %s\n", outfile);
+		return -1;
+	}
+
+	// the model that is written, traversed and converted
+	DimeModel model;
+	if (infile)
+	{
+		if (!read_model(model, infile))
+		{
+			fprintf(stderr, "Error reading file: %s\n", infile);
+			return -1;
+		}
+	}
+	else build_model(model, numentities);
+
+	int i;
+	bench_result result;
+
+	fprintf(jsonfp, "{\n  \"dime\": \"%s\",\n  \"input\": \"%s\",\n  \"repetitions\": %d,\n  \"benchmarks\": [",
+	        DimeModel::getVersionString(), infile ? infile : "synthetic", reps);
+
+	// write the model, this also creates the files used below
+	const char* writefiles[2] = { asciifile, binaryfile };
+	const char* writenames[2] = { "write_ascii", "write_binary" };
+	long sizes[2];
+	const long numtop = count_entities(model, false);
+	for (int f = 0; f < 2; f++)
+	{
+		result.seconds = -1.0;
+		for (i = 0; i < reps; i++)
+		{
+			DimeOutput out;
+			if (!out.setFilename(writefiles[f])) return -1;
+			out.setBinary(f == 1);
+			bench_timer timer;
+			model.write(&out);
+			timer.stop(result);
+		}
+		sizes[f] = file_size(writefiles[f]);
+		report(writenames[f], result, sizes[f], numtop);
+	}
+	const long asciisize = sizes[0];
+
+	// group codes and strings only
+	result.seconds = -1.0;
+	for (i = 0; i < reps; i++)
+	{
+		DimeInput in;
+		if (!in.setFile(asciifile)) return -1;
+		bench_timer timer;
+		int32_t groupcode;
+		while (in.readGroupCode(groupcode) && in.readString());
+		timer.stop(result);
+	}
+	report("input_groupcodes", result, asciisize, 0);
+
+	// group codes and typed values, as when reading records
+	result.seconds = -1.0;
+	for (i = 0; i < reps; i++)
+	{
+		DimeInput in;
+		if (!in.setFile(asciifile)) return -1;
+		bench_timer timer;
+		int32_t groupcode;
+		dimeParam param;
+		while (in.readGroupCode(groupcode) &&
+		       DimeRecord::readRecordData(&in, groupcode, param));
+		timer.stop(result);
+	}
+	report("input_numbers", result, asciisize, 0);
+
+	const char* readnames[2] = { "read_ascii", "read_binary" };
+	for (int f = 0; f < 2; f++)
+	{
+		result.seconds = -1.0;
+		for (i = 0; i < reps; i++)
+		{
+			DimeModel readmodel;
+			bench_timer timer;
+			if (!read_model(readmodel, writefiles[f]))
+			{
+				fprintf(stderr, "Error reading file: %s\n", writefiles[f]);
+				return -1;
+			}
+			timer.stop(result);
+		}
+		report(readnames[f], result, sizes[f], numtop);
+	}
+
+	// file read by a background thread into 4 buffers of 1 MB
+	result.seconds = -1.0;
+	for (i = 0; i < reps; i++)
+	{
+		DimeModel readmodel;
+		bench_timer timer;
+		if (!read_model(readmodel, asciifile, 4))
+		{
+			fprintf(stderr, "Error reading file: %s\n", asciifile);
+			return -1;
+		}
+		timer.stop(result);
+	}
+	report("read_readahead", result, asciisize, numtop);
+
+	// passthrough write of a model where one line was edited before an
+	// incremental conversion, the edit must still be written
+	const dimeVec3 edited(12345.5, -678.25, 9.0);
+	result.seconds = -1.0;
+	for (i = 0; i < reps; i++)
+	{
+		DimeModel readmodel;
+		readmodel.setPassthrough(true);
+		if (!read_model(readmodel, asciifile))
+		{
+			fprintf(stderr, "Error reading file: %s\n", asciifile);
+			return -1;
+		}
+		DimeLine* line = first_line(readmodel);
+		if (line) line->setCoords(0, edited);
+		dxfConverter converter;
+		converter.setIncremental(true);
+		converter.findHeaderVariables(readmodel);
+		converter.doConvert(readmodel);
+		{
+			DimeOutput out;
+			if (!out.setFilename(passfile)) return -1;
+			bench_timer timer;
+			readmodel.write(&out);
+			timer.stop(result);
+		}
+		DimeModel written;
+		if (line && (!read_model(written, passfile) || !first_line(written) ||
+		             first_line(written)->getCoords(0) != edited))
+		{
+			fprintf(stderr, "Edited entity not written by passthrough write: %s\n", passfile);
+			return -1;
+		}
+	}
+	report("write_passthrough", result, asciisize, numtop);
+
+	// one model per thread, all threads must get the same result
+	if (numthreads > 1)
+	{
+		std::vector<parallel_result> results(numthreads);
+		result.seconds = -1.0;
+		for (i = 0; i < reps; i++)
+		{
+			std::vector<std::thread> threads;
+			bench_timer timer;
+			for (int t = 0; t < numthreads; t++)
+				threads.emplace_back(read_convert, asciifile, std::ref(results[t]));
+			for (std::thread& thread : threads) thread.join();
+			timer.stop(result);
+
+			for (const parallel_result& r : results)
+			{
+				if (!r.ok || r.entities != numtop || r.exploded != results[0].exploded ||
+				    r.diagnostics != results[0].diagnostics)
+				{
+					fprintf(stderr, "Inconsistent results reading %s in %d threads\n", asciifile, numthreads);
+					return -1;
+				}
+			}
+		}
+		report("read_parallel", result, asciisize * numthreads, numtop * numthreads);
+	}
+
+	long count = 0;
+	result.seconds = -1.0;
+	for (i = 0; i < reps; i++)
+	{
+		bench_timer timer;
+		count = count_entities(model, false);
+		timer.stop(result);
+	}
+	report("traverse", result, 0, count);
+
+	result.seconds = -1.0;
+	for (i = 0; i < reps; i++)
+	{
+		bench_timer timer;
+		count = count_entities(model, true);
+		timer.stop(result);
+	}
+	report("traverse_explode", result, 0, count);
+
+	// batched transformation of the points of all lines through an
+	// affine matrix, as done when converting exploded inserts
+	{
+		std::vector<dimeVec3> points;
+		model.traverseEntities([&points](const DimeState*, DimeEntity* entity) -> bool
+		{
+			if (entity->typeId() == DimeBase::dimeLineType)
+			{
+				points.push_back(static_cast<DimeLine*>(entity)->getCoords(0));
+				points.push_back(static_cast<DimeLine*>(entity)->getCoords(1));
+			}
+			return true;
+		}, false, true);
+		dimeMatrix matrix;
+		matrix.setTransform(dimeVec3(10.0, 20.0, 0.0), dimeVec3(2.0, 2.0, 1.0), dimeVec3(0.0, 0.0, 30.0));
+		std::vector<dimeVec3> transformed(points.size());
+		result.seconds = -1.0;
+		for (i = 0; i < reps; i++)
+		{
+			bench_timer timer;
+			for (int k = 0; k < 10; k++)
+				matrix.transformPoints(points.data(), transformed.data(), static_cast<int>(points.size()));
+			timer.stop(result);
+		}
+		report("transform_points", result, 0, 10 * static_cast<long>(points.size()));
+	}
+
+	// writeVrml() consumes the converted geometry, so convert each time
+	bench_result vrmlresult;
+	result.seconds = -1.0;
+	vrmlresult.seconds = -1.0;
+	for (i = 0; i < reps; i++)
+	{
+		dxfConverter converter;
+		converter.findHeaderVariables(model);
+		converter.setFillmode(true);
+		bench_timer timer;
+		converter.doConvert(model);
+		timer.stop(result);
+
+		FILE* fp = fopen(vrmlfile, "wb");
+		if (!fp) return -1;
+		bench_timer vrmltimer;
+		converter.writeVrml(fp, false);
+		fclose(fp);
+		vrmltimer.stop(vrmlresult);
+	}
+	report("convert", result, 0, count);
+	report("write_vrml", vrmlresult, file_size(vrmlfile), 0);
+
+	fprintf(jsonfp, "\n  ]\n}\n");
+	if (jsonfp != stdout) fclose(jsonfp);
+
+	remove(asciifile);
+	remove(binaryfile);
+	remove(passfile);
+	remove(vrmlfile);
+	return 0;
+}
@@ -35,7 +35,10 @@
 #include <dime/Model.h>
 #include <dime/State.h>
 #include <stdio.h>
+#include <string.h>
 #include <dime/convert/convert.h>
+#include <dime/convert/glbwriter.h>
+#include <dime/convert/meshoptimizer.h>
 
 #ifdef macintosh
 #include "console.h"
@@ -47,13 +50,21 @@ static int
 usage(char *progname)
 {
   fprintf(stderr,
-	  "Usage: %s [infile] [-o outfile] [-e maxerr] [-f] [-l]\n"
+	  "Usage: %s [infile] [-o outfile] [-e maxerr] [-f] [-p] [-j] [-m] [-r] [-l]\n"
+	  "       [-G layer|insert|entity] [-i]\n"
 	  "(default infile is stdin, default outfile is stdout)\n\n"
 	  "Options:\n"
 	  "-e <maxerr>  Maximum error when tessellating curves\n"
           "-s <numsub>  Number of subdivisions for a curve (full circle)\n"
 	  "-f           Respect the $FILLMODE header variable\n"
+	  "-p           Fill closed polylines without width\n"
+	  "-j           Join connected lines into long line strips\n"
+	  "-m           Optimize polygons for rendering, and add normals\n"
+	  "-r           Store vertices relative to the center of the drawing\n"
+	  "-G <group>   Group geometry by layer, insert or entity, not only color\n"
+	  "-i           Tag geometry with entity IDs (GLB extras)\n"
           "-vrml2       Write as vrml2. Default is vrml1\n"
+          "-glb         Write as binary glTF (GLB)\n"
           "-2d          Set z-coordinate to 0 for all vertices\n"
 	  "-l           Use layer color, ignore the color index\n\n",
 	  progname);
@@ -77,9 +88,16 @@ main(int argc, char **argv)
   int i = 1;
   
   int fillmode = 0;
+  int fillpolygons = 0;
+  int stitchlines = 0;
+  int optimize = 0;
+  int rebase = 0;
   int layercol = 0;
+  int entityids = 0;
+  dxfConverter::GroupMode groupmode = dxfConverter::GROUP_BY_COLOR;
   bool vrml1 = true;
   bool only2d = false;
+  bool glb = false;
 
   while (i < argc) {
     if (argv[i][0] != '-') {
@@ -111,14 +129,47 @@ main(int argc, char **argv)
 	i++;
 	fillmode = 1;
 	break;
+      case 'p':
+	i++;
+	fillpolygons = 1;
+	break;
+      case 'j':
+	i++;
+	stitchlines = 1;
+	break;
+      case 'm':
+	i++;
+	optimize = 1;
+	break;
+      case 'r':
+	i++;
+	rebase = 1;
+	break;
       case 'l':
 	i++;
 	layercol = 1;
 	break;
+      case 'G':
+	i++;
+	if (i >= argc) return usage(argv[0]);
+	if (!strcmp(argv[i], "layer")) groupmode = dxfConverter::GROUP_BY_LAYER;
+	else if (!strcmp(argv[i], "insert")) groupmode = dxfConverter::GROUP_BY_INSERT;
+	else if (!strcmp(argv[i], "entity")) groupmode = dxfConverter::GROUP_BY_ENTITY;
+	else return usage(argv[0]);
+	i++;
+	break;
+      case 'i':
+	i++;
+	entityids = 1;
+	break;
       case 'v':
         i++;
         vrml1 = false;
         break;
+      case 'g':
+        i++;
+        glb = true;
+        break;
       case 'h':
 	return usage(argv[0]);
       case '2':
@@ -185,15 +236,33 @@ main(int argc, char **argv)
   //
   if (fillmode == 0) converter.setFillmode(true);
 
+  if (fillpolygons) converter.setFillPolygons(true);
+  if (stitchlines) converter.setStitchLines(true);
   if (layercol) converter.setLayercol(true);
+  converter.setGroupMode(groupmode);
+  if (entityids) converter.setEntityIds(true);
+  if (rebase) converter.setOriginMode(dxfConverter::ORIGIN_EXTENTS);
     
   if (!converter.doConvert(model)) {
     fprintf(stderr,"Error during conversion\n");
     if (out && out != stdout) fclose(out);
     return -1;
   }
+
+  if (optimize) {
+    dxfMeshOptimizer optimizer;
+    converter.optimizeMeshes(optimizer);
+  }
   
-  converter.writeVrml(out, vrml1, only2d);
+  if (glb) {
+    dxfGlbWriter writer(out);
+    if (!converter.writeGeometry(&writer)) {
+      fprintf(stderr,"Error writing GLB file\n");
+    }
+  }
+  else {
+    converter.writeVrml(out, vrml1, only2d);
+  }
   
   if (out != stdout) fclose(out);
   return 0; // alles in ordnung :-)
@@ -18,6 +18,21 @@
  *  The subroutines print_object() and print_triangle() should
  *  be changed to generate whatever the desired database format is.
  *
+ * Usage: dxfsphere -w numentities [-s seed] [-l layers] [-d depth]
+ *                  [-j objects] [-B] [-o outfile]
+ *      writes a synthetic workload instead of a sphere: a random mix of
+ *          lines, arcs, circles, LWPOLYLINEs with bulges, polyface
+ *          meshes, splines, texts with long strings, unknown entities
+ *          and inserts of nested blocks, some as MINSERT arrays.
+ *          The same seed always gives the same file. The entities are
+ *          streamed, so the file size is only limited by disk space.
+ *      -s sets the random seed (default 1)
+ *      -l sets the number of layers (default 100)
+ *      -d sets the block nesting depth (default 4)
+ *      -j sets the number of objects in the OBJECTS section (default
+ *          numentities / 10, at most 100000)
+ *      -B writes a binary DXF file
+ *
  * Jon Leech (leech @ cs.unc.edu) 3/24/89
  * icosahedral code added by Jim Buddenhagen (jb1556@daditz.sbc.com) 5/93
  *
@@ -49,7 +64,13 @@
 #include <dime/entities/Insert.h>
 #include <dime/entities/UnknownEntity.h>
 #include <dime/Output.h>
+#include <dime/StreamWriter.h>
 #include <dime/util/Linear.h>
+#include <dime/entities/Arc.h>
+#include <dime/sections/HeaderSection.h>
+#include <dime/sections/ObjectsSection.h>
+#include <dime/objects/UnknownObject.h>
+#include <string.h>
 
 #define LAYERNAME1 "MYLAYER1" // Layernames can't have spaces
 #define LAYERNAME2 "MYLAYER2" // Layernames can't have spaces
@@ -204,6 +225,347 @@ add_layer(const char * name, int colnum, DimeModel * model, DimeTable * layers)
   layers->insertTableEntry(layer);
 }
 
+/*
+ * Synthetic workload generator
+ */
+
+#define WL_BLOCKS_PER_LEVEL 4
+#define WL_MAX_RECORDS 1024
+#define WL_MAX_STRING 4000
+
+static unsigned int wl_seed = 1;
+
+/* Portable LCG, so a seed gives the same file on every platform */
+static double
+wl_random()
+{
+  wl_seed = wl_seed * 1664525u + 1013904223u;
+  return (wl_seed >> 8) * (1.0 / 16777216.0);
+}
+
+static int
+wl_randint(int n)
+{
+  int i = (int) (wl_random() * n);
+  return i < n ? i : n - 1;
+}
+
+static dimeVec3
+wl_point(double size)
+{
+  double x = wl_random() * size;
+  double y = wl_random() * size;
+  return dimeVec3(x, y, 0.0);
+}
+
+/* Fills buf with a random string of len characters */
+static const char *
+wl_string(char * buf, int len)
+{
+  static const char chars[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789 ";
+  for (int i = 0; i < len; i++) {
+    buf[i] = chars[wl_randint(sizeof(chars) - 1)];
+  }
+  buf[len] = 0;
+  return buf;
+}
+
+/* Collects the records of an entity written with DimeStreamWriter */
+class wl_records {
+public:
+  wl_records(void) : num(0) { }
+  void add(int groupcode, const dimeParam & param) {
+    if (num < WL_MAX_RECORDS) {
+      codes[num] = groupcode;
+      params[num] = param;
+      num++;
+    }
+  }
+  void addString(int groupcode, const char * str) {
+    dimeParam param;
+    param.string_data = str;
+    add(groupcode, param);
+  }
+  void addInt16(int groupcode, int val) {
+    dimeParam param;
+    param.int16_data = (int16_t) val;
+    add(groupcode, param);
+  }
+  void addInt32(int groupcode, int val) {
+    dimeParam param;
+    param.int32_data = val;
+    add(groupcode, param);
+  }
+  void addDouble(int groupcode, double val) {
+    dimeParam param;
+    param.double_data = val;
+    add(groupcode, param);
+  }
+  void addPoint(int groupcode, const dimeVec3 & p, bool only2d = false) {
+    addDouble(groupcode, p.x);
+    addDouble(groupcode + 10, p.y);
+    if (!only2d) addDouble(groupcode + 20, p.z);
+  }
+public:
+  int codes[WL_MAX_RECORDS];
+  dimeParam params[WL_MAX_RECORDS];
+  int num;
+};
+
+/*
+ * Adds depth levels of blocks. The blocks on each level contain some
+ * lines and an arc, and insert a block from the level below, either
+ * once or as a 2x2 MINSERT array.
+ */
+static void
+wl_add_blocks(DimeModel & model, int depth, DimeBlock ** toplevel)
+{
+  DimeBlocksSection * blocks = new DimeBlocksSection;
+  model.insertSection(blocks);
+
+  DimeBlock * below[WL_BLOCKS_PER_LEVEL];
+  char name[64];
+  for (int level = 0; level < depth; level++) {
+    DimeBlock * current[WL_BLOCKS_PER_LEVEL];
+    for (int i = 0; i < WL_BLOCKS_PER_LEVEL; i++) {
+      DimeBlock * block = new DimeBlock;
+      sprintf(name, "NEST_%d_%d", level, i);
+      block->setName(model.addBlock(name, block));
+      for (int j = 0; j < 8; j++) {
+        DimeLine * line = new DimeLine;
+        line->setCoords(0, wl_point(1.0));
+        line->setCoords(1, wl_point(1.0));
+        block->insertEntity(line);
+      }
+      DimeArc * arc = new DimeArc;
+      arc->setCenter(wl_point(1.0));
+      arc->setRadius(0.1 + wl_random() * 0.4);
+      arc->setStartAngle(0.0);
+      arc->setEndAngle(90.0 + wl_random() * 180.0);
+      block->insertEntity(arc);
+
+      if (level > 0) {
+        DimeInsert * insert = new DimeInsert;
+        insert->setBlock(below[wl_randint(WL_BLOCKS_PER_LEVEL)]);
+        insert->setScale(dimeVec3(0.5, 0.5, 1.0));
+        if (i & 1) {
+          // DIME: an INSERT with rows and columns is a MINSERT
+          dimeParam param;
+          param.int16_data = 2;
+          insert->setRecord(70, param);
+          insert->setRecord(71, param);
+          param.double_data = 0.5;
+          insert->setRecord(44, param);
+          insert->setRecord(45, param);
+        }
+        block->insertEntity(insert);
+      }
+      blocks->insertBlock(block);
+      current[i] = block;
+    }
+    for (int i = 0; i < WL_BLOCKS_PER_LEVEL; i++) below[i] = current[i];
+  }
+  for (int i = 0; i < WL_BLOCKS_PER_LEVEL; i++) {
+    toplevel[i] = depth > 0 ? below[i] : NULL;
+  }
+}
+
+/* Adds an OBJECTS section with numobjects unknown objects */
+static void
+wl_add_objects(DimeModel & model, int numobjects)
+{
+  DimeObjectsSection * objects = new DimeObjectsSection;
+  char buf[128], handle[32];
+  dimeParam param;
+  for (int i = 0; i < numobjects; i++) {
+    dimeUnknownObject * object = new dimeUnknownObject("ACME_DATA");
+    param.string_data = model.getUniqueHandle(handle, sizeof(handle));
+    object->setRecord(5, param);
+    param.string_data = wl_string(buf, 16 + wl_randint(100));
+    object->setRecord(1, param);
+    param.int16_data = (int16_t) wl_randint(1000);
+    object->setRecord(70, param);
+    param.double_data = wl_random();
+    object->setRecord(40, param);
+    objects->insertObject(object);
+  }
+  model.insertSection(objects);
+}
+
+static bool
+wl_write_polyface(DimeStreamWriter & writer, const char * layer)
+{
+  // a grid of n x n vertices with (n-1) x (n-1) quads
+  int n = 2 + wl_randint(5);
+  dimeVec3 origin = wl_point(10000.0);
+  double size = 1.0 + wl_random() * 10.0;
+  wl_records rec;
+  rec.addInt16(66, 1);
+  rec.addPoint(10, dimeVec3(0.0, 0.0, 0.0));
+  rec.addInt16(70, 64);
+  rec.addInt16(71, n * n);
+  rec.addInt16(72, (n - 1) * (n - 1));
+  bool ok = writer.writeEntity("POLYLINE", rec.codes, rec.params, rec.num, layer);
+
+  for (int y = 0; y < n && ok; y++) {
+    for (int x = 0; x < n && ok; x++) {
+      rec.num = 0;
+      rec.addPoint(10, origin + dimeVec3(x * size, y * size, wl_random() * size));
+      rec.addInt16(70, 192);
+      ok = writer.writeEntity("VERTEX", rec.codes, rec.params, rec.num, layer);
+    }
+  }
+  for (int y = 0; y < n - 1 && ok; y++) {
+    for (int x = 0; x < n - 1 && ok; x++) {
+      rec.num = 0;
+      rec.addPoint(10, dimeVec3(0.0, 0.0, 0.0));
+      rec.addInt16(70, 128);
+      rec.addInt16(71, y * n + x + 1);
+      rec.addInt16(72, y * n + x + 2);
+      rec.addInt16(73, (y + 1) * n + x + 2);
+      rec.addInt16(74, (y + 1) * n + x + 1);
+      ok = writer.writeEntity("VERTEX", rec.codes, rec.params, rec.num, layer);
+    }
+  }
+  return ok && writer.writeEntity("SEQEND", NULL, NULL, 0, layer);
+}
+
+static bool
+wl_write_entity(DimeStreamWriter & writer, DimeBlock ** toplevel,
+                const char * layer, char * strbuf)
+{
+  wl_records rec;
+  dimeVec3 p = wl_point(10000.0);
+  double type = wl_random();
+
+  if (type < 0.25) {
+    return writer.writeLine(p, p + wl_point(20.0), layer);
+  }
+  if (type < 0.35) {
+    rec.addPoint(10, p);
+    rec.addDouble(40, 0.1 + wl_random() * 20.0);
+    return writer.writeEntity("CIRCLE", rec.codes, rec.params, rec.num, layer);
+  }
+  if (type < 0.45) {
+    rec.addPoint(10, p);
+    rec.addDouble(40, 0.1 + wl_random() * 20.0);
+    rec.addDouble(50, wl_random() * 360.0);
+    rec.addDouble(51, wl_random() * 360.0);
+    return writer.writeEntity("ARC", rec.codes, rec.params, rec.num, layer);
+  }
+  if (type < 0.60) {
+    int n = 3 + wl_randint(30);
+    rec.addInt32(90, n);
+    rec.addInt16(70, wl_randint(2));
+    for (int i = 0; i < n; i++) {
+      rec.addPoint(10, p + wl_point(50.0), true);
+      if (wl_random() < 0.3) rec.addDouble(42, wl_random() * 2.0 - 1.0);
+    }
+    return writer.writeEntity("LWPOLYLINE", rec.codes, rec.params, rec.num, layer);
+  }
+  if (type < 0.65) {
+    return wl_write_polyface(writer, layer);
+  }
+  if (type < 0.70) {
+    int numctrl = 4 + wl_randint(20);
+    rec.addInt16(70, 8);
+    rec.addInt16(71, 3);
+    rec.addInt16(72, numctrl + 4);
+    rec.addInt16(73, numctrl);
+    rec.addInt16(74, 0);
+    for (int i = 0; i < numctrl + 4; i++) {
+      int knot = i < 4 ? 0 : (i >= numctrl ? numctrl - 3 : i - 3);
+      rec.addDouble(40, knot);
+    }
+    for (int i = 0; i < numctrl; i++) {
+      rec.addPoint(10, p + dimeVec3(i * 5.0, wl_random() * 20.0, 0.0));
+    }
+    return writer.writeEntity("SPLINE", rec.codes, rec.params, rec.num, layer);
+  }
+  if (type < 0.78) {
+    rec.addPoint(10, p);
+    rec.addDouble(40, 1.0 + wl_random() * 5.0);
+    // mostly short strings, some very long
+    int len = wl_random() < 0.9 ? 4 + wl_randint(40) : 200 + wl_randint(WL_MAX_STRING - 200);
+    rec.addString(1, wl_string(strbuf, len));
+    return writer.writeEntity("TEXT", rec.codes, rec.params, rec.num, layer);
+  }
+  if (type < 0.85) {
+    // DIME: entities unknown to DIME are kept as records
+    rec.addPoint(10, p);
+    rec.addDouble(40, wl_random());
+    rec.addInt16(70, wl_randint(100));
+    rec.addString(1, wl_string(strbuf, 8 + wl_randint(120)));
+    rec.addString(1000, "ACME");
+    return writer.writeEntity("ACME_WIDGET", rec.codes, rec.params, rec.num, layer);
+  }
+  if (type < 0.95 && toplevel[0]) {
+    rec.addString(2, toplevel[wl_randint(WL_BLOCKS_PER_LEVEL)]->getName());
+    rec.addPoint(10, p);
+    rec.addDouble(41, 10.0);
+    rec.addDouble(42, 10.0);
+    rec.addDouble(50, wl_random() * 360.0);
+    if (wl_random() < 0.2) {
+      // MINSERT
+      rec.addInt16(70, 2 + wl_randint(4));
+      rec.addInt16(71, 2 + wl_randint(4));
+      rec.addDouble(44, 12.0);
+      rec.addDouble(45, 12.0);
+    }
+    return writer.writeEntity("INSERT", rec.codes, rec.params, rec.num, layer);
+  }
+  return writer.write3DFace(p, p + wl_point(20.0), p + wl_point(20.0),
+                            p + wl_point(20.0), layer);
+}
+
+static int
+write_workload(DimeOutput & out, long numentities, int numlayers,
+               int depth, int numobjects)
+{
+  DimeModel model;
+  char name[64];
+
+  // DIME: a HEADER section with a $HANDSEED variable is needed for
+  // the stream writer to record the final handle count
+  DimeHeaderSection * header = new DimeHeaderSection;
+  dimeParam param;
+  param.string_data = "AC1015";
+  header->setVariable("$ACADVER", 1, param);
+  param.string_data = "0";
+  header->setVariable("$HANDSEED", 5, param);
+  model.insertSection(header);
+
+  DimeTablesSection * tables = new DimeTablesSection;
+  model.insertSection(tables);
+  DimeTable * layers = new DimeTable;
+  for (int i = 0; i < numlayers; i++) {
+    sprintf(name, "LAYER_%d", i);
+    add_layer(name, 1 + i % 255, &model, layers);
+  }
+  tables->insertTable(layers);
+
+  DimeBlock * toplevel[WL_BLOCKS_PER_LEVEL];
+  wl_add_blocks(model, depth, toplevel);
+  wl_add_objects(model, numobjects);
+
+  char * strbuf = new char[WL_MAX_STRING + 1];
+  DimeStreamWriter writer(&out);
+  bool ok = writer.begin(&model);
+  for (long i = 0; i < numentities && ok; i++) {
+    sprintf(name, "LAYER_%d", wl_randint(numlayers));
+    ok = wl_write_entity(writer, toplevel, name, strbuf);
+  }
+  ok = writer.end() && ok;
+  delete[] strbuf;
+
+  if (!ok) {
+    fprintf(stderr, "dxfsphere: error writing workload\n");
+    return 1;
+  }
+  return 0;
+}
+
 int
 main(int ac, char ** av)
 {
@@ -218,6 +580,12 @@ main(int ac, char ** av)
 
   char * outfile = NULL;
 
+  long numentities = -1;  /* Workload mode if >= 0 */
+  int numlayers = 100;
+  int depth = 4;
+  int numobjects = -1;
+  int binary = 0;
+
   /* Parse arguments */
   for (i = 1; i < ac; i++) {
     if (!strcmp(av[i], "-c"))
@@ -232,6 +600,18 @@ main(int ac, char ** av)
       outfile = av[i+1];
       i++;
     }
+    else if (!strcmp(av[i], "-w") && i < ac-1)
+      numentities = atol(av[++i]);
+    else if (!strcmp(av[i], "-s") && i < ac-1)
+      wl_seed = (unsigned int) strtoul(av[++i], NULL, 10);
+    else if (!strcmp(av[i], "-l") && i < ac-1)
+      numlayers = atoi(av[++i]);
+    else if (!strcmp(av[i], "-d") && i < ac-1)
+      depth = atoi(av[++i]);
+    else if (!strcmp(av[i], "-j") && i < ac-1)
+      numobjects = atoi(av[++i]);
+    else if (!strcmp(av[i], "-B"))
+      binary = 1;
     else if (isdigit(av[i][0])) {
       if ((maxlevel = atoi(av[i])) < 1) {
         fprintf(stderr, "dxfsphere: # of levels must be >= 1\n");
@@ -243,8 +623,10 @@ main(int ac, char ** av)
     }
   }
 
-  if (i < ac || ac == 1) {
-    fprintf(stderr, "dxfsphere: [-c] [-t] [-i] [-b] [-o <outfile>] <levels>\n");
+  if (i < ac || ac == 1 || numlayers < 1 || depth < 0) {
+    fprintf(stderr, "dxfsphere: [-c] [-t] [-i] [-b] [-o <outfile>] <levels>\n"
+            "           -w <numentities> [-s <seed>] [-l <layers>] [-d <depth>]\n"
+            "              [-j <objects>] [-B] [-o <outfile>]\n");
     exit(1);
   }
 
@@ -253,6 +635,14 @@ main(int ac, char ** av)
   if (!outfile || !out.setFilename(outfile)) {
     out.setFileHandle(stdout);
   }
+  if (binary) out.setBinary();
+
+  if (numentities >= 0) {
+    if (numobjects < 0) {
+      numobjects = numentities / 10 < 100000 ? (int) (numentities / 10) : 100000;
+    }
+    return write_workload(out, numentities, numlayers, depth, numobjects);
+  }
   // DIME: create dime model
   DimeModel model;
 
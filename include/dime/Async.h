@@ -0,0 +1,66 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#ifndef DIME_ASYNC_H
+#define DIME_ASYNC_H
+
+#include <dime/Basic.h>
+#include <atomic>
+#include <future>
+
+// runs a task, e.g. on a thread pool. The task must be run exactly once.
+using dimeExecutor = std::function<void(std::function<void()>)>;
+
+class  DimeAsyncControl
+{
+public:
+	DimeAsyncControl();
+
+	void cancel();
+	bool isCancelled() const;
+	void reset();
+
+	float getProgress() const;
+	long getBytesProcessed() const;
+
+	void setProgress(float progress, long bytes);
+
+private:
+	DimeAsyncControl(const DimeAsyncControl&) = delete;
+	DimeAsyncControl& operator=(const DimeAsyncControl&) = delete;
+
+	std::atomic<bool> cancelled;
+	std::atomic<float> progress;
+	std::atomic<long> bytes;
+}; // class DimeAsyncControl
+
+#endif // ! DIME_ASYNC_H
@@ -40,11 +40,18 @@
 #include <assert.h>
 #include <functional>
 #include <math.h>
-
-// we prefer to use floats to save mem. Applications needing
-// scientific calculations should typedef this to double
-// typedef float dxfdouble;
+#include <stdint.h>
+
+// Coordinates and other real values are stored as dxfdouble. Building
+// with DIME_FLOAT_PRECISION (the DIME_USE_FLOAT CMake option) stores them
+// as floats to save memory. Transformation matrices always use dxfmath,
+// so composed transforms keep full precision.
+#ifdef DIME_FLOAT_PRECISION
+using dxfdouble = float;
+#else // !DIME_FLOAT_PRECISION
 using dxfdouble = double;
+#endif // !DIME_FLOAT_PRECISION
+using dxfmath = double;
 
 
 #ifndef M_PI
@@ -73,7 +80,7 @@ d = new char[strlen(s)+1]; if (d) strcpy(d,s)
 
 using dimeCallback = std::function<bool(class DimeState const*, class DimeEntity *)>; // return false to terminate traversal.
 
-using dimeParam = union
+union dimeParam
 {
 	int8_t int8_data;
 	int16_t int16_data;
@@ -88,6 +95,15 @@ int  dime_isnan(double value);
 int  dime_isinf(double value);
 int  dime_finite(double value);
 
+enum dimeCompression
+{
+	DIME_COMPRESSION_NONE,
+	DIME_COMPRESSION_GZIP,
+	DIME_COMPRESSION_ZSTD
+};
+
+bool dime_compression_supported(dimeCompression compression);
+
 /* ********************************************************************** */
 
 #endif // !DIME_BASIC_H
@@ -38,6 +38,12 @@
 
 #define DXF_MAXLINELEN 4096
 
+struct dimeSourceData;
+class DimeStats;
+class DimeAsyncControl;
+class dimeReadAhead;
+class dimeFileReader;
+
 class  DimeInput
 {
 public:
@@ -47,6 +53,7 @@ public:
 	bool setFileHandle(FILE* fp);
 	bool setFile(const char* filename);
 	bool setFilePointer(int fd);
+	void setReadAhead(int numbuffers, size_t buffersize = 1024 * 1024);
 	bool eof() const;
 	void setCallback(int (*cb)(float, void*), void* cbdata);
 	float relativePosition();
@@ -64,10 +71,20 @@ public:
 	class DimeModel* getModel();
 
 	int getFilePosition() const;
+	long getByteOffset() const;
+	long getGroupCodeOffset() const;
+	int addSourceRange(const void* object, long start, long end);
 
 	bool isBinary() const;
+	dimeCompression getCompression() const;
 	int getVersion() const;
 	bool isAborted() const;
+	bool checkAborted();
+
+	void setStats(DimeStats* stats);
+	DimeStats* getStats() const;
+	void setAsyncControl(DimeAsyncControl* control);
+	DimeAsyncControl* getAsyncControl() const;
 
 private:
 	friend class DimeModel;
@@ -78,15 +95,12 @@ private:
 	int version;
 
 	int fd;
-#ifdef USE_GZFILE
-  void *gzfp; // gzip file pointer
-  bool gzeof;
-#else // ! USE_GZFILE
 	FILE* fp;
 	bool fpeof;
-#endif // ! USE_GZFILE
+	dimeFileReader* reader;
 	long filesize;
 	char* readbuf;
+	char* readbufAlloc;
 	size_t readbufIndex;
 	size_t readbufLen;
 
@@ -105,8 +119,32 @@ private:
 	bool didOpenFile;
 	bool endianSwap;
 
+	dimeSourceData* source;
+	long readbufStart;
+	long groupCodeStart;
+
+	const char* snapshotPtr;
+	const char* snapshotEnd;
+	const char* const* snapshotStrings;
+	int numSnapshotStrings;
+
+	DimeStats* stats;
+	DimeAsyncControl* asyncControl;
+
+	dimeReadAhead* readAhead;
+	int readAheadBuffers;
+	size_t readAheadSize;
+
 private:
 	bool init();
+	bool setSource(dimeSourceData* data);
+	bool openReader();
+	void startReadAhead();
+	bool setSnapshot(const char* data, size_t size,
+	                 const char* const* strings, int numstrings);
+	bool readSnapshot(void* data, size_t size);
+	bool readSnapshotValue(dxfdouble& d, long& l, const char*& str);
+	const char* readSnapshotString();
 	bool doBufferRead();
 	void putBack(char c);
 	void putBack(const char* string);
@@ -124,4 +162,16 @@ private:
 	bool checkBinary();
 }; // class dimeInput
 
+inline DimeStats*
+DimeInput::getStats() const
+{
+	return this->stats;
+}
+
+inline DimeAsyncControl*
+DimeInput::getAsyncControl() const
+{
+	return this->asyncControl;
+}
+
 #endif // ! DIME_INPUT_H
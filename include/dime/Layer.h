@@ -65,17 +65,23 @@ private:
 	friend class DimeModel;
 
 	dimeLayer();
-	dimeLayer(const char* name, int num,
-	          int16_t colnum, int16_t flags);
+	constexpr dimeLayer(const char* name, int num,
+	                    int16_t colnum, int16_t flags);
 	const char* layerName;
 	int layerNum;
 	int16_t colorNum;
 	int16_t flags;
 
-	static void cleanup_default_layer(void);
-	static dimeLayer* defaultLayer;
+	static const dimeLayer defaultLayer;
 }; // class dimeLayer
 
+constexpr
+dimeLayer::dimeLayer(const char* const name, const int num,
+                     const int16_t colnum, const int16_t flagmask)
+	: layerName(name), layerNum(num), colorNum(colnum), flags(flagmask)
+{
+}
+
 inline const char*
 dimeLayer::getLayerName() const
 {
@@ -38,6 +38,7 @@
 #include <dime/util/Linear.h>
 #include <dime/Base.h>
 #include <dime/Layer.h>
+#include <dime/Async.h>
 #include <stdlib.h>
 
 class DimeInput;
@@ -49,6 +50,48 @@ class DimeBlocksSection;
 class DimeBlock;
 class DimeEntity;
 class DimeRecord;
+class DimeStats;
+struct dimeSourceData;
+
+using dimeDiagnosticHandler = void (*)(const char* message, void* userdata);
+
+struct dimeGeometryBatch
+{
+	dimeGeometryBatch();
+
+	int numEntities;
+	int numVertices;
+	int numIndices;
+
+	dxfdouble* x;
+	dxfdouble* y;
+	dxfdouble* z;
+	dxfdouble* xyz;
+	float* xyzf;
+	dimeVec3 offset;
+
+	int* indices;
+	int* vertexOffsets;
+	int* indexOffsets;
+	unsigned char* types;
+	dxfdouble* thickness;
+	dxfdouble* extrusionDirs;
+};
+
+struct dimeMemoryUsage
+{
+	dimeMemoryUsage();
+
+	size_t total;
+	dimeArray<size_t> sections;
+	size_t entities[DimeBase::dimeLastTypeTag];
+	size_t records;
+	size_t strings;
+	size_t dictionaries;
+	size_t layers;
+	size_t source;
+	size_t other;
+};
 
 class  DimeModel
 {
@@ -61,13 +104,37 @@ public:
 	bool init();
 	bool read(DimeInput* in);
 	bool write(DimeOutput* out);
+	std::future<bool> readAsync(DimeInput* in, DimeAsyncControl* control = nullptr,
+	                            const dimeExecutor& executor = nullptr);
+	std::future<bool> writeAsync(DimeOutput* out, DimeAsyncControl* control = nullptr,
+	                             const dimeExecutor& executor = nullptr);
+
+	bool saveSnapshot(const char* filename);
+	bool loadSnapshot(const char* filename);
+
+	void setPassthrough(bool onOff);
+	bool getPassthrough() const;
+
+	void setStats(DimeStats* stats);
+	DimeStats* getStats() const;
+
+	void setDiagnosticHandler(dimeDiagnosticHandler handler, void* userdata = nullptr);
+	dimeDiagnosticHandler getDiagnosticHandler() const;
+	void* getDiagnosticData() const;
 
 	int countRecords() const;
+	size_t getMemoryUsage(dimeMemoryUsage& usage) const;
 
 	bool traverseEntities(dimeCallback const& callback,
 	                      bool traverseBlocksSection = false,
 	                      bool explodeInserts = true,
 	                      bool traversePolylineVertices = false);
+	static bool traverseEntity(DimeEntity* entity,
+	                           dimeCallback const& callback,
+	                           bool explodeInserts = true,
+	                           bool traversePolylineVertices = false);
+	bool extractGeometry(dimeGeometryBatch& batch,
+	                     int first = 0, int count = -1);
 
 	const char* addReference(const char* name, void* id);
 	void* findReference(const char* name) const;
@@ -103,6 +170,10 @@ public:
 	void addEntity(DimeEntity* entity);
 
 private:
+	friend class DimeOutput;
+	friend class DimeStreamWriter;
+	bool writeSections(DimeOutput* out);
+
 	dimeDict* refDict;
 	dimeDict* layerDict;
 	dimeArray<DimeSection*> sections;
@@ -110,6 +181,35 @@ private:
 	dimeArray<DimeRecord*> headerComments;
 
 	int largestHandle;
+	bool passthrough;
+	dimeSourceData* source;
+	DimeStats* stats;
+	dimeDiagnosticHandler diagnosticHandler;
+	void* diagnosticData;
 }; 
 
+inline bool
+DimeModel::getPassthrough() const
+{
+	return this->passthrough;
+}
+
+inline DimeStats*
+DimeModel::getStats() const
+{
+	return this->stats;
+}
+
+inline dimeDiagnosticHandler
+DimeModel::getDiagnosticHandler() const
+{
+	return this->diagnosticHandler;
+}
+
+inline void*
+DimeModel::getDiagnosticData() const
+{
+	return this->diagnosticData;
+}
+
 #endif // ! DIME_MODEL_H
@@ -37,6 +37,14 @@
 #include <stdio.h>
 
 class DimeModel;
+class DimeEntity;
+class DimeSection;
+struct dimeSourceData;
+struct dimeSourceRange;
+struct dimeSnapshotStrings;
+class DimeStats;
+class DimeAsyncControl;
+class dimeFileWriter;
 
 class  DimeOutput
 {
@@ -50,6 +58,15 @@ public:
 	bool setFilename(const char* filename);
 	void setBinary(bool state = true);
 	bool isBinary() const;
+	bool setCompression(dimeCompression compression, int level = -1, int numthreads = 1);
+	dimeCompression getCompression() const;
+	bool finish();
+	void setNumThreads(int num);
+	int getNumThreads() const;
+	void setStats(DimeStats* stats);
+	DimeStats* getStats() const;
+	void setAsyncControl(DimeAsyncControl* control);
+	DimeAsyncControl* getAsyncControl() const;
 
 	bool writeGroupCode(int groupcode);
 	bool writeInt8(int8_t val);
@@ -59,20 +76,85 @@ public:
 	bool writeDouble(dxfdouble val);
 	bool writeString(const char* str);
 
+	bool writeEntities(DimeEntity* const* entities, int num);
+
 	int getUniqueHandleId();
 
 private:
+	bool print(const char* format, ...);
+	void addProgress(int numgroups);
+	bool checkAborted();
+	bool formatEntities(DimeEntity* const* entities, int num);
+	bool copySource(const DimeSection* section);
+	bool writeBytes(const char* data, long num);
+	bool writeValue(int type, const void* data, int size);
+	bool writeBinary(const void* data, int size);
+	bool writeBinaryValue(int32_t val);
+	bool writeBinaryValue(dxfmath val);
+	static const dimeSourceRange* findUnchanged(const dimeSourceData* source,
+	                                            DimeEntity* entity);
+
 	friend class DimeModel;
+	friend class DimeStreamWriter;
 	DimeModel* model;
 	FILE* fp;
 	bool binary;
 
+	// compressed output
+	dimeFileWriter* writer;
+	dimeCompression compression;
+	int compressionLevel;
+	int compressionThreads;
+	bool openWriter();
+	bool closeWriter();
+
 	int (*callback)(float, void*);
 	void* callbackdata;
 	int numrecords;
 	int numwrites;
 	bool aborted;
 	bool didOpenFile;
+	int numThreads;
+
+	// memory output used for formatting in worker threads
+	char* buffer;
+	size_t bufferSize;
+	size_t bufferAlloc;
+
+	// string table, only set when writing a snapshot
+	dimeSnapshotStrings* strings;
+
+	// binary output state
+	bool wroteSentinel;
+	int groupCode;
+
+	DimeStats* stats;
+	DimeAsyncControl* asyncControl;
+	long bytesWritten;
 }; // class dimeOutput
 
+inline int
+DimeOutput::getNumThreads() const
+{
+	return this->numThreads;
+}
+
+inline DimeStats*
+DimeOutput::getStats() const
+{
+	return this->stats;
+}
+
+inline dimeCompression
+DimeOutput::getCompression() const
+{
+	return this->compression;
+}
+
+inline DimeAsyncControl*
+DimeOutput::getAsyncControl() const
+{
+	return this->asyncControl;
+}
+
 #endif // ! DIME_OUTPUT_H
@@ -39,6 +39,7 @@ class DimeInput;
 
 class DimeOutput;
 class DimeRecord;
+struct dimeMemoryUsage;
 
 class  DimeRecordHolder : public DimeBase
 {
@@ -62,6 +63,7 @@ public:
 	virtual bool write(DimeOutput* out);
 	bool isOfType(int thetypeid) const override;
 	virtual int countRecords() const;
+	virtual size_t countMemory(dimeMemoryUsage& usage) const;
 
 	DimeRecord* findRecord(int groupcode, int index = 0);
 
@@ -75,6 +77,7 @@ protected:
 	bool copyRecords(DimeRecordHolder* rh) const;
 
 	virtual bool shouldWriteRecord(int groupcode) const;
+	virtual void recordsChanged();
 
 protected:
 	DimeRecord** records;
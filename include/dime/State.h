@@ -63,6 +63,7 @@ public:
 	unsigned int getFlags() const;
 
 	const DimeInsert* getCurrentInsert() const;
+	const DimeInsert* getRootInsert() const;
 
 private:
 	friend class DimeInsert;
@@ -70,6 +71,7 @@ private:
 	dimeMatrix invmatrix; // to speed up things...
 	unsigned int flags;
 	const DimeInsert* currentInsert;
+	const DimeInsert* rootInsert;
 }; // class dimeState
 
 inline const dimeMatrix&
@@ -96,4 +98,10 @@ DimeState::getCurrentInsert() const
 	return this->currentInsert;
 }
 
+inline const DimeInsert*
+DimeState::getRootInsert() const
+{
+	return this->rootInsert;
+}
+
 #endif // ! DIME_STATE_H
@@ -0,0 +1,85 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#ifndef DIME_STATS_H
+#define DIME_STATS_H
+
+#include <dime/Basic.h>
+
+struct dimeStatsData;
+
+class  DimeStats
+{
+public:
+	enum Section
+	{
+		HEADER,
+		CLASSES,
+		TABLES,
+		BLOCKS,
+		ENTITIES,
+		OBJECTS,
+		OTHER,
+		NUM_SECTIONS
+	};
+
+	DimeStats();
+	~DimeStats();
+
+	static bool isEnabled();
+	void reset();
+
+	double getSectionTime(Section section) const;
+	uint64_t getSectionBytes(Section section) const;
+	uint64_t getNumRecords(int recordtype) const;
+	uint64_t getNumEntities(int entitytype) const;
+	uint64_t getNumDictLookups() const;
+	uint64_t getNumDictCollisions() const;
+	uint64_t getNumBSPInserts() const;
+	uint64_t getNumBSPSplits() const;
+	uint64_t getNumTessellatedVertices(int entitytype) const;
+	uint64_t getBytesWritten() const;
+	double getWriteTime() const;
+
+	void print(FILE* fp) const;
+
+	static Section getSection(const char* sectionname);
+
+private:
+	DimeStats(const DimeStats&) = delete;
+	DimeStats& operator=(const DimeStats&) = delete;
+
+	friend struct dimeStatsData;
+	dimeStatsData* data;
+}; // class DimeStats
+
+#endif // ! DIME_STATS_H
@@ -0,0 +1,91 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#ifndef DIME_STREAMWRITER_H
+#define DIME_STREAMWRITER_H
+
+#include <dime/Basic.h>
+#include <dime/util/Linear.h>
+
+class DimeModel;
+class DimeOutput;
+class DimeEntity;
+
+class  DimeStreamWriter
+{
+public:
+	DimeStreamWriter(DimeOutput* out);
+	~DimeStreamWriter();
+
+	bool begin(DimeModel* model = nullptr);
+	bool writeEntity(DimeEntity* entity);
+	bool writeEntity(const char* entityname,
+	                 const int* groupcodes,
+	                 const dimeParam* params,
+	                 int numrecords,
+	                 const char* layername = "0",
+	                 int16_t colnum = 256);
+	bool writePoint(const dimeVec3& p,
+	                const char* layername = "0",
+	                int16_t colnum = 256);
+	bool writeLine(const dimeVec3& p0, const dimeVec3& p1,
+	               const char* layername = "0",
+	               int16_t colnum = 256);
+	bool write3DFace(const dimeVec3& p0, const dimeVec3& p1,
+	                 const dimeVec3& p2, const dimeVec3& p3,
+	                 const char* layername = "0",
+	                 int16_t colnum = 256);
+	bool end();
+
+	int getNumEntities() const;
+	bool isHandleSeedPatched() const;
+
+private:
+	bool writeHeader();
+	bool writeCommon(const char* entityname,
+	                 const char* layername,
+	                 int16_t colnum);
+	bool writeCoords(int groupcode, const dimeVec3& p);
+	int nextHandle();
+
+	DimeOutput* out;
+	DimeModel* model;
+	int sectionIdx;
+	int numEntities;
+	int handle;
+	long handleSeedPos;
+	bool handleSeedPatched;
+	bool active;
+	bool ok;
+}; // class DimeStreamWriter
+
+#endif // ! DIME_STREAMWRITER_H
@@ -58,6 +58,7 @@ public:
 	bool write(DimeOutput* out) override;
 	bool isOfType(int thetypeid) const override;
 	int countRecords() const override;
+	size_t countMemory(dimeMemoryUsage& usage) const override;
 
 	const char* getClassName() const;
 	const char* getApplicationName() const;
@@ -35,15 +35,40 @@
 
 #include <stdio.h>
 #include <dime/Basic.h>
+#include <dime/util/Array.h>
+#include <dime/util/Linear.h>
 
 class DimeModel;
 class dxfLayerData;
 class DimeState;
 class DimeEntity;
+class dxfTessellationCache;
+class dimeLayer;
+struct dxfGroupTable;
+class dxfGeometrySink;
+class dxfVrmlWriter;
+class dxfMeshOptimizer;
+class DimeStats;
 
 class  dxfConverter
 {
 public:
+	enum OriginMode
+	{
+		ORIGIN_NONE,
+		ORIGIN_FIRST_POINT,
+		ORIGIN_EXTENTS,
+		ORIGIN_CUSTOM
+	};
+
+	enum GroupMode
+	{
+		GROUP_BY_COLOR,
+		GROUP_BY_LAYER,
+		GROUP_BY_INSERT,
+		GROUP_BY_ENTITY
+	};
+
 	dxfConverter();
 	~dxfConverter();
 
@@ -54,10 +79,15 @@ public:
 
 	void findHeaderVariables(DimeModel& model);
 	bool doConvert(DimeModel& model);
+	bool updateConvert(DimeModel& model);
 	bool writeVrml(const char* filename, bool vrml1 = false,
 	               bool only2d = false);
 	bool writeVrml(FILE* out, bool vrml1 = false,
 	               bool only2d = false);
+	bool writeVrml(int fd, bool vrml1 = false,
+	               bool only2d = false);
+	bool writeGeometry(dxfGeometrySink* sink);
+	void optimizeMeshes(const dxfMeshOptimizer& optimizer);
 
 	void setNumSub(const int num)
 	{
@@ -84,6 +114,80 @@ public:
 		return this->fillmode;
 	}
 
+	void setFillPolygons(const bool fill)
+	{
+		this->fillpolygons = fill;
+	}
+
+	bool getFillPolygons() const
+	{
+		return this->fillpolygons;
+	}
+
+	void setStitchLines(const bool stitch)
+	{
+		this->stitchlines = stitch;
+	}
+
+	bool getStitchLines() const
+	{
+		return this->stitchlines;
+	}
+
+	void setOriginMode(const OriginMode mode)
+	{
+		this->originmode = mode;
+	}
+
+	OriginMode getOriginMode() const
+	{
+		return this->originmode;
+	}
+
+	void setOrigin(const dimeVec3& origin)
+	{
+		this->origin = origin;
+		this->originmode = ORIGIN_CUSTOM;
+	}
+
+	const dimeVec3& getOrigin() const
+	{
+		return this->origin;
+	}
+
+	void setGroupMode(const GroupMode mode)
+	{
+		this->groupmode = mode;
+	}
+
+	GroupMode getGroupMode() const
+	{
+		return this->groupmode;
+	}
+
+	void setIncremental(const bool onoff)
+	{
+		this->incremental = onoff;
+	}
+
+	bool getIncremental() const
+	{
+		return this->incremental;
+	}
+
+	void setEntityIds(const bool onoff)
+	{
+		this->entityids = onoff;
+	}
+
+	bool getEntityIds() const
+	{
+		return this->entityids;
+	}
+
+	int getNumEntities() const;
+	const DimeEntity* getEntity(int id) const;
+
 	bool getLayercol() const
 	{
 		return this->layercol;
@@ -97,6 +201,7 @@ public:
 	dxfLayerData* getLayerData(int colidx);
 	dxfLayerData* getLayerData(const DimeEntity* entity);
 	dxfLayerData** getLayerData();
+	void getGroups(dimeArray<dxfLayerData*>& groups) const;
 	int getColorIndex(const DimeEntity* entity);
 
 	int getCurrentInsertColorIndex() const
@@ -104,18 +209,58 @@ public:
 		return currentInsertColorIndex;
 	}
 
+	dxfTessellationCache* getTessellationCache() const
+	{
+		return tessCache;
+	}
+
+	void setStats(DimeStats* stats)
+	{
+		this->stats = stats;
+	}
+
+	DimeStats* getStats() const
+	{
+		return this->stats;
+	}
+
 private:
 	friend class dime2Profit;
 	friend class dime2So;
 
+	bool writeVrmlLayers(dxfVrmlWriter* writer);
+	void findOrigin(DimeModel& model);
+	void clearGroups();
+	bool convertEntity(const DimeState* state, DimeEntity* entity);
+	int findEntityId(const DimeEntity* source);
+	void setEntityLayer(dxfLayerData* ld);
+	void clearDirty(DimeModel& model);
+
 	dxfLayerData* layerData[255];
 	int dummy[4];
 	dxfdouble maxerr;
 	int currentInsertColorIndex;
 	DimeEntity* currentPolyline;
+	dxfTessellationCache* tessCache;
 	int numsub;
 	bool fillmode;
+	bool fillpolygons;
+	bool stitchlines;
 	bool layercol;
+	bool entityids;
+	bool incremental;
+	bool trackentities;
+	GroupMode groupmode;
+	dxfGroupTable* groups;
+	int currentEntityId;
+	const DimeEntity* currentSource;
+	const dimeLayer* currentLayer;
+	OriginMode originmode;
+	dimeVec3 origin;
+	bool hasextents;
+	dimeVec3 extmin;
+	dimeVec3 extmax;
+	DimeStats* stats;
 };
 
 #endif // _DXF2VRML_CONVERT_H_
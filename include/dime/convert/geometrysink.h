@@ -0,0 +1,61 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#ifndef _DXF2VRML_GEOMETRYSINK_H_
+#define _DXF2VRML_GEOMETRYSINK_H_
+
+#include <dime/Basic.h>
+#include <dime/util/Linear.h>
+
+class  dxfGeometrySink
+{
+public:
+	virtual ~dxfGeometrySink();
+
+	virtual bool begin();
+	virtual void setOrigin(const dimeVec3& origin);
+	virtual void setGroupInfo(const char* layername, int entityid);
+	virtual void setEntityRanges(const int* ranges, int numranges);
+	virtual void beginLayer(int colidx,
+	                        dxfdouble r, dxfdouble g, dxfdouble b) = 0;
+	virtual void setFaceNormals(const dimeVec3* normals, int numnormals,
+	                            const int* normalindices);
+	virtual void addFaces(const dimeVec3* verts, int numverts,
+	                      const int* indices, int numindices) = 0;
+	virtual void addLines(const dimeVec3* verts, int numverts,
+	                      const int* indices, int numindices) = 0;
+	virtual void addPoints(const dimeVec3* pts, int numpts) = 0;
+	virtual void endLayer() = 0;
+	virtual bool end();
+};
+
+#endif // _DXF2VRML_GEOMETRYSINK_H_
@@ -36,8 +36,12 @@
 #include <dime/util/Linear.h>
 #include <dime/util/Array.h>
 #include <dime/util/BSPTree.h>
+#include <dime/util/PointSet.h>
 #include <stdio.h>
 
+class dxfGeometrySink;
+class dimeLayer;
+
 class  dxfLayerData
 {
 public:
@@ -45,10 +49,26 @@ public:
 	~dxfLayerData();
 
 	void setFillmode(bool fillmode);
+	void setGroup(const dimeLayer* layer, int entityid);
+	void setCurrentEntity(int entityid);
+	void setOrigin(const dimeVec3& origin);
+	const dimeVec3& getOrigin() const;
+	bool usesFloatPoints() const;
+
+	int getNumFaceVertices() const;
+	int getNumLineVertices() const;
+	const dimeVec3* getFaceVertices(dimeArray<dimeVec3>& tmp) const;
+	const dimeVec3* getLineVertices(dimeArray<dimeVec3>& tmp) const;
+	void setFaceVertices(const dimeVec3* verts, int numverts);
+	void setLineVertices(const dimeVec3* verts, int numverts);
+	bool isEmpty() const;
 
 	void addLine(const dimeVec3& v0, const dimeVec3& v1,
 	             const dimeMatrix* matrix = nullptr);
 
+	void addLineStrip(const dimeVec3* pts, int numpts,
+	                  const dimeMatrix* matrix = nullptr);
+
 	void addPoint(const dimeVec3& v,
 	              const dimeMatrix* matrix = nullptr);
 
@@ -62,8 +82,12 @@ public:
 	             const dimeVec3& v3,
 	             const dimeMatrix* matrix = nullptr);
 
+	void stitchLines(bool mergeloops = true);
+	void removeEntities(const int* ids, int numids);
+
 	void writeWrl(FILE* fp, int indent, bool vrml1,
 	              bool only2d);
+	void writeGeometry(dxfGeometrySink* sink, bool entityranges = true);
 
 	//private:
 public: // 20011001 thammer - please don't kill me for this ;-)
@@ -71,13 +95,53 @@ public: // 20011001 thammer - please don't kill me for this ;-)
 	friend class dime2So;
 	friend class dime2Profit;
 
+	int addFaceVertex(const dimeVec3& v);
+	int addLineVertex(const dimeVec3& v);
+	void markFaceEntity();
+	void markLineEntity();
+	void markPointEntity();
+	void compactFaceVertices();
+	void compactLineVertices();
+	static const dimeVec3* toDouble(const dimePointSet& points,
+	                                dimeArray<dimeVec3>& tmp);
+
 	bool fillmode;
+	bool floatpoints;
 	int colidx;
+	const dimeLayer* grouplayer;
+	int groupentity;
+	int currententity;
+	dimeVec3 origin;
 	dimeBSPTree facebsp;
 	dimeArray<int> faceindices;
+	dimeArray<dimeVec3> facenormals;
+	dimeArray<int> normalindices;
 	dimeBSPTree linebsp;
+	dimePointSet facepoints;
+	dimePointSet linepoints;
 	dimeArray<int> lineindices;
+	dimeArray<int> faceentities;
+	dimeArray<int> lineentities;
 	dimeArray<dimeVec3> points;
+	dimeArray<int> pointentities;
 };
 
+inline const dimeVec3&
+dxfLayerData::getOrigin() const
+{
+	return this->origin;
+}
+
+inline bool
+dxfLayerData::usesFloatPoints() const
+{
+	return this->floatpoints;
+}
+
+inline bool
+dxfLayerData::isEmpty() const
+{
+	return !faceindices.count() && !lineindices.count() && !points.count();
+}
+
 #endif // _DXF2VRML_LAYERDATA_H_
@@ -0,0 +1,87 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#ifndef _DXF2VRML_MESHOPTIMIZER_H_
+#define _DXF2VRML_MESHOPTIMIZER_H_
+
+#include <dime/Basic.h>
+
+class dxfLayerData;
+
+class  dxfMeshOptimizer
+{
+public:
+	dxfMeshOptimizer();
+
+	void setCacheSize(int size);
+	int getCacheSize() const;
+	void setCreaseAngle(dxfdouble angle);
+	dxfdouble getCreaseAngle() const;
+	void setNormals(bool onoff);
+	bool getNormals() const;
+	void setNumThreads(int num);
+	int getNumThreads() const;
+
+	void optimize(dxfLayerData* layer) const;
+
+private:
+	int cacheSize;
+	dxfdouble creaseAngle;
+	bool normals;
+	int numThreads;
+};
+
+inline int
+dxfMeshOptimizer::getCacheSize() const
+{
+	return this->cacheSize;
+}
+
+inline dxfdouble
+dxfMeshOptimizer::getCreaseAngle() const
+{
+	return this->creaseAngle;
+}
+
+inline bool
+dxfMeshOptimizer::getNormals() const
+{
+	return this->normals;
+}
+
+inline int
+dxfMeshOptimizer::getNumThreads() const
+{
+	return this->numThreads;
+}
+
+#endif // _DXF2VRML_MESHOPTIMIZER_H_
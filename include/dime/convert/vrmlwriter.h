@@ -0,0 +1,103 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#ifndef _DXF2VRML_VRMLWRITER_H_
+#define _DXF2VRML_VRMLWRITER_H_
+
+#include <dime/convert/geometrysink.h>
+#include <stdio.h>
+#include <stddef.h>
+
+class  dxfVrmlWriter : public dxfGeometrySink
+{
+public:
+	dxfVrmlWriter(FILE* fp, bool vrml1 = false, bool only2d = false);
+	dxfVrmlWriter(int fd, bool vrml1 = false, bool only2d = false);
+	~dxfVrmlWriter() override;
+
+	void setPrecision(int digits);
+	int getPrecision() const;
+	void setIndicesPerLine(int num);
+
+	bool begin() override;
+	void setOrigin(const dimeVec3& origin) override;
+	void setGroupInfo(const char* layername, int entityid) override;
+	void beginLayer(int colidx,
+	                dxfdouble r, dxfdouble g, dxfdouble b) override;
+	void setFaceNormals(const dimeVec3* normals, int numnormals,
+	                    const int* normalindices) override;
+	void addFaces(const dimeVec3* verts, int numverts,
+	              const int* indices, int numindices) override;
+	void addLines(const dimeVec3* verts, int numverts,
+	              const int* indices, int numindices) override;
+	void addPoints(const dimeVec3* pts, int numpts) override;
+	void endLayer() override;
+	bool end() override;
+
+	bool flush();
+
+private:
+	void init(bool vrml1, bool only2d);
+	void put(const char* str);
+	void put(const char* str, size_t len);
+	void putDouble(dxfdouble val, int precision);
+	void putInt(int val);
+	void putColor(dxfdouble r, dxfdouble g, dxfdouble b);
+	void putCoords(const dimeVec3* verts, int numverts, bool flatten);
+	void putIndices(const int* indices, int numindices, bool terminate);
+	void reserve(size_t len);
+
+	FILE* fp;
+	int fd;
+	bool vrml1;
+	bool only2d;
+	bool error;
+	bool translated;
+	int precision;
+	int indicesPerLine;
+	dxfdouble r, g, b;
+	const dimeVec3* normals;
+	int numNormals;
+	const int* normalIndices;
+	char groupName[64];
+	char* buffer;
+	size_t bufferSize;
+	size_t used;
+};
+
+inline int
+dxfVrmlWriter::getPrecision() const
+{
+	return this->precision;
+}
+
+#endif // _DXF2VRML_VRMLWRITER_H_
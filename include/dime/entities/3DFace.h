@@ -70,6 +70,7 @@ public:
 	bool write(DimeOutput* out) override;
 	TypeID typeId() const override;
 	int countRecords() const override;
+	size_t countMemory(dimeMemoryUsage& usage) const override;
 
 protected:
 	bool handleRecord(int groupcode,
@@ -61,6 +61,7 @@ public:
 	bool write(DimeOutput* out) override;
 	TypeID typeId() const override;
 	int countRecords() const override;
+	size_t countMemory(dimeMemoryUsage& usage) const override;
 
 	GeometryType extractGeometry(dimeArray<dimeVec3>& verts,
 	                                     dimeArray<int>& indices,
@@ -86,6 +87,7 @@ inline void
 DimeArc::setCenter(const dimeVec3& c)
 {
 	this->center = c;
+	this->setDirty();
 }
 
 inline dimeVec3
@@ -98,6 +100,7 @@ inline void
 DimeArc::setRadius(const dxfdouble r)
 {
 	this->radius = r;
+	this->setDirty();
 }
 
 inline dxfdouble
@@ -110,6 +113,7 @@ inline void
 DimeArc::setStartAngle(const dxfdouble a)
 {
 	this->startAngle = a;
+	this->setDirty();
 }
 
 inline dxfdouble
@@ -122,6 +126,7 @@ inline void
 DimeArc::setEndAngle(const dxfdouble a)
 {
 	this->endAngle = a;
+	this->setDirty();
 }
 
 inline dxfdouble
@@ -47,6 +47,7 @@ class  DimeBlock : public DimeEntity
 	friend class DimeEntitiesSection;
 	friend class DimeInsert;
 	friend class DimeModel;
+	friend class DimeOutput;
 
 public:
 	DimeBlock();
@@ -73,6 +74,7 @@ public:
 	bool write(DimeOutput* out) override;
 	TypeID typeId() const override;
 	int countRecords() const override;
+	size_t countMemory(dimeMemoryUsage& usage) const override;
 
 protected:
 	bool handleRecord(int groupcode,
@@ -98,6 +100,8 @@ public:
 	TypeID typeId() const override {return DimeBase::dimeEndBlockType; }
 	const char* getEntityName() const override { return "ENDBLK"; }
 	DimeEntity* copy(DimeModel* model) const override { return new DimeEndBlock; }
+	size_t countMemory(dimeMemoryUsage& usage) const override { return sizeof(DimeEndBlock) + DimeEntity::countMemory(usage); }
+	bool write(DimeOutput* out) override { return this->preWrite(out) && DimeEntity::write(out); }
 };
 
 inline const dimeVec3&
@@ -110,6 +114,7 @@ inline void
 DimeBlock::setBasePoint(const dimeVec3& v)
 {
 	this->basePoint = v;
+	this->setDirty();
 }
 
 inline int
@@ -135,6 +140,7 @@ inline void
 DimeBlock::setName(const char* const name)
 {
 	this->name = name;
+	this->setDirty();
 }
 
 #endif // ! DIME_BLOCK_H
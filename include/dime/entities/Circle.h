@@ -59,6 +59,7 @@ public:
 	bool write(DimeOutput* out) override;
 	TypeID typeId() const override;
 	int countRecords() const override;
+	size_t countMemory(dimeMemoryUsage& usage) const override;
 
 	GeometryType extractGeometry(dimeArray<dimeVec3>& verts,
 	                             dimeArray<int>& indices,
@@ -84,12 +85,14 @@ inline void
 DimeCircle::setCenter(const dimeVec3& c)
 {
 	this->center = c;
+	this->setDirty();
 }
 
 inline void
 DimeCircle::setRadius(const dxfdouble val)
 {
 	this->radius = val;
+	this->setDirty();
 }
 
 inline dxfdouble
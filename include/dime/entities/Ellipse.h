@@ -69,6 +69,7 @@ public:
 	bool write(DimeOutput* out) override;
 	TypeID typeId() const override;
 	int countRecords() const override;
+	size_t countMemory(dimeMemoryUsage& usage) const override;
 
 protected:
 	bool handleRecord(int groupcode,
@@ -92,12 +93,14 @@ inline void
 DimeEllipse::setCenter(const dimeVec3& c)
 {
 	this->center = c;
+	this->setDirty();
 }
 
 inline void
 DimeEllipse::setMajorAxisEndpoint(const dimeVec3& v)
 {
 	this->majorAxisEndpoint = v;
+	this->setDirty();
 }
 
 inline const dimeVec3&
@@ -110,6 +113,7 @@ inline void
 DimeEllipse::setMinorMajorRatio(const dxfdouble ratio)
 {
 	this->ratio = ratio;
+	this->setDirty();
 }
 
 inline dxfdouble
@@ -122,6 +126,7 @@ inline void
 DimeEllipse::setStartParam(const dxfdouble p)
 {
 	this->startParam = p;
+	this->setDirty();
 }
 
 inline dxfdouble
@@ -134,6 +139,7 @@ inline void
 DimeEllipse::setEndParam(const dxfdouble p)
 {
 	this->endParam = p;
+	this->setDirty();
 }
 
 inline dxfdouble
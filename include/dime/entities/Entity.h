@@ -52,7 +52,9 @@
 #define FLAG_ACAD_XDICTIONARY 0x0100 // ACAD xdictionary in entity
 #define FLAG_PAPERSPACE       0x0200 // entity is in paperspace
 #define FLAG_LINETYPE         0x0400 // linetype specified in entity
-#define FLAG_FIRST_FREE       0x0800 // use this if you want to define your own flags
+#define FLAG_DIRTY            0x0800 // entity changed, see dimeEntity::isDirty()
+#define FLAG_MODIFIED         0x1000 // entity changed, see dimeEntity::isModified()
+#define FLAG_FIRST_FREE       0x2000 // use this if you want to define your own flags
 
 class dimeLayer;
 class DimeModel;
@@ -64,6 +66,7 @@ class  DimeEntity : public DimeRecordHolder
 	friend class DimePolyline;
 	friend class DimeBlock;
 	friend class DimeInsert;
+	friend class DimeOutput;
 
 public:
 	DimeEntity();
@@ -93,6 +96,11 @@ public:
 	bool isTagged() const;
 	void setTagged(bool onOff = true);
 
+	bool isDirty() const;
+	void setDirty(bool onOff = true);
+	bool isModified() const;
+	void setModified(bool onOff = true);
+
 	bool getRecord(int groupcode,
 	               dimeParam& param,
 	               int index = 0) const override;
@@ -120,6 +128,7 @@ protected:
 	bool handleRecord(int groupcode,
 	                  const dimeParam& param) override;
 	bool shouldWriteRecord(int groupcode) const override;
+	void recordsChanged() override;
 
 public:
 	static DimeEntity* createEntity(const char* name);
@@ -134,6 +143,8 @@ public:
 	static DimeEntity** copyEntityArray(const DimeEntity* const* const array,
 	                                    int& nument,
 	                                    DimeModel* model);
+	static size_t countEntityMemory(const DimeEntity* entity,
+	                                dimeMemoryUsage& usage);
 
 	static void arbitraryAxis(const dimeVec3& givenaxis, dimeVec3& newaxis);
 	static void generateUCS(const dimeVec3& givenaxis, dimeMatrix& m);
@@ -145,6 +156,7 @@ private:
 	const dimeLayer* layer;
 	int16_t entityFlags;
 	int16_t colorNumber;
+	int32_t sourceIndex; // see DimeModel::setPassthrough()
 }; // class dimeEntity
 
 inline const dimeLayer*
@@ -163,6 +175,7 @@ inline void
 DimeEntity::setColorNumber(const int16_t c)
 {
 	this->colorNumber = c;
+	this->setDirty();
 }
 
 inline int16_t
@@ -177,5 +190,31 @@ DimeEntity::setEntityFlags(const int16_t flags)
 	this->entityFlags = flags;
 }
 
+inline bool
+DimeEntity::isDirty() const
+{
+	return (this->entityFlags & FLAG_DIRTY) != 0;
+}
+
+inline void
+DimeEntity::setDirty(const bool onOff)
+{
+	if (onOff) this->entityFlags |= FLAG_DIRTY | FLAG_MODIFIED;
+	else this->entityFlags &= ~FLAG_DIRTY;
+}
+
+inline bool
+DimeEntity::isModified() const
+{
+	return (this->entityFlags & FLAG_MODIFIED) != 0;
+}
+
+inline void
+DimeEntity::setModified(const bool onOff)
+{
+	if (onOff) this->entityFlags |= FLAG_MODIFIED;
+	else this->entityFlags &= ~FLAG_MODIFIED;
+}
+
 
 #endif // ! DIME_ENTITY_H
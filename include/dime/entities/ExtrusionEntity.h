@@ -70,6 +70,7 @@ inline void
 DimeExtrusionEntity::setExtrusionDir(const dimeVec3& v)
 {
 	this->extrusionDir = v;
+	this->setDirty();
 }
 
 inline const dimeVec3&
@@ -82,6 +83,7 @@ inline void
 DimeExtrusionEntity::setThickness(const dxfdouble val)
 {
 	this->thickness = val;
+	this->setDirty();
 }
 
 inline dxfdouble
@@ -97,6 +97,7 @@ dimeFaceEntity::setVertex(const int idx, const dimeVec3& v)
 {
 	assert(idx >= 0 && idx < 4);
 	this->coords[idx] = v;
+	this->setDirty();
 }
 
 #endif // ! DIME_FACEENTITY_H
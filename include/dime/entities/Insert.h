@@ -61,6 +61,7 @@ public:
 	bool write(DimeOutput* out) override;
 	TypeID typeId() const override;
 	int countRecords() const override;
+	size_t countMemory(dimeMemoryUsage& usage) const override;
 
 	void setInsertionPoint(const dimeVec3& v);
 	const dimeVec3& getInsertionPoint() const;
@@ -108,6 +109,7 @@ inline void
 DimeInsert::setInsertionPoint(const dimeVec3& v)
 {
 	this->insertionPoint = v;
+	this->setDirty();
 }
 
 inline const dimeVec3&
@@ -126,6 +128,7 @@ inline void
 DimeInsert::setScale(const dimeVec3& v)
 {
 	this->scale = v;
+	this->setDirty();
 }
 
 inline const dimeVec3&
@@ -138,6 +141,7 @@ inline void
 DimeInsert::setRotAngle(dxfdouble angle)
 {
 	this->rotAngle = angle;
+	this->setDirty();
 }
 
 inline dxfdouble
@@ -53,6 +53,7 @@ public:
 	bool write(DimeOutput* out) override;
 	TypeID typeId() const override;
 	int countRecords() const override;
+	size_t countMemory(dimeMemoryUsage& usage) const override;
 
 	GeometryType extractGeometry(dimeArray<dimeVec3>& verts,
 	                             dimeArray<int>& indices,
@@ -79,6 +80,7 @@ DimeLine::setCoords(const int idx, const dimeVec3& v)
 {
 	assert(idx ==0 || idx == 1);
 	this->coords[idx] = v;
+	this->setDirty();
 }
 
 #endif // ! DIME_LINE_H
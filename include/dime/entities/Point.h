@@ -54,6 +54,7 @@ public:
 	bool write(DimeOutput* out) override;
 	TypeID typeId() const override;
 	int countRecords() const override;
+	size_t countMemory(dimeMemoryUsage& usage) const override;
 
 	GeometryType extractGeometry(dimeArray<dimeVec3>& verts,
 	                             dimeArray<int>& indices,
@@ -78,6 +79,7 @@ inline void
 DimePoint::setCoords(const dimeVec3& v)
 {
 	this->coords = v;
+	this->setDirty();
 }
 
 #endif // ! DIME_POINT_H
@@ -118,6 +118,7 @@ public:
 	bool write(DimeOutput* out) override;
 	TypeID typeId() const override;
 	int countRecords() const override;
+	size_t countMemory(dimeMemoryUsage& usage) const override;
 
 	GeometryType extractGeometry(dimeArray<dimeVec3>& verts,
 	                             dimeArray<int>& indices,
@@ -173,6 +174,7 @@ inline void
 DimePolyline::setFlags(const int16_t flags)
 {
 	this->flags = flags;
+	this->setDirty();
 }
 
 inline const dimeVec3&
@@ -185,6 +187,7 @@ inline void
 DimePolyline::setElevation(const dimeVec3& e)
 {
 	this->elevation = e;
+	this->setDirty();
 }
 
 inline int16_t
@@ -257,6 +260,7 @@ inline void
 DimePolyline::setSurfaceType(const int16_t type)
 {
 	this->surfaceType = type;
+	this->setDirty();
 }
 
 
@@ -54,6 +54,7 @@ public:
 	               int index = 0) const override;
 	const char* getEntityName() const override;
 	int countRecords() const override;
+	size_t countMemory(dimeMemoryUsage& usage) const override;
 
 protected:
 	bool swapQuadCoords() const override;
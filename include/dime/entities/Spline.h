@@ -94,12 +94,27 @@ public:
 	bool write(DimeOutput* out) override;
 	TypeID typeId() const override;
 	int countRecords() const override;
+	size_t countMemory(dimeMemoryUsage& usage) const override;
+
+	GeometryType extractGeometry(dimeArray<dimeVec3>& verts,
+	                             dimeArray<int>& indices,
+	                             dimeVec3& extrusionDir,
+	                             dxfdouble& thickness) override;
+
+	bool canEvaluate() const;
+	void getParameterRange(dxfdouble& tmin, dxfdouble& tmax) const;
+	dimeVec3 evaluate(dxfdouble t) const;
+	void evaluate(const dxfdouble* params, int numparams,
+	              dimeVec3* result) const;
+	bool tessellate(dimeArray<dimeVec3>& verts, dxfdouble maxerr) const;
 
 protected:
 	bool handleRecord(int groupcode,
 	                  const dimeParam& param) override;
 
 private:
+	int findSpan(dxfdouble t, int hint) const;
+
 	int16_t flags;
 #ifdef DIME_FIXBIG
   int32_t degree;
@@ -137,6 +152,7 @@ inline void
 DimeSpline::setFlags(const int16_t flags)
 {
 	this->flags = flags;
+	this->setDirty();
 }
 
 inline int16_t
@@ -149,6 +165,7 @@ inline void
 DimeSpline::setDegree(const int16_t degree)
 {
 	this->degree = degree;
+	this->setDirty();
 }
 
 inline dxfdouble
@@ -161,6 +178,7 @@ inline void
 DimeSpline::setControlPointTolerance(const dxfdouble tol)
 {
 	this->cpTolerance = tol;
+	this->setDirty();
 }
 
 inline dxfdouble
@@ -173,6 +191,7 @@ inline void
 DimeSpline::setFitPointTolerance(const dxfdouble tol)
 {
 	this->fitTolerance = tol;
+	this->setDirty();
 }
 
 inline dxfdouble
@@ -185,6 +204,7 @@ inline void
 DimeSpline::setKnotTolerance(const dxfdouble tol)
 {
 	this->knotTolerance = tol;
+	this->setDirty();
 }
 
 inline int
@@ -205,6 +225,7 @@ DimeSpline::setKnotValue(const int idx, const dxfdouble value)
 {
 	assert(idx >= 0 && idx < this->numKnots);
 	this->knots[idx] = value;
+	this->setDirty();
 }
 
 inline int
@@ -225,6 +246,7 @@ DimeSpline::setControlPoint(const int idx, const dimeVec3& v)
 {
 	assert(idx >= 0 && idx < this->numControlPoints);
 	this->controlPoints[idx] = v;
+	this->setDirty();
 }
 
 inline int
@@ -262,6 +284,7 @@ DimeSpline::setFitPoint(const int idx, const dimeVec3& pt)
 {
 	assert(idx >= 0 && idx < this->numFitPoints);
 	this->fitPoints[idx] = pt;
+	this->setDirty();
 }
 
 #endif // ! DIME_SPLINE_H
@@ -69,6 +69,7 @@ public:
 	bool write(DimeOutput* out) override;
 	TypeID typeId() const override;
 	int countRecords() const override;
+	size_t countMemory(dimeMemoryUsage& usage) const override;
 
 	GeometryType extractGeometry(dimeArray<dimeVec3>& verts,
 	                             dimeArray<int>& indices,
@@ -101,6 +102,7 @@ inline void
 DimeText::setOrigin(const dimeVec3& o)
 {
 	this->origin = o;
+	this->setDirty();
 }
 
 inline dimeVec3
@@ -113,6 +115,7 @@ inline void
 DimeText::setSecond(const dimeVec3& s)
 {
 	this->second = s;
+	this->setDirty();
 }
 
 inline bool
@@ -130,6 +133,7 @@ inline void
 DimeText::setHeight(const dxfdouble h)
 {
 	this->height = h;
+	this->setDirty();
 }
 
 inline dxfdouble
@@ -142,6 +146,7 @@ inline void
 DimeText::setWidth(const dxfdouble w)
 {
 	this->width = w;
+	this->setDirty();
 }
 
 inline dxfdouble
@@ -154,6 +159,7 @@ inline void
 DimeText::setRotation(const dxfdouble a)
 {
 	this->rotation = a;
+	this->setDirty();
 }
 
 inline dxfdouble
@@ -166,6 +172,7 @@ inline void
 DimeText::setHJust(const int32_t h)
 {
 	this->hJust = h;
+	this->setDirty();
 }
 
 inline int32_t
@@ -178,6 +185,7 @@ inline void
 DimeText::setVJust(const int32_t v)
 {
 	this->vJust = v;
+	this->setDirty();
 }
 
 inline int32_t
@@ -77,6 +77,7 @@ public:
 	bool write(DimeOutput* out) override;
 	TypeID typeId() const override;
 	int countRecords() const override;
+	size_t countMemory(dimeMemoryUsage& usage) const override;
 
 protected:
 	bool handleRecord(int groupcode,
@@ -97,6 +98,7 @@ inline void
 DimeVertex::setCoords(const dimeVec3& v)
 {
 	this->coords = v;
+	this->setDirty();
 }
 
 inline const dimeVec3&
@@ -110,6 +112,7 @@ DimeVertex::setIndex(const int idx, const int val)
 {
 	assert(idx >= 0 && idx < 4);
 	this->indices[idx] = val;
+	this->setDirty();
 }
 
 inline int16_t
@@ -122,6 +125,7 @@ inline void
 DimeVertex::setFlags(const int16_t flags)
 {
 	this->flags = flags;
+	this->setDirty();
 }
 
 #endif // ! DIME_VERTEX_H
@@ -39,6 +39,7 @@
 
 class DimeInput;
 class DimeOutput;
+struct dimeMemoryUsage;
 
 class  DimeRecord : public DimeBase
 {
@@ -59,6 +60,7 @@ public:
 	TypeID typeId() const override = 0;
 	virtual bool read(DimeInput* in) = 0;
 	virtual bool write(DimeOutput* out);
+	size_t countMemory(dimeMemoryUsage& usage) const;
 
 public:
 	static bool readRecordData(DimeInput* in, int group_code, dimeParam& param);
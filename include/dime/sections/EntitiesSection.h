@@ -51,6 +51,7 @@ public:
 	bool write(DimeOutput* file) override;
 	TypeID typeId() const override;
 	int countRecords() const override;
+	size_t countMemory(dimeMemoryUsage& usage) const override;
 
 	void fixReferences(DimeModel* model);
 
@@ -64,8 +64,10 @@ public:
 	bool write(DimeOutput* file) override;
 	TypeID typeId() const override;
 	int countRecords() const override;
+	size_t countMemory(dimeMemoryUsage& usage) const override;
 
 private:
+	friend class DimeStreamWriter;
 	int findVariable(const char* name) const;
 
 	dimeArray<class DimeRecord*> records;
@@ -39,9 +39,13 @@
 class DimeInput;
 class DimeModel;
 class DimeOutput;
+struct dimeMemoryUsage;
 
 class  DimeSection : public DimeBase
 {
+	friend class DimeModel;
+	friend class DimeOutput;
+
 public:
 	DimeSection();
 	~DimeSection() override;
@@ -54,8 +58,28 @@ public:
 	TypeID typeId() const override = 0;
 	bool isOfType(int thetypeid) const override;
 	virtual int countRecords() const = 0;
+	virtual size_t countMemory(dimeMemoryUsage& usage) const = 0;
+
+	bool isDirty() const;
+	void setDirty(bool onOff = true);
 
 	static DimeSection* createSection(const char* sectionname);
+
+private:
+	bool dirty;
+	int sourceIndex; // see DimeModel::setPassthrough()
 }; // class dimeSection
 
+inline bool
+DimeSection::isDirty() const
+{
+	return this->dirty;
+}
+
+inline void
+DimeSection::setDirty(const bool onOff)
+{
+	this->dirty = onOff;
+}
+
 #endif // ! DIME_SECTION_H
@@ -49,6 +49,7 @@ public:
 	bool write(DimeOutput* file) override;
 	TypeID typeId() const override;
 	int countRecords() const override;
+	size_t countMemory(dimeMemoryUsage& usage) const override;
 
 	int getNumTables() const;
 	class DimeTable* getTable(int idx);
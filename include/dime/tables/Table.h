@@ -41,6 +41,7 @@ class DimeModel;
 class DimeOutput;
 class DimeTableEntry;
 class DimeRecord;
+struct dimeMemoryUsage;
 
 class  DimeTable : public DimeBase
 {
@@ -53,6 +54,7 @@ public:
 	DimeTable* copy(DimeModel* model) const;
 	TypeID typeId() const override;
 	int countRecords() const;
+	size_t countMemory(dimeMemoryUsage& usage) const;
 	int tableType() const;
 
 	void setTableName(const char* name);
@@ -39,6 +39,7 @@
 
 class dimeBox;
 class dime_bspnode;
+class DimeStats;
 
 class  dimeBSPTree
 {
@@ -48,6 +49,7 @@ public:
 
 	int numPoints() const;
 	void getPoint(int idx, dimeVec3& pt);
+	const dimeVec3* getPoints() const;
 	void* getUserData(int idx) const;
 
 	void setUserData(int idx, void* data);
@@ -60,6 +62,8 @@ public:
 
 	const dimeBox* getBBox() const;
 
+	void setStats(DimeStats* stats);
+
 private:
 	friend class dime_bspnode;
 	dimeArray<dimeVec3> pointsArray;
@@ -67,6 +71,7 @@ private:
 	dime_bspnode* topnode;
 	int maxnodepoints;
 	dimeBox* boundingBox;
+	DimeStats* stats;
 }; // class dimeBSPTree
 
 #endif // ! DIME_BSPTREE_H
@@ -36,6 +36,9 @@
 #include <dime/Basic.h>
 #include <string.h>
 
+class DimeStats;
+struct dimeMemoryUsage;
+
 class  dimeDictEntry
 {
 	friend class dimeDict;
@@ -67,9 +70,13 @@ public:
 	bool remove(const char* key);
 	void dump(void);
 
+	void setStats(DimeStats* stats);
+	size_t countMemory(dimeMemoryUsage& usage) const;
+
 private:
 	int tableSize;
 	dimeDictEntry** buckets;
+	DimeStats* stats;
 	dimeDictEntry*& findEntry(const char* key) const;
 	unsigned int bucketNr(const char* key) const;
 
@@ -267,10 +267,10 @@ public:
 
 	dimeMatrix(const dimeMatrix& matrix);
 	// Constructor given all 16 elements in row-major order
-	dimeMatrix(dxfdouble a11, dxfdouble a12, dxfdouble a13, dxfdouble a14,
-	           dxfdouble a21, dxfdouble a22, dxfdouble a23, dxfdouble a24,
-	           dxfdouble a31, dxfdouble a32, dxfdouble a33, dxfdouble a34,
-	           dxfdouble a41, dxfdouble a42, dxfdouble a43, dxfdouble a44);
+	dimeMatrix(dxfmath a11, dxfmath a12, dxfmath a13, dxfmath a14,
+	           dxfmath a21, dxfmath a22, dxfmath a23, dxfmath a24,
+	           dxfmath a31, dxfmath a32, dxfmath a33, dxfmath a34,
+	           dxfmath a41, dxfmath a42, dxfmath a43, dxfmath a44);
 	void transpose();
 	void makeIdentity();
 	bool isIdentity() const;
@@ -286,10 +286,10 @@ public:
 	void setRotate(const dimeVec3& x, const dimeVec3& y, const dimeVec3& z);
 
 	// sets matrix to rotate around given vector
-	void setRotation(const dimeVec3& u, dxfdouble angle);
+	void setRotation(const dimeVec3& u, dxfmath angle);
 
 	// Sets matrix to scale by given uniform factor
-	void setScale(dxfdouble s);
+	void setScale(dxfmath s);
 
 	// Sets matrix to scale by given vector
 	void setScale(const dimeVec3& s);
@@ -303,15 +303,21 @@ public:
 	// transforms vector
 	void multMatrixVec(dimeVec3& vec) const;
 
+	// Transforms num points from src into dst, src and dst may be equal
+	void transformPoints(const dimeVec3* src, dimeVec3* dst, int num) const;
+
+	// Returns true if the bottom row is (0, 0, 0, 1)
+	bool isAffine() const;
+
 	// Multiplies given row vector by matrix, giving vector result
 	//void multVecMatrix(const dimeVec3f &src, dimeVec3f &dst) const;
 
 	// Cast: returns pointer to storage of first element
-	operator dxfdouble*() { return &matrix[0][0]; }
+	operator dxfmath*() { return &matrix[0][0]; }
 
 	// Make it look like a usual matrix (so you can do m[3][2])
-	dxfdouble* operator [](int i) { return &matrix[i][0]; }
-	const dxfdouble* operator [](int i) const { return &matrix[i][0]; }
+	dxfmath* operator [](int i) { return &matrix[i][0]; }
+	const dxfmath* operator [](int i) const { return &matrix[i][0]; }
 
 	dimeMatrix& operator =(const dimeMatrix& m);
 
@@ -322,12 +328,12 @@ public:
 	static dimeMatrix identity();
 	bool inverse();
 	bool inverse2();
-	dxfdouble determinant(int i = -2, int j = -1);
+	dxfmath determinant(int i = -2, int j = -1);
 
-	void operator *=(dxfdouble val);
+	void operator *=(dxfmath val);
 
 private:
-	dxfdouble matrix[4][4];
+	dxfmath matrix[4][4];
 }; // class dimeMatrix
 
 #endif // ! DIME_LINEAR_H
@@ -0,0 +1,78 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#ifndef DIME_TRIANGULATOR_H
+#define DIME_TRIANGULATOR_H
+
+#include <dime/Basic.h>
+#include <dime/util/Array.h>
+#include <dime/util/Linear.h>
+
+class  dimeTriangulator
+{
+public:
+	dimeTriangulator();
+	~dimeTriangulator();
+
+	void clear();
+	void addContour(const dimeVec3* pts, int numpts);
+	int getNumVertices() const;
+	const dimeVec3& getVertex(int idx) const;
+
+	bool triangulate(dimeArray<int>& indices);
+
+	// subdivisions of a full circle used for polyline bulges in
+	// extractGeometry()
+	enum { BULGE_NUMSUB = 20 };
+
+	static void tessellateBulge(const dimeVec3& p0, const dimeVec3& p1,
+	                            dxfdouble bulge, dxfdouble maxerr, int numsub,
+	                            dimeArray<dimeVec3>& pts);
+
+private:
+	dimeArray<dimeVec3> points;
+	dimeArray<int> contourStart;
+}; // class dimeTriangulator
+
+inline int
+dimeTriangulator::getNumVertices() const
+{
+	return this->points.count();
+}
+
+inline const dimeVec3&
+dimeTriangulator::getVertex(const int idx) const
+{
+	return this->points.constArrayPointer()[idx];
+}
+
+#endif // ! DIME_TRIANGULATOR_H
@@ -0,0 +1,130 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*!
+  \class DimeAsyncControl dime/Async.h
+  \brief The DimeAsyncControl class reports progress of, and cancels,
+  an asynchronous read or write.
+
+  Pass a DimeAsyncControl to DimeModel::readAsync() or
+  DimeModel::writeAsync(), or attach it to a DimeInput or DimeOutput
+  with setAsyncControl(). The operation publishes its progress at each
+  entity boundary, from a byte counter, and stops at the next entity
+  boundary after cancel() is called. All methods can be called from
+  any thread.
+
+  \code
+  DimeAsyncControl control;
+  std::future<bool> result = model.readAsync(&in, &control);
+  ...
+  if (clientDisconnected) control.cancel();
+  bool ok = result.get(); // false if cancelled
+  \endcode
+*/
+
+#include <dime/Async.h>
+
+/*!
+  Constructor.
+*/
+
+DimeAsyncControl::DimeAsyncControl()
+	: cancelled(false), progress(0.0f), bytes(0)
+{
+}
+
+/*!
+  Asks the operation to stop at the next entity boundary. The read or
+  write then fails, as if aborted from a progress callback.
+*/
+
+void
+DimeAsyncControl::cancel()
+{
+	this->cancelled.store(true, std::memory_order_relaxed);
+}
+
+/*!
+  Returns \e true if cancel() has been called since construction or
+  the last reset().
+*/
+
+bool
+DimeAsyncControl::isCancelled() const
+{
+	return this->cancelled.load(std::memory_order_relaxed);
+}
+
+/*!
+  Clears the cancel flag and the progress, so the object can be used
+  for another operation.
+*/
+
+void
+DimeAsyncControl::reset()
+{
+	this->cancelled.store(false, std::memory_order_relaxed);
+	this->progress.store(0.0f, std::memory_order_relaxed);
+	this->bytes.store(0, std::memory_order_relaxed);
+}
+
+/*!
+  Returns the progress of the operation, between 0 and 1.
+*/
+
+float
+DimeAsyncControl::getProgress() const
+{
+	return this->progress.load(std::memory_order_relaxed);
+}
+
+/*!
+  Returns the number of bytes read or written so far.
+*/
+
+long
+DimeAsyncControl::getBytesProcessed() const
+{
+	return this->bytes.load(std::memory_order_relaxed);
+}
+
+/*!
+  Sets the progress. Called by DimeInput and DimeOutput at entity
+  boundaries.
+*/
+
+void
+DimeAsyncControl::setProgress(const float progress, const long bytes)
+{
+	this->progress.store(progress, std::memory_order_relaxed);
+	this->bytes.store(bytes, std::memory_order_relaxed);
+}
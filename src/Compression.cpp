@@ -0,0 +1,548 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif // HAVE_CONFIG_H
+
+#include "Compression.h"
+#include "Diagnostic.h"
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif // HAVE_ZLIB
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif // HAVE_ZSTD
+
+#define INPUT_SIZE 65536
+#define OUTPUT_SIZE 65536
+#define CHUNK_SIZE (1024 * 1024) // input per gzip member when compressing in parallel
+
+/*!
+  Returns \e true if this build of DIME can read and write files
+  compressed with \a compression. Uncompressed files are always
+  supported, gzip requires zlib and zstd requires libzstd when DIME
+  is built.
+*/
+
+bool
+dime_compression_supported(const dimeCompression compression)
+{
+	switch (compression)
+	{
+	case DIME_COMPRESSION_NONE:
+		return true;
+	case DIME_COMPRESSION_GZIP:
+#ifdef HAVE_ZLIB
+		return true;
+#else // ! HAVE_ZLIB
+		return false;
+#endif // ! HAVE_ZLIB
+	case DIME_COMPRESSION_ZSTD:
+#ifdef HAVE_ZSTD
+		return true;
+#else // ! HAVE_ZSTD
+		return false;
+#endif // ! HAVE_ZSTD
+	}
+	return false;
+}
+
+//
+// returns the name of a compression format, for diagnostics
+//
+
+static const char*
+compression_name(const dimeCompression compression)
+{
+	switch (compression)
+	{
+	case DIME_COMPRESSION_GZIP: return "gzip";
+	case DIME_COMPRESSION_ZSTD: return "zstd";
+	default: return "uncompressed";
+	}
+}
+
+//
+// Reads the first bytes of the file to detect the format.
+//
+
+dimeFileReader::dimeFileReader(FILE* const fp)
+	: fp(fp), compression(DIME_COMPRESSION_NONE), stream(nullptr), atEnd(false),
+	  inputEnd(false), frameEnd(false), fileOffset(0), inputPos(0), inputLen(0)
+{
+	this->input.resize(INPUT_SIZE);
+	this->inputLen = this->readFile(this->input.data(), 4);
+	const auto head = reinterpret_cast<const unsigned char*>(this->input.data());
+	if (this->inputLen >= 2 && head[0] == 0x1f && head[1] == 0x8b)
+		this->compression = DIME_COMPRESSION_GZIP;
+	else if (this->inputLen >= 4 && head[0] == 0x28 && head[1] == 0xb5 &&
+	         head[2] == 0x2f && head[3] == 0xfd)
+		this->compression = DIME_COMPRESSION_ZSTD;
+
+#ifdef HAVE_ZLIB
+	if (this->compression == DIME_COMPRESSION_GZIP)
+	{
+		auto zs = new z_stream;
+		memset(zs, 0, sizeof(z_stream));
+		if (inflateInit2(zs, 15 + 16) == Z_OK) this->stream = zs;
+		else delete zs;
+	}
+#endif // HAVE_ZLIB
+#ifdef HAVE_ZSTD
+	if (this->compression == DIME_COMPRESSION_ZSTD)
+	{
+		this->stream = ZSTD_createDStream();
+	}
+#endif // HAVE_ZSTD
+	if (this->compression != DIME_COMPRESSION_NONE && !this->stream)
+	{
+		dime_diagnostic("Reading %s compressed files is not supported.\n",
+		                compression_name(this->compression));
+	}
+}
+
+dimeFileReader::~dimeFileReader()
+{
+#ifdef HAVE_ZLIB
+	if (this->compression == DIME_COMPRESSION_GZIP && this->stream)
+	{
+		inflateEnd(static_cast<z_stream*>(this->stream));
+		delete static_cast<z_stream*>(this->stream);
+	}
+#endif // HAVE_ZLIB
+#ifdef HAVE_ZSTD
+	if (this->compression == DIME_COMPRESSION_ZSTD && this->stream)
+	{
+		ZSTD_freeDStream(static_cast<ZSTD_DStream*>(this->stream));
+	}
+#endif // HAVE_ZSTD
+}
+
+//
+// Returns the compression format of the file.
+//
+
+dimeCompression
+dimeFileReader::getCompression() const
+{
+	return this->compression;
+}
+
+//
+// Returns false if the file is compressed in a format this build
+// cannot read.
+//
+
+bool
+dimeFileReader::isSupported() const
+{
+	return this->compression == DIME_COMPRESSION_NONE || this->stream != nullptr;
+}
+
+//
+// Returns the number of bytes read from the file, which is less than
+// the number of bytes returned by read() for compressed files. May be
+// called from another thread than read().
+//
+
+long
+dimeFileReader::getFileOffset() const
+{
+	return this->fileOffset;
+}
+
+//
+// Reads up to size uncompressed bytes into buffer. Returns the number
+// of bytes read, or 0 at end of file or on errors.
+//
+
+size_t
+dimeFileReader::read(char* const buffer, const size_t size)
+{
+	if (this->compression == DIME_COMPRESSION_NONE)
+	{
+		// the bytes read to detect the format come first
+		size_t num = 0;
+		if (this->inputPos < this->inputLen)
+		{
+			num = this->inputLen - this->inputPos;
+			if (num > size) num = size;
+			memcpy(buffer, this->input.data() + this->inputPos, num);
+			this->inputPos += num;
+		}
+		return num + this->readFile(buffer + num, size - num);
+	}
+	if (!this->stream || this->atEnd) return 0;
+
+#ifdef HAVE_ZLIB
+	if (this->compression == DIME_COMPRESSION_GZIP)
+	{
+		auto zs = static_cast<z_stream*>(this->stream);
+		zs->next_out = reinterpret_cast<Bytef*>(buffer);
+		zs->avail_out = static_cast<uInt>(size);
+		while (zs->avail_out > 0)
+		{
+			if (this->inputPos == this->inputLen && !this->inputEnd && !this->fillInput())
+				this->inputEnd = true;
+			zs->next_in = reinterpret_cast<Bytef*>(this->input.data() + this->inputPos);
+			zs->avail_in = static_cast<uInt>(this->inputLen - this->inputPos);
+			const int ret = inflate(zs, Z_NO_FLUSH);
+			this->inputPos = this->inputLen - zs->avail_in;
+			if (ret == Z_STREAM_END)
+			{
+				// another gzip member may follow
+				if (this->inputPos == this->inputLen && (this->inputEnd || !this->fillInput()))
+				{
+					this->inputEnd = true;
+					this->atEnd = true;
+					break;
+				}
+				inflateReset(zs);
+			}
+			else if (ret != Z_OK && (ret != Z_BUF_ERROR || this->inputEnd))
+			{
+				dime_diagnostic("Error in gzip compressed data: %s\n",
+				                zs->msg ? zs->msg : "unexpected end of file");
+				this->atEnd = true;
+				break;
+			}
+		}
+		return size - zs->avail_out;
+	}
+#endif // HAVE_ZLIB
+#ifdef HAVE_ZSTD
+	if (this->compression == DIME_COMPRESSION_ZSTD)
+	{
+		auto ds = static_cast<ZSTD_DStream*>(this->stream);
+		ZSTD_outBuffer out = { buffer, size, 0 };
+		while (out.pos < out.size)
+		{
+			if (this->inputPos == this->inputLen && !this->inputEnd && !this->fillInput())
+				this->inputEnd = true;
+			ZSTD_inBuffer in = { this->input.data(), this->inputLen, this->inputPos };
+			const size_t prevpos = out.pos;
+			const size_t ret = ZSTD_decompressStream(ds, &out, &in);
+			this->inputPos = in.pos;
+			if (ZSTD_isError(ret))
+			{
+				dime_diagnostic("Error in zstd compressed data: %s\n", ZSTD_getErrorName(ret));
+				this->atEnd = true;
+				break;
+			}
+			if (this->inputEnd && out.pos == prevpos)
+			{
+				if (!this->frameEnd) dime_diagnostic("Error in zstd compressed data: unexpected end of file\n");
+				this->atEnd = true;
+				break;
+			}
+			this->frameEnd = ret == 0;
+		}
+		return out.pos;
+	}
+#endif // HAVE_ZSTD
+	return 0;
+}
+
+size_t
+dimeFileReader::readFile(char* const buffer, const size_t size)
+{
+	if (size == 0) return 0;
+	const size_t num = fread(buffer, 1, size, this->fp);
+	this->fileOffset += static_cast<long>(num);
+	return num;
+}
+
+//
+// Reads the next block of compressed input. Returns false at end of
+// file.
+//
+
+bool
+dimeFileReader::fillInput()
+{
+	this->inputPos = 0;
+	this->inputLen = this->readFile(this->input.data(), this->input.size());
+	return this->inputLen > 0;
+}
+
+#ifdef HAVE_ZLIB
+
+//
+// Compresses data as a complete gzip member. Returns an empty array
+// on errors.
+//
+
+static std::vector<char>
+gzip_member(const std::vector<char> data, const int level)
+{
+	std::vector<char> member;
+	z_stream zs;
+	memset(&zs, 0, sizeof(zs));
+	if (deflateInit2(&zs, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) return member;
+	member.resize(deflateBound(&zs, static_cast<uLong>(data.size())));
+	zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+	zs.avail_in = static_cast<uInt>(data.size());
+	zs.next_out = reinterpret_cast<Bytef*>(member.data());
+	zs.avail_out = static_cast<uInt>(member.size());
+	if (deflate(&zs, Z_FINISH) == Z_STREAM_END) member.resize(zs.total_out);
+	else member.clear();
+	deflateEnd(&zs);
+	return member;
+}
+
+#endif // HAVE_ZLIB
+
+//
+// Starts compressing to fp. A level below 0 selects the default level
+// of the format.
+//
+
+dimeFileWriter::dimeFileWriter(FILE* const fp, const dimeCompression compression,
+                               const int level, const int numthreads)
+	: fp(fp), compression(compression), level(level),
+	  numThreads(numthreads < 1 ? 1 : numthreads), stream(nullptr), ok(false),
+	  finished(false), numChunks(0)
+{
+	this->output.resize(OUTPUT_SIZE);
+#ifdef HAVE_ZLIB
+	if (compression == DIME_COMPRESSION_GZIP)
+	{
+		if (this->level < 0 || this->level > 9) this->level = Z_DEFAULT_COMPRESSION;
+		if (this->numThreads > 1)
+		{
+			// members are compressed by gzip_member()
+			this->chunk.reserve(CHUNK_SIZE);
+			this->ok = true;
+		}
+		else
+		{
+			auto zs = new z_stream;
+			memset(zs, 0, sizeof(z_stream));
+			if (deflateInit2(zs, this->level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK)
+			{
+				this->stream = zs;
+				this->ok = true;
+			}
+			else delete zs;
+		}
+	}
+#endif // HAVE_ZLIB
+#ifdef HAVE_ZSTD
+	if (compression == DIME_COMPRESSION_ZSTD)
+	{
+		ZSTD_CCtx* cctx = ZSTD_createCCtx();
+		if (cctx)
+		{
+			ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel,
+			                       this->level < 0 ? ZSTD_CLEVEL_DEFAULT : this->level);
+			// fails silently if libzstd is built without threads
+			if (this->numThreads > 1) ZSTD_CCtx_setParameter(cctx, ZSTD_c_nbWorkers, this->numThreads);
+			this->stream = cctx;
+			this->ok = true;
+		}
+	}
+#endif // HAVE_ZSTD
+	if (!this->ok)
+	{
+		dime_diagnostic("Writing %s compressed files is not supported.\n",
+		                compression_name(compression));
+	}
+}
+
+//
+// Frees the compressor. Does not finish the file.
+//
+
+dimeFileWriter::~dimeFileWriter()
+{
+	this->pending.clear(); // waits for the members being compressed
+#ifdef HAVE_ZLIB
+	if (this->compression == DIME_COMPRESSION_GZIP && this->stream)
+	{
+		deflateEnd(static_cast<z_stream*>(this->stream));
+		delete static_cast<z_stream*>(this->stream);
+	}
+#endif // HAVE_ZLIB
+#ifdef HAVE_ZSTD
+	if (this->compression == DIME_COMPRESSION_ZSTD && this->stream)
+	{
+		ZSTD_freeCCtx(static_cast<ZSTD_CCtx*>(this->stream));
+	}
+#endif // HAVE_ZSTD
+}
+
+//
+// Returns false if the compressor could not be created, or if writing
+// failed.
+//
+
+bool
+dimeFileWriter::isValid() const
+{
+	return this->ok;
+}
+
+//
+// Compresses and writes size bytes.
+//
+
+bool
+dimeFileWriter::write(const char* data, size_t size)
+{
+	if (!this->ok || this->finished) return false;
+	if (this->compression == DIME_COMPRESSION_GZIP && this->numThreads > 1)
+	{
+		while (size > 0)
+		{
+			size_t num = CHUNK_SIZE - this->chunk.size();
+			if (num > size) num = size;
+			this->chunk.insert(this->chunk.end(), data, data + num);
+			data += num;
+			size -= num;
+			if (this->chunk.size() == CHUNK_SIZE && !this->writeChunk()) return false;
+		}
+		return true;
+	}
+	return this->compress(data, size, false);
+}
+
+//
+// Writes the end of the compressed stream and flushes the file. Does
+// nothing if the stream is already finished.
+//
+
+bool
+dimeFileWriter::finish()
+{
+	if (this->finished) return true;
+	if (!this->ok) return false;
+	if (this->compression == DIME_COMPRESSION_GZIP && this->numThreads > 1)
+	{
+		// an empty file still needs one gzip member
+		if ((!this->chunk.empty() || this->numChunks == 0) && !this->writeChunk()) return false;
+		if (!this->writePending(0)) return false;
+	}
+	else if (!this->compress(nullptr, 0, true)) return false;
+	this->finished = true; // nothing more can be written
+	return fflush(this->fp) == 0;
+}
+
+//
+// Compresses with the stream of the format. If end is set, the stream
+// is finished.
+//
+
+bool
+dimeFileWriter::compress(const char* const data, const size_t size, const bool end)
+{
+#ifdef HAVE_ZLIB
+	if (this->compression == DIME_COMPRESSION_GZIP)
+	{
+		auto zs = static_cast<z_stream*>(this->stream);
+		zs->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+		zs->avail_in = static_cast<uInt>(size);
+		int ret;
+		do
+		{
+			zs->next_out = reinterpret_cast<Bytef*>(this->output.data());
+			zs->avail_out = static_cast<uInt>(this->output.size());
+			ret = deflate(zs, end ? Z_FINISH : Z_NO_FLUSH);
+			const size_t num = this->output.size() - zs->avail_out;
+			if (ret == Z_STREAM_ERROR || fwrite(this->output.data(), 1, num, this->fp) != num)
+				return this->ok = false;
+		} while (end ? ret != Z_STREAM_END : zs->avail_out == 0);
+		return true;
+	}
+#endif // HAVE_ZLIB
+#ifdef HAVE_ZSTD
+	if (this->compression == DIME_COMPRESSION_ZSTD)
+	{
+		auto cctx = static_cast<ZSTD_CCtx*>(this->stream);
+		ZSTD_inBuffer in = { data, size, 0 };
+		size_t remaining;
+		do
+		{
+			ZSTD_outBuffer out = { this->output.data(), this->output.size(), 0 };
+			remaining = ZSTD_compressStream2(cctx, &out, &in, end ? ZSTD_e_end : ZSTD_e_continue);
+			if (ZSTD_isError(remaining) || fwrite(this->output.data(), 1, out.pos, this->fp) != out.pos)
+				return this->ok = false;
+		} while (end ? remaining != 0 : in.pos < in.size);
+		return true;
+	}
+#endif // HAVE_ZSTD
+	(void)data;
+	(void)size;
+	(void)end;
+	return this->ok = false;
+}
+
+//
+// Starts compressing the collected input as a gzip member in a new
+// thread, after writing finished members so that at most numThreads
+// members are compressed at the same time.
+//
+
+bool
+dimeFileWriter::writeChunk()
+{
+#ifdef HAVE_ZLIB
+	if (!this->writePending(this->numThreads - 1)) return false;
+	this->pending.push_back(std::async(std::launch::async, gzip_member,
+	                                   std::move(this->chunk), this->level));
+	this->chunk = std::vector<char>();
+	this->chunk.reserve(CHUNK_SIZE);
+	this->numChunks++;
+	return true;
+#else // ! HAVE_ZLIB
+	return this->ok = false;
+#endif // ! HAVE_ZLIB
+}
+
+//
+// Writes finished gzip members, in order, until no more than
+// maxpending members are left.
+//
+
+bool
+dimeFileWriter::writePending(const size_t maxpending)
+{
+	while (this->pending.size() > maxpending)
+	{
+		const std::vector<char> member = this->pending.front().get();
+		this->pending.erase(this->pending.begin());
+		if (member.empty() || fwrite(member.data(), 1, member.size(), this->fp) != member.size())
+			return this->ok = false;
+	}
+	return true;
+}
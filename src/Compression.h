@@ -0,0 +1,120 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#ifndef DIME_COMPRESSION_H
+#define DIME_COMPRESSION_H
+
+#include <dime/Basic.h>
+#include <atomic>
+#include <future>
+#include <vector>
+
+//
+// Reads a file that may be compressed with gzip or zstd. The format is
+// detected from the first bytes of the file. Uncompressed files are
+// read directly into the caller's buffer.
+//
+
+class dimeFileReader
+{
+public:
+	dimeFileReader(FILE* fp);
+	~dimeFileReader();
+
+	dimeCompression getCompression() const;
+	bool isSupported() const;
+	size_t read(char* buffer, size_t size);
+	long getFileOffset() const;
+
+private:
+	dimeFileReader(const dimeFileReader&) = delete;
+	dimeFileReader& operator=(const dimeFileReader&) = delete;
+
+	size_t readFile(char* buffer, size_t size);
+	bool fillInput();
+
+	FILE* fp;
+	dimeCompression compression;
+	void* stream;
+	bool atEnd;
+	bool inputEnd;
+	bool frameEnd; // a zstd frame has just been completed
+	std::atomic<long> fileOffset;
+
+	// compressed input, or the first bytes of an uncompressed file
+	std::vector<char> input;
+	size_t inputPos;
+	size_t inputLen;
+};
+
+//
+// Writes a file compressed with gzip or zstd. With more than one
+// thread, gzip files are compressed as a series of independent gzip
+// members in parallel, and zstd uses its own worker threads.
+//
+
+class dimeFileWriter
+{
+public:
+	dimeFileWriter(FILE* fp, dimeCompression compression, int level, int numthreads);
+	~dimeFileWriter();
+
+	bool isValid() const;
+	bool write(const char* data, size_t size);
+	bool finish();
+
+private:
+	dimeFileWriter(const dimeFileWriter&) = delete;
+	dimeFileWriter& operator=(const dimeFileWriter&) = delete;
+
+	bool compress(const char* data, size_t size, bool end);
+	bool writeChunk();
+	bool writePending(size_t maxpending);
+
+	FILE* fp;
+	dimeCompression compression;
+	int level;
+	int numThreads;
+	void* stream;
+	bool ok;
+	bool finished;
+	size_t numChunks;
+
+	std::vector<char> output;
+
+	// parallel gzip: input collected for the next member, and the
+	// members being compressed, in file order
+	std::vector<char> chunk;
+	std::vector<std::future<std::vector<char>>> pending;
+};
+
+#endif // ! DIME_COMPRESSION_H
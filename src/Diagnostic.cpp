@@ -0,0 +1,80 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <dime/Model.h>
+#include "Diagnostic.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+// the model whose handler receives diagnostics on this thread
+static thread_local const DimeModel* diagnosticModel = nullptr;
+
+dimeDiagnosticScope::dimeDiagnosticScope(const DimeModel* const model)
+	: prevModel(diagnosticModel)
+{
+	diagnosticModel = model;
+}
+
+dimeDiagnosticScope::~dimeDiagnosticScope()
+{
+	diagnosticModel = this->prevModel;
+}
+
+const DimeModel*
+dimeDiagnosticScope::getModel()
+{
+	return diagnosticModel;
+}
+
+//
+// Formats a diagnostic message and sends it to the current model's
+// handler. A trailing newline is removed, since the handler receives
+// one message at a time.
+//
+
+void
+dime_diagnostic(const char* const format, ...)
+{
+	char buf[1024];
+	va_list args;
+	va_start(args, format);
+	vsnprintf(buf, sizeof(buf), format, args);
+	va_end(args);
+	size_t len = strlen(buf);
+	while (len > 0 && buf[len - 1] == '\n') buf[--len] = 0;
+
+	const DimeModel* model = diagnosticModel;
+	if (model && model->getDiagnosticHandler())
+		model->getDiagnosticHandler()(buf, model->getDiagnosticData());
+	else fprintf(stderr, "%s\n", buf);
+}
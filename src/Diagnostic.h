@@ -0,0 +1,65 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#ifndef DIME_DIAGNOSTIC_H
+#define DIME_DIAGNOSTIC_H
+
+class DimeModel;
+
+//
+// Diagnostics are sent to the handler of the model set with
+// dimeDiagnosticScope on the calling thread, or to stderr if no model
+// is set or the model has no handler.
+//
+
+class dimeDiagnosticScope
+{
+public:
+	dimeDiagnosticScope(const DimeModel* model);
+	~dimeDiagnosticScope();
+
+	static const DimeModel* getModel();
+
+private:
+	dimeDiagnosticScope(const dimeDiagnosticScope&) = delete;
+	dimeDiagnosticScope& operator=(const dimeDiagnosticScope&) = delete;
+
+	const DimeModel* prevModel;
+};
+
+#if defined(__GNUC__)
+void dime_diagnostic(const char* format, ...) __attribute__((format(printf, 1, 2)));
+#else
+void dime_diagnostic(const char* format, ...);
+#endif
+
+#endif // ! DIME_DIAGNOSTIC_H
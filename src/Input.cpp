@@ -51,12 +51,14 @@
 #include "unix.h"
 #endif
 
-#ifdef USE_GZFILE
-#include <zlib.h>
-#endif
-
 #include <dime/Input.h>
 #include <dime/Model.h>
+#include <dime/Async.h>
+#include "Compression.h"
+#include "Diagnostic.h"
+#include "ReadAhead.h"
+#include "SourceData.h"
+#include "Snapshot.h"
 
 #define READBUFSIZE 65536
 
@@ -67,15 +69,16 @@
 */
 
 DimeInput::DimeInput()
-	: model(nullptr), version(12), fd(-1), readbuf(nullptr),
-	  callback(nullptr), callbackdata(nullptr)
+	: model(nullptr), version(12), fd(-1), readbuf(nullptr), readbufAlloc(nullptr),
+	  callback(nullptr), callbackdata(nullptr), source(nullptr),
+	  readbufStart(0), groupCodeStart(0), snapshotPtr(nullptr),
+	  snapshotEnd(nullptr), snapshotStrings(nullptr), numSnapshotStrings(0),
+	  stats(nullptr), asyncControl(nullptr), readAhead(nullptr),
+	  readAheadBuffers(0), readAheadSize(0)
 {
-#ifdef USE_GZFILE
-  this->gzfp = NULL;
-#else
 	this->fp = nullptr;
+	this->reader = nullptr;
 	this->didOpenFile = false;
-#endif
 	this->prevwashandle = false;
 }
 
@@ -85,12 +88,10 @@ DimeInput::DimeInput()
 
 DimeInput::~DimeInput()
 {
-	delete [] this->readbuf;
-#ifdef USE_GZFILE
-  if (this->gzfp) gzclose(this->gzfp);
-#else
+	delete this->readAhead;
+	delete this->reader;
+	delete [] this->readbufAlloc;
 	if (this->fp && this->didOpenFile) fclose(this->fp);
-#endif
 }
 
 bool
@@ -104,22 +105,21 @@ DimeInput::init()
 	this->binary16bit = false;
 
 	this->fd = -1;
-#ifdef USE_GZFILE
-  if (this->gzfp) gzclose(this->gzfp);
-  this->gzfp = NULL;
-  this->gzeof = true;
-#else
+	delete this->readAhead; // stop reading before closing the file
+	this->readAhead = nullptr;
+	delete this->reader;
+	this->reader = nullptr;
 	if (this->fp && this->didOpenFile) fclose(this->fp);
 	this->fp = nullptr;
 	this->didOpenFile = false;
 	this->fpeof = true;
-#endif
 	this->filesize = 0;
-	if (this->readbuf == nullptr)
+	if (this->readbufAlloc == nullptr)
 	{
-		this->readbuf = new char[READBUFSIZE]; // create buffer
-		if (!this->readbuf) return false;
+		this->readbufAlloc = new char[READBUFSIZE]; // create buffer
+		if (!this->readbufAlloc) return false;
 	}
+	this->readbuf = this->readbufAlloc;
 	this->readbufIndex = 0;
 	this->readbufLen = 0;
 	this->backBufIndex = -1;
@@ -128,6 +128,13 @@ DimeInput::init()
 	this->cbcnt = 0;
 	this->prevwashandle = false;
 	this->endianSwap = false;
+	this->source = nullptr;
+	this->readbufStart = 0;
+	this->groupCodeStart = 0;
+	this->snapshotPtr = nullptr;
+	this->snapshotEnd = nullptr;
+	this->snapshotStrings = nullptr;
+	this->numSnapshotStrings = 0;
 	return true;
 }
 
@@ -141,6 +148,64 @@ DimeInput::isAborted() const
 	return this->aborted;
 }
 
+/*!
+  Sets the statistics object that collects counters while reading.
+  Set to \e nullptr (the default) to disable collection.
+
+  \sa DimeStats
+*/
+
+void
+DimeInput::setStats(DimeStats* const stats)
+{
+	this->stats = stats;
+}
+
+/*!
+  \fn DimeStats* DimeInput::getStats() const
+  Returns the statistics object, or \e nullptr if none is set.
+*/
+
+/*!
+  Sets the object that receives the progress of the read, and that
+  can cancel it from another thread. Set to \e nullptr (the default)
+  to disable.
+
+  \sa DimeModel::readAsync()
+*/
+
+void
+DimeInput::setAsyncControl(DimeAsyncControl* const control)
+{
+	this->asyncControl = control;
+}
+
+/*!
+  \fn DimeAsyncControl* DimeInput::getAsyncControl() const
+  Returns the async control object, or \e nullptr if none is set.
+*/
+
+/*!
+  Called by the sections and blocks before each entity is read.
+  Publishes the progress to the async control object, and returns
+  \e true, marking the input as aborted, if the read has been
+  cancelled or was aborted from the progress callback.
+*/
+
+bool
+DimeInput::checkAborted()
+{
+	DimeAsyncControl* const control = this->asyncControl;
+	if (control && !this->aborted)
+	{
+		float pos = this->didOpenFile ? this->relativePosition() : 0.0f;
+		if (pos > 1.0f) pos = 1.0f;
+		control->setProgress(pos, this->getByteOffset());
+		if (control->isCancelled()) this->aborted = true;
+	}
+	return this->aborted;
+}
+
 /*!
   This method sets a progress callback that will be called with a
   float in the range between 0 and 1, and void * \a cbdata as arguments.
@@ -157,7 +222,8 @@ DimeInput::setCallback(int (*cb)(float, void*), void* cbdata)
 
 /*!
   Returns the relative file position. 0.0 means beginning of file,
-  1.0 is at end of file.
+  1.0 is at end of file. For compressed files, this is the position
+  in the compressed file.
 */
 
 float
@@ -165,8 +231,13 @@ DimeInput::relativePosition()
 {
 	assert(this->didOpenFile);
 	if (!this->filesize) return 0.0f;
-	return (static_cast<float>(lseek(this->fd, 0, SEEK_CUR) - (readbufLen - readbufIndex)) /
-		static_cast<float>(this->filesize));
+	if (this->getCompression() != DIME_COMPRESSION_NONE)
+	{
+		return static_cast<float>(this->reader->getFileOffset()) /
+			static_cast<float>(this->filesize);
+	}
+	return static_cast<float>(this->readbufStart + static_cast<long>(this->readbufIndex)) /
+		static_cast<float>(this->filesize);
 }
 
 /*!
@@ -202,6 +273,8 @@ DimeInput::setFileHandle(FILE* fp)
 	this->fpeof = false;
 	this->didOpenFile = false;
 	this->filesize = 1;
+	if (!this->openReader()) return false;
+	this->startReadAhead();
 
 	this->binary = this->checkBinary();
 
@@ -219,23 +292,79 @@ DimeInput::setFilePointer(const int newfd)
 {
 	if (!this->init()) return false;
 	this->fd = newfd;
-#if USE_GZFILE
-  this->gzfp = gzdopen(this->fd, "rb");
-  this->gzeof = false; 
-#else
 	this->fp = fdopen(this->fd, "rb");
 	this->didOpenFile = true;
 	this->fpeof = false;
-#endif
 	long startpos = lseek(fd, 0, SEEK_CUR);
 	this->filesize = lseek(fd, 0, SEEK_END);
 	lseek(fd, startpos, SEEK_SET);
+	if (!this->openReader()) return false;
+	this->startReadAhead();
 
 	this->binary = this->checkBinary();
 
 	return this->filesize > 0;
 }
 
+/*!
+  Makes a background thread read the file ahead of the parser, into
+  a ring of \a numbuffers buffers of \a buffersize bytes each. This
+  overlaps disk, network or decompression latency with parsing. Must
+  be called before the file is set. Set \a numbuffers to 0 (the
+  default) to read from the calling thread.
+*/
+
+void
+DimeInput::setReadAhead(const int numbuffers, const size_t buffersize)
+{
+	this->readAheadBuffers = numbuffers < 2 ? 0 : numbuffers;
+	this->readAheadSize = buffersize < 4096 ? 4096 : buffersize;
+}
+
+//
+// Creates the reader for the file just set, which detects whether the
+// file is compressed. Returns false if the compression format is not
+// supported.
+//
+
+bool
+DimeInput::openReader()
+{
+	if (!this->fp) return false;
+	this->reader = new dimeFileReader(this->fp);
+	return this->reader->isSupported();
+}
+
+/*!
+  Returns the compression format of the file, which is detected when
+  the file is set. gzip and zstd compressed files are decompressed
+  while reading, if supported by this build of DIME (see
+  dime_compression_supported()).
+*/
+
+dimeCompression
+DimeInput::getCompression() const
+{
+	return this->reader ? this->reader->getCompression() : DIME_COMPRESSION_NONE;
+}
+
+//
+// Starts the read-ahead thread for the file just set, if enabled.
+//
+
+void
+DimeInput::startReadAhead()
+{
+	if (!this->readAheadBuffers) return;
+	if (!this->reader) return;
+	dimeFileReader* const reader = this->reader;
+	this->readAhead = new dimeReadAhead(this->readAheadBuffers, this->readAheadSize,
+		[reader](char* buffer, size_t size) -> size_t
+		{
+			return reader->read(buffer, size);
+		});
+}
+
 /*!
   Returns true if end of file is encountered.
 */
@@ -243,11 +372,8 @@ DimeInput::setFilePointer(const int newfd)
 bool
 DimeInput::eof() const
 {
-#if USE_GZFILE
-  return this->gzeof;
-#else
+	if (this->snapshotPtr) return this->snapshotPtr >= this->snapshotEnd;
 	return this->fpeof;
-#endif
 }
 
 /*!
@@ -269,6 +395,7 @@ DimeInput::readGroupCode(int32_t& code)
 	}
 	else
 	{
+		this->groupCodeStart = this->getByteOffset();
 		if (this->didOpenFile && this->callback && this->cbcnt++ > 100)
 		{
 			this->cbcnt = 0;
@@ -284,7 +411,19 @@ DimeInput::readGroupCode(int32_t& code)
 			}
 		}
 
-		if (this->binary)
+		if (this->snapshotPtr)
+		{
+			int16_t val16;
+			ret = this->readSnapshot(&val16, sizeof(val16));
+			code = val16;
+			while (ret && code == 999)
+			{
+				readString();
+				ret = this->readSnapshot(&val16, sizeof(val16));
+				code = val16;
+			}
+		}
+		else if (this->binary)
 		{
 			if (this->binary16bit)
 			{
@@ -347,6 +486,15 @@ DimeInput::putBackGroupCode(const int32_t code)
 bool
 DimeInput::readInt8(int8_t& val)
 {
+	if (this->snapshotPtr)
+	{
+		dxfdouble d;
+		long l;
+		const char* str;
+		if (!this->readSnapshotValue(d, l, str)) return false;
+		val = static_cast<int8_t>(l);
+		return true;
+	}
 	if (this->binary)
 	{
 		auto ptr = (char*)&val;
@@ -370,6 +518,15 @@ DimeInput::readInt8(int8_t& val)
 bool
 DimeInput::readInt16(int16_t& val)
 {
+	if (this->snapshotPtr)
+	{
+		dxfdouble d;
+		long l;
+		const char* str;
+		if (!this->readSnapshotValue(d, l, str)) return false;
+		val = static_cast<int16_t>(l);
+		return true;
+	}
 	if (this->binary)
 	{
 		bool ret;
@@ -404,6 +561,15 @@ DimeInput::readInt16(int16_t& val)
 bool
 DimeInput::readInt32(int32_t& val)
 {
+	if (this->snapshotPtr)
+	{
+		dxfdouble d;
+		long l;
+		const char* str;
+		if (!this->readSnapshotValue(d, l, str)) return false;
+		val = static_cast<int32_t>(l);
+		return true;
+	}
 	if (this->binary)
 	{
 		bool ret;
@@ -443,7 +609,15 @@ DimeInput::readFloat(float& val)
 {
 	bool ret = false;
 
-	if (this->binary)
+	if (this->snapshotPtr)
+	{
+		dxfdouble d;
+		long l;
+		const char* str;
+		ret = this->readSnapshotValue(d, l, str);
+		val = static_cast<float>(d);
+	}
+	else if (this->binary)
 	{
 		// binary files only contains doubles
 		dxfdouble tmp;
@@ -487,7 +661,13 @@ bool
 DimeInput::readDouble(dxfdouble& val)
 {
 	bool ret = false;
-	if (this->binary)
+	if (this->snapshotPtr)
+	{
+		long l;
+		const char* str;
+		ret = this->readSnapshotValue(val, l, str);
+	}
+	else if (this->binary)
 	{
 		double tmp;
 		assert(sizeof(tmp) == 8);
@@ -556,6 +736,7 @@ DimeInput::readDouble(dxfdouble& val)
 const char*
 DimeInput::readString()
 {
+	if (this->snapshotPtr) return this->readSnapshotString();
 	bool ok = skipWhiteSpace();
 	if (ok)
 	{
@@ -597,6 +778,7 @@ DimeInput::readString()
 const char*
 DimeInput::readStringNoSkip()
 {
+	if (this->snapshotPtr) return this->readSnapshotString();
 	char c;
 	int idx = 0;
 #if 0
@@ -647,6 +829,47 @@ DimeInput::getFilePosition() const
 	return filePosition;
 }
 
+/*!
+  Returns the number of bytes read from the file so far, not counting
+  characters put back into the stream.
+*/
+
+long
+DimeInput::getByteOffset() const
+{
+	return this->readbufStart + static_cast<long>(this->readbufIndex) -
+		(this->backBufIndex + 1);
+}
+
+/*!
+  Returns the byte offset of the last group code read from the file.
+  A group code put back with putBackGroupCode() is not counted as a
+  new group code, so after an entity has been read this is the
+  offset where the next entity starts.
+*/
+
+long
+DimeInput::getGroupCodeOffset() const
+{
+	return this->groupCodeStart;
+}
+
+/*!
+  Stores the byte range [\a start, \a end) for \a object if the model
+  being read keeps its source bytes (see DimeModel::setPassthrough()).
+  Returns the index of the range, or -1 if source bytes are not kept.
+  This is used by the entity and section readers.
+*/
+
+int
+DimeInput::addSourceRange(const void* const object, const long start, const long end)
+{
+	if (!this->source) return -1;
+	const dimeSourceRange range = {object, start, end};
+	this->source->ranges.push_back(range);
+	return static_cast<int>(this->source->ranges.size()) - 1;
+}
+
 /*!
   Returns true if this is a binary (DXB) file.
 */
@@ -669,6 +892,30 @@ DimeInput::getVersion() const
 
 // private funcs ***********************************************************
 
+//
+// Starts keeping all bytes read in \a data. Only possible before more
+// than one buffer has been read, and for ASCII files. \a data may be
+// NULL to stop keeping bytes. When the size of an uncompressed file is
+// known, the whole file is reserved up front to avoid regrowing.
+//
+bool
+DimeInput::setSource(dimeSourceData* const data)
+{
+	if (data && (this->binary || this->snapshotPtr || this->readbufStart != 0)) return false;
+	this->source = data;
+	if (data)
+	{
+		if (this->didOpenFile && this->getCompression() == DIME_COMPRESSION_NONE &&
+			this->filesize > 0)
+		{
+			data->bytes.reserve(static_cast<size_t>(this->filesize));
+		}
+		data->bytes.assign(this->readbuf, this->readbuf + this->readbufLen);
+		data->ranges.clear();
+	}
+	return true;
+}
+
 //  
 //  Reads a relatively big block from the file into local memory.  
 //  stdio caching is not fast enough...
@@ -676,23 +923,10 @@ DimeInput::getVersion() const
 bool
 DimeInput::doBufferRead()
 {
-#if USE_GZFILE
-  if (!this->gzfp) return false;
-  int len = gzread(this->gzfp, this->readbuf, READBUFSIZE);
-  if (len <= 0) {
-    this->gzeof = true;
-    this->readbufIndex = 0;
-    this->readbufLen = 0;
-    return false;
-  }
-  else {
-    this->readbufIndex = 0;
-    this->readbufLen = len;
-    return true;
-  }
-#else // ! USE_GZFILE
-	if (!this->fp) return false;
-	size_t len = fread(this->readbuf, 1, READBUFSIZE, this->fp);
+	if (!this->reader) return false;
+	this->readbufStart += static_cast<long>(this->readbufLen);
+	size_t len = this->readAhead ? this->readAhead->next(this->readbuf) :
+		this->reader->read(this->readbuf, READBUFSIZE);
 	if (len <= 0)
 	{
 		this->fpeof = true;
@@ -702,8 +936,144 @@ DimeInput::doBufferRead()
 	}
 	this->readbufIndex = 0;
 	this->readbufLen = len;
+	if (this->source)
+	{
+		this->source->bytes.insert(this->source->bytes.end(), this->readbuf, this->readbuf + len);
+	}
+	return true;
+}
+
+//
+// Reads from the record stream of a snapshot instead of a DXF file.
+// The string table is referenced, not copied.
+//
+bool
+DimeInput::setSnapshot(const char* const data, const size_t size,
+                       const char* const* const strings, const int numstrings)
+{
+	if (!this->init()) return false;
+	this->snapshotPtr = data;
+	this->snapshotEnd = data + size;
+	this->snapshotStrings = strings;
+	this->numSnapshotStrings = numstrings;
 	return true;
-#endif // ! USE_GZFILE
+}
+
+//
+// copies size raw bytes from the snapshot stream
+//
+bool
+DimeInput::readSnapshot(void* const data, const size_t size)
+{
+	if (static_cast<size_t>(this->snapshotEnd - this->snapshotPtr) < size) return false;
+	memcpy(data, this->snapshotPtr, size);
+	this->snapshotPtr += size;
+	this->filePosition++;
+	return true;
+}
+
+//
+// reads a tagged snapshot value, and converts it to both a floating
+// point and an integer value. Strings are also converted.
+//
+bool
+DimeInput::readSnapshotValue(dxfdouble& d, long& l, const char*& str)
+{
+	unsigned char type;
+	if (!this->readSnapshot(&type, 1)) return false;
+	str = nullptr;
+	bool ok;
+	switch (type)
+	{
+	case DIME_SNAPSHOT_INT8:
+	{
+		int8_t val;
+		ok = this->readSnapshot(&val, sizeof(val));
+		l = val;
+		d = val;
+		break;
+	}
+	case DIME_SNAPSHOT_INT16:
+	{
+		int16_t val;
+		ok = this->readSnapshot(&val, sizeof(val));
+		l = val;
+		d = val;
+		break;
+	}
+	case DIME_SNAPSHOT_INT32:
+	{
+		int32_t val;
+		ok = this->readSnapshot(&val, sizeof(val));
+		l = val;
+		d = val;
+		break;
+	}
+	case DIME_SNAPSHOT_FLOAT:
+	{
+		float val;
+		ok = this->readSnapshot(&val, sizeof(val));
+		d = val;
+		l = static_cast<long>(val);
+		break;
+	}
+	case DIME_SNAPSHOT_DOUBLE:
+	{
+		double val;
+		ok = this->readSnapshot(&val, sizeof(val));
+		d = val;
+		l = static_cast<long>(val);
+		break;
+	}
+	case DIME_SNAPSHOT_STRING:
+	{
+		uint32_t idx;
+		ok = this->readSnapshot(&idx, sizeof(idx)) &&
+			idx < static_cast<uint32_t>(this->numSnapshotStrings);
+		if (ok)
+		{
+			str = this->snapshotStrings[idx];
+			d = atof(str);
+			l = strtol(str, nullptr, 10);
+		}
+		break;
+	}
+	default:
+		ok = false;
+		break;
+	}
+	return ok;
+}
+
+//
+// reads a snapshot value as a string. Numbers are formatted into
+// lineBuf.
+//
+const char*
+DimeInput::readSnapshotString()
+{
+	dxfdouble d;
+	long l;
+	const char* str;
+	const unsigned char type = this->snapshotPtr < this->snapshotEnd ?
+		static_cast<unsigned char>(*this->snapshotPtr) : 0;
+	if (!this->readSnapshotValue(d, l, str)) return nullptr;
+	if (!str)
+	{
+		if (type == DIME_SNAPSHOT_FLOAT || type == DIME_SNAPSHOT_DOUBLE)
+			sprintf(this->lineBuf, "%.15g", d);
+		else sprintf(this->lineBuf, "%ld", l);
+		str = this->lineBuf;
+	}
+	if (this->prevwashandle)
+	{
+		this->prevwashandle = false;
+		if (this->model)
+		{
+			this->model->registerHandle(str);
+		}
+	}
+	return str;
 }
 
 //
@@ -769,11 +1139,7 @@ DimeInput::get(char& c)
 	c = readbuf[readbufIndex++];
 #if 0
   if (c == 0) {
-#if USE_GZFILE
-    this->gzeof = true;
-#else // ! USE_GZFILE
     this->fpeof = true;
-#endif
     return false;
   }
 #endif
@@ -1050,7 +1416,7 @@ DimeInput::checkBinary()
 		}
 	}
 
-	static char binaryid[] = "AutoCAD Binary DXF";
+	static const char binaryid[] = "AutoCAD Binary DXF";
 	char buf[64];
 	int i;
 	size_t n = strlen(binaryid);
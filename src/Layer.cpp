@@ -49,7 +49,7 @@
 #include <stdlib.h>
 
 // palette for color indices 1-255
-static dxfdouble colortable[] = {
+static const dxfdouble colortable[] = {
 	1, 0, 0, // 1
 	1, 1, 0,
 	0, 1, 0,
@@ -308,22 +308,15 @@ static dxfdouble colortable[] = {
 };
 
 
-dimeLayer* dimeLayer::defaultLayer;
-
-// 0 seems to be the default layer name in AutoCAD
-static char defaultName[] = "0";
+// 0 seems to be the default layer name in AutoCAD. The default layer
+// is constant initialized, so it can be used from any thread.
+const dimeLayer dimeLayer::defaultLayer("0", 0, 7, 0); // white...
 
 dimeLayer::dimeLayer()
 	: layerName(nullptr), layerNum(-1), colorNum(-1), flags(0)
 {
 }
 
-dimeLayer::dimeLayer(const char* const name, const int num,
-                     const int16_t colnum, const int16_t flagmask)
-	: layerName(name), layerNum(num), colorNum(colnum), flags(flagmask)
-{
-}
-
 /*!
   \fn static void colorToRGB(const int colornum, 
                              float &r, float &g, float &b)
@@ -390,27 +383,11 @@ dimeLayer::colorToRGB(const int colornum,
   Returns true if this is the default layer.
 */
 
-
-void
-dimeLayer::cleanup_default_layer(void)
-{
-	delete defaultLayer;
-	defaultLayer = nullptr;
-}
-
 /*!
   Returns a pointer to the default layer.
 */
 const dimeLayer*
 dimeLayer::getDefaultLayer()
 {
-	if (defaultLayer == nullptr)
-	{
-		defaultLayer = new dimeLayer;
-		defaultLayer->layerName = defaultName;
-		defaultLayer->layerNum = 0;
-		defaultLayer->colorNum = 7; // white...
-		atexit(cleanup_default_layer);
-	}
-	return defaultLayer;
+	return &defaultLayer;
 }
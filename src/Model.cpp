@@ -52,6 +52,13 @@
   handler is used. See the documentation in dimeEntity for more information
   about how to create your own entities and how to support the memory
   handler.
+
+  Separate models can be read, written and converted concurrently, one
+  model per thread. The library keeps no mutable global state: the
+  default layer and the record type table are constant, and diagnostics
+  are routed to the handler of the model being processed on the calling
+  thread (see setDiagnosticHandler()). A single model must not be
+  accessed from several threads at once without external locking.
 */
 
 #include <dime/Model.h>
@@ -63,7 +70,7 @@
 const char*
 DimeModel::getVersionString()
 {
-	static char versionstring[] = "DIME v0.9";
+	static const char versionstring[] = "DIME v0.9";
 	return versionstring;
 }
 
@@ -85,9 +92,18 @@ DimeModel::getVersion(int& major, int& minor)
 #include <dime/sections/HeaderSection.h>
 #include <dime/entities/Block.h>
 #include <dime/records/Record.h>
+#include "SourceData.h"
+#include "Snapshot.h"
+#include "StatsData.h"
+#include "Diagnostic.h"
 
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <chrono>
+#include <memory>
+#include <vector>
 
 #define SECTIONID "SECTION"
 #define EOFID     "EOF"
@@ -98,7 +114,12 @@ DimeModel::getVersion(int& major, int& minor)
 DimeModel::DimeModel()
 	: refDict(nullptr),
 	  layerDict(nullptr),
-	  largestHandle(0)
+	  largestHandle(0),
+	  passthrough(false),
+	  source(nullptr),
+	  stats(nullptr),
+	  diagnosticHandler(nullptr),
+	  diagnosticData(nullptr)
 {
 	this->init();
 }
@@ -117,6 +138,7 @@ DimeModel::~DimeModel()
 		delete this->layers[i];
 	for (i = 0; i < this->sections.count(); i++)
 		delete this->sections[i];
+	delete this->source;
 }
 
 /*!
@@ -126,6 +148,8 @@ DimeModel::~DimeModel()
 DimeModel*
 DimeModel::copy() const
 {
+	dimeDiagnosticScope scope(this);
+
 	auto newmodel = new DimeModel();
 
 	if (!newmodel || !newmodel->init()) return nullptr;
@@ -169,6 +193,11 @@ DimeModel::init()
 
 	this->refDict = new dimeDict;
 	this->layerDict = new dimeDict(101); // relatively small
+	this->refDict->setStats(this->stats);
+	this->layerDict->setStats(this->stats);
+
+	delete this->source;
+	this->source = nullptr;
 
 	return true;
 }
@@ -180,10 +209,29 @@ DimeModel::init()
 bool
 DimeModel::read(DimeInput* const in)
 {
+	dimeDiagnosticScope scope(this);
+
 	in->model = this; // _very_ important
 
 	this->init();
 
+	// collect into the model's statistics unless the input has its own
+	const bool setstats = in->getStats() == nullptr && this->stats != nullptr;
+	if (setstats) in->setStats(this->stats);
+	dimeStatsData* statsdata = dimeStatsData::get(in->getStats());
+	this->refDict->setStats(in->getStats());
+	this->layerDict->setStats(in->getStats());
+
+	if (this->passthrough)
+	{
+		this->source = new dimeSourceData;
+		if (!in->setSource(this->source))
+		{
+			delete this->source;
+			this->source = nullptr;
+		}
+	}
+
 	int32_t groupcode;
 	const char* string;
 	bool ok = true;
@@ -193,6 +241,7 @@ DimeModel::read(DimeInput* const in)
 	{
 		ok = false;
 		if (!in->readGroupCode(groupcode)) break;
+		const long start = in->getGroupCodeOffset();
 		if (groupcode != 0 && groupcode != 999) break;
 		string = in->readString();
 		if (string == nullptr) break;
@@ -212,9 +261,25 @@ DimeModel::read(DimeInput* const in)
 			string = in->readString();
 			ok = ok && string != nullptr && groupcode == 2;
 			if (!ok) break;
+			const DimeStats::Section statsection = DimeStats::getSection(string);
+			const auto starttime = std::chrono::steady_clock::now();
 			section = DimeSection::createSection(string);
+			// $HANDSEED is read as a handle, but is not used by any object
+			const int handle = this->largestHandle;
 			ok = section != nullptr && section->read(in);
+			if (ok && section->typeId() == DimeBase::dimeHeaderSectionType)
+				this->largestHandle = handle;
+			if (statsdata)
+			{
+				const auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+					std::chrono::steady_clock::now() - starttime).count();
+				dimeStatsData::add(statsdata->sectionNanos[statsection], nanos);
+				dimeStatsData::add(statsdata->sectionBytes[statsection],
+				                   in->getByteOffset() - start);
+			}
 			if (!ok) break;
+			section->sourceIndex = in->addSourceRange(section, start, in->getByteOffset());
+			section->dirty = false;
 			this->sections.append(section);
 		}
 		else if (!strcmp(string, EOFID))
@@ -229,13 +294,13 @@ DimeModel::read(DimeInput* const in)
 		if (in->aborted)
 		{
 #ifndef NDEBUG
-			fprintf(stderr, "DXF read aborted by user.\n");
+			dime_diagnostic("DXF read aborted by user.\n");
 #endif
 		}
 		else
 		{
 #ifndef NDEBUG
-			fprintf(stderr, "DXF loading failed at line: %d\n", in->getFilePosition());
+			dime_diagnostic("DXF loading failed at line: %d\n", in->getFilePosition());
 #endif
 		}
 	}
@@ -249,6 +314,23 @@ DimeModel::read(DimeInput* const in)
 		//    fprintf(stderr,"dimeModel::largestHandle: %d\n", this->largestHandle);
 		//#endif
 	}
+	if (setstats) in->setStats(nullptr);
+	this->refDict->setStats(this->stats);
+	this->layerDict->setStats(this->stats);
+	if (this->source)
+	{
+		in->setSource(nullptr);
+		if (!ok)
+		{
+			delete this->source;
+			this->source = nullptr;
+		}
+		else
+		{
+			this->source->bytes.shrink_to_fit();
+			this->source->ranges.shrink_to_fit();
+		}
+	}
 	return ok;
 }
 
@@ -259,6 +341,104 @@ DimeModel::read(DimeInput* const in)
 
 bool
 DimeModel::write(DimeOutput* const out)
+{
+	dimeDiagnosticScope scope(this);
+
+	const bool setstats = out->getStats() == nullptr && this->stats != nullptr;
+	if (setstats) out->setStats(this->stats);
+	const auto starttime = std::chrono::steady_clock::now();
+	const bool ok = this->writeSections(out) && out->finish();
+	if (dimeStatsData* s = dimeStatsData::get(out->getStats()))
+	{
+		dimeStatsData::add(s->writeNanos,
+		                   std::chrono::duration_cast<std::chrono::nanoseconds>(
+			                   std::chrono::steady_clock::now() - starttime).count());
+	}
+	if (setstats) out->setStats(nullptr);
+	return ok;
+}
+
+//
+// Runs task on executor, or on a new thread if executor is empty.
+//
+
+static std::future<bool>
+run_async(std::function<bool()> task, const dimeExecutor& executor)
+{
+	if (!executor) return std::async(std::launch::async, std::move(task));
+	auto packaged = std::make_shared<std::packaged_task<bool()>>(std::move(task));
+	std::future<bool> result = packaged->get_future();
+	executor([packaged]() { (*packaged)(); });
+	return result;
+}
+
+/*!
+  Starts reading the model from \a in and returns at once. The read
+  runs on \a executor, or on a new thread if no executor is given,
+  and the returned future holds the result of read().
+
+  If \a control is set, it receives the progress at each entity
+  boundary, and the read stops at the next entity boundary after
+  DimeAsyncControl::cancel() is called. The future then returns
+  \e false. The model, \a in and \a control must not be used or
+  destructed until the future is ready. Note that the destructor of a
+  future from a new thread waits for the read to finish.
+
+  \sa DimeAsyncControl
+*/
+
+std::future<bool>
+DimeModel::readAsync(DimeInput* const in, DimeAsyncControl* const control,
+                     const dimeExecutor& executor)
+{
+	return run_async([this, in, control]() -> bool
+	{
+		in->setAsyncControl(control);
+		const bool ok = this->read(in);
+		in->setAsyncControl(nullptr);
+		if (ok && control) control->setProgress(1.0f, in->getByteOffset());
+		return ok;
+	}, executor);
+}
+
+/*!
+  Starts writing the model to \a out and returns at once. The write
+  runs on \a executor, or on a new thread if no executor is given,
+  and the returned future holds the result of write().
+
+  If \a control is set, it receives the progress at each entity
+  boundary, and the write stops at the next entity boundary after
+  DimeAsyncControl::cancel() is called. The future then returns
+  \e false, and the output file is incomplete. To compute the
+  progress, the records of the model are counted before writing
+  unless the number of records was set with
+  DimeOutput::setCallback(). The model, \a out and \a control must
+  not be used or destructed until the future is ready.
+
+  \sa readAsync()
+*/
+
+std::future<bool>
+DimeModel::writeAsync(DimeOutput* const out, DimeAsyncControl* const control,
+                      const dimeExecutor& executor)
+{
+	return run_async([this, out, control]() -> bool
+	{
+		if (control && out->numrecords == 0) out->numrecords = this->countRecords();
+		out->setAsyncControl(control);
+		const bool ok = this->write(out);
+		out->setAsyncControl(nullptr);
+		if (ok && control) control->setProgress(1.0f, out->bytesWritten);
+		return ok;
+	}, executor);
+}
+
+//
+// Writes the header comments, all sections and the end of file marker.
+//
+
+bool
+DimeModel::writeSections(DimeOutput* const out)
 {
 	if (largestHandle > 0)
 	{
@@ -273,8 +453,15 @@ DimeModel::write(DimeOutput* const out)
 				char buf[512];
 				this->getUniqueHandle(buf, 512);
 				this->largestHandle--; // ok to use this handle next time
-				param.string_data = buf;
-				hs->setVariable("$HANDSEED", &groupcode, &param, 1);
+				// only raise the seed, so an unchanged header stays unchanged
+				char* end = nullptr;
+				const unsigned long long seed = strtoull(param.string_data, &end, 16);
+				if (end == param.string_data ||
+					seed <= static_cast<unsigned long long>(this->largestHandle))
+				{
+					param.string_data = buf;
+					hs->setVariable("$HANDSEED", &groupcode, &param, 1);
+				}
 			}
 		}
 	}
@@ -284,13 +471,16 @@ DimeModel::write(DimeOutput* const out)
 		this->headerComments[i]->write(out);
 	}
 
+	out->model = this;
 	n = sections.count();
 	for (i = 0; i < n; i++)
 	{
+		if (out->copySource(sections[i])) continue;
 		out->writeGroupCode(0);
 		out->writeString(SECTIONID);
 		if (!sections[i]->write(out)) break;
 	}
+	out->model = nullptr;
 	if (i == n)
 	{
 		return out->writeGroupCode(0) && out->writeString(EOFID);
@@ -298,6 +488,141 @@ DimeModel::write(DimeOutput* const out)
 	return false;
 }
 
+/*!
+  Saves the model to \a filename in a binary snapshot format, which
+  loads much faster than DXF. Snapshots are meant as a cache for files
+  that are loaded often, and can only be read by loadSnapshot() on a
+  machine with the same byte order. Returns \e true on success.
+
+  \sa loadSnapshot()
+*/
+
+bool
+DimeModel::saveSnapshot(const char* const filename)
+{
+	dimeDiagnosticScope scope(this);
+	const size_t startsize = 1024 * 1024;
+	DimeOutput out;
+	dimeSnapshotStrings strings;
+	out.buffer = static_cast<char*>(malloc(startsize));
+	if (!out.buffer) return false;
+	out.bufferAlloc = startsize;
+	out.strings = &strings;
+	bool ok = this->write(&out);
+	out.strings = nullptr;
+	if (!ok) return false;
+
+	FILE* fp = fopen(filename, "wb");
+	if (!fp)
+	{
+		dime_diagnostic("Unable to open snapshot file: %s\n", filename);
+		return false;
+	}
+	dimeSnapshotHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, DIME_SNAPSHOT_MAGIC, sizeof(header.magic));
+	header.version = DIME_SNAPSHOT_VERSION;
+	header.byteorder = DIME_SNAPSHOT_BYTEORDER;
+	header.largestHandle = this->largestHandle;
+	header.numStrings = static_cast<uint32_t>(strings.map.size());
+	header.stringsSize = strings.blob.size();
+	header.streamSize = out.bufferSize;
+
+	ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+		(strings.blob.empty() ||
+		 fwrite(strings.blob.data(), strings.blob.size(), 1, fp) == 1) &&
+		(out.bufferSize == 0 ||
+		 fwrite(out.buffer, out.bufferSize, 1, fp) == 1);
+	if (fclose(fp) != 0) ok = false;
+	if (!ok) dime_diagnostic("Error writing snapshot file: %s\n", filename);
+	return ok;
+}
+
+/*!
+  Replaces the model with the snapshot stored in \a filename by
+  saveSnapshot(). Returns \e false if the file could not be read, or
+  if it was written by another version of DIME or on a machine with
+  a different byte order.
+
+  \sa saveSnapshot()
+*/
+
+bool
+DimeModel::loadSnapshot(const char* const filename)
+{
+	dimeDiagnosticScope scope(this);
+
+	FILE* fp = fopen(filename, "rb");
+	if (!fp)
+	{
+		dime_diagnostic("Unable to open snapshot file: %s\n", filename);
+		return false;
+	}
+	dimeSnapshotHeader header;
+	bool ok = fread(&header, sizeof(header), 1, fp) == 1 &&
+		!memcmp(header.magic, DIME_SNAPSHOT_MAGIC, sizeof(header.magic)) &&
+		header.version == DIME_SNAPSHOT_VERSION &&
+		header.byteorder == DIME_SNAPSHOT_BYTEORDER;
+
+	// the sizes must fit in the file, and each string takes at least
+	// its terminating null, before anything is allocated from them
+	long filesize = -1;
+	if (ok && fseek(fp, 0, SEEK_END) == 0)
+	{
+		filesize = ftell(fp);
+		if (fseek(fp, sizeof(header), SEEK_SET) != 0) filesize = -1;
+	}
+	if (ok)
+	{
+		const uint64_t avail = filesize >= static_cast<long>(sizeof(header)) ?
+			static_cast<uint64_t>(filesize) - sizeof(header) : 0;
+		ok = filesize >= 0 &&
+			header.stringsSize <= avail &&
+			header.streamSize <= avail &&
+			header.stringsSize + header.streamSize <= avail &&
+			header.numStrings <= header.stringsSize;
+	}
+	if (!ok)
+	{
+		fclose(fp);
+		dime_diagnostic("Not a valid snapshot file: %s\n", filename);
+		return false;
+	}
+	const size_t size = static_cast<size_t>(header.stringsSize + header.streamSize);
+	char* data = static_cast<char*>(malloc(size ? size : 1));
+	ok = data && (size == 0 || fread(data, size, 1, fp) == 1);
+	fclose(fp);
+
+	// the string table is a sequence of null-terminated strings
+	std::vector<const char*> strings;
+	if (ok)
+	{
+		strings.reserve(header.numStrings);
+		const char* str = data;
+		const char* end = data + header.stringsSize;
+		while (str < end && strings.size() < header.numStrings)
+		{
+			const char* next = static_cast<const char*>(memchr(str, 0, end - str));
+			if (!next) break;
+			strings.push_back(str);
+			str = next + 1;
+		}
+		ok = strings.size() == header.numStrings;
+	}
+	if (ok)
+	{
+		DimeInput in;
+		ok = in.setSnapshot(data + header.stringsSize, header.streamSize,
+		                    strings.data(), static_cast<int>(strings.size())) &&
+			this->read(&in);
+		if (header.largestHandle > this->largestHandle)
+			this->largestHandle = header.largestHandle;
+	}
+	else dime_diagnostic("Error reading snapshot file: %s\n", filename);
+	free(data);
+	return ok;
+}
+
 /*!
   Adds a reference in this model's dictionary. Used by BLOCK and
   INSERT entities to resolve references, but can also be used 
@@ -488,6 +813,89 @@ DimeModel::countRecords() const
 	return cnt;
 }
 
+/*!
+  \struct dimeMemoryUsage dime/Model.h
+  \brief The dimeMemoryUsage struct holds the memory breakdown returned
+  by DimeModel::getMemoryUsage().
+
+  \e total is the sum of all bytes counted. \e sections holds the bytes
+  of each section in the model, in the same order as getSection(),
+  including the entities, records and strings in the section. The
+  remaining bytes are in \e dictionaries (block, layer and handle names),
+  \e layers (dimeLayer objects), \e source (see setPassthrough()) and
+  \e other (the model itself and its header comments).
+
+  \e entities holds the bytes of the entities of each type, indexed by
+  DimeBase::TypeID. An entity owning other entities, e.g. a POLYLINE
+  and its VERTEX entities, is counted without them. \e records and
+  \e strings tell how much of the total is held in DimeRecord objects
+  and in strings, wherever they are stored. The layer table entries in
+  the TABLES section are counted in \e layers as well.
+
+  Only the sizes requested from the allocator are counted, not its
+  overhead per allocation.
+*/
+
+/*!
+  Constructor. Sets all sizes to 0.
+*/
+dimeMemoryUsage::dimeMemoryUsage()
+	: total(0), records(0), strings(0), dictionaries(0), layers(0),
+	  source(0), other(0)
+{
+	for (int i = 0; i < DimeBase::dimeLastTypeTag; i++) this->entities[i] = 0;
+}
+
+/*!
+  Computes the number of bytes allocated for this model and stores
+  the breakdown in \a usage. Returns the total. This traverses the
+  whole model, so it takes roughly as long as countRecords().
+
+  \sa dimeMemoryUsage
+*/
+
+size_t
+DimeModel::getMemoryUsage(dimeMemoryUsage& usage) const
+{
+	usage.total = usage.records = usage.strings = 0;
+	usage.dictionaries = usage.layers = usage.source = usage.other = 0;
+	for (int type = 0; type < DimeBase::dimeLastTypeTag; type++) usage.entities[type] = 0;
+	usage.sections.setCount(0);
+
+	int i, n = this->sections.count();
+	for (i = 0; i < n; i++)
+	{
+		const size_t start = usage.total;
+		usage.total += this->sections[i]->countMemory(usage);
+		usage.sections.append(usage.total - start);
+	}
+
+	usage.dictionaries = this->refDict->countMemory(usage) +
+		this->layerDict->countMemory(usage);
+	usage.total += usage.dictionaries;
+
+	size_t layers = this->layers.allocSize() * sizeof(dimeLayer*);
+	layers += this->layers.count() * sizeof(dimeLayer);
+	usage.layers += layers;
+	usage.total += layers;
+
+	if (this->source)
+	{
+		usage.source = sizeof(dimeSourceData) + this->source->bytes.capacity() +
+			this->source->ranges.capacity() * sizeof(dimeSourceRange);
+		usage.total += usage.source;
+	}
+
+	size_t other = sizeof(DimeModel) + this->sections.allocSize() * sizeof(DimeSection*);
+	other += this->headerComments.allocSize() * sizeof(DimeRecord*);
+	n = this->headerComments.count();
+	for (i = 0; i < n; i++)
+		other += this->headerComments[i]->countMemory(usage);
+	usage.other = other;
+	usage.total += other;
+	return usage.total;
+}
+
 /*
   Stupid function to reset the z-value of some rare DXF files that have
   some of their z-coordinates set to -999999. I have no clue what this
@@ -513,6 +921,7 @@ DimeModel::traverseEntities(dimeCallback const& callback,
                             bool explodeInserts,
                             bool traversePolylineVertices)
 {
+	dimeDiagnosticScope scope(this);
 	int i, n;
 	DimeState state(traversePolylineVertices, explodeInserts);
 	if (traverseBlocksSection)
@@ -543,6 +952,188 @@ DimeModel::traverseEntities(dimeCallback const& callback,
 	return true;
 }
 
+/*!
+  Traverses a single \a entity, like traverseEntities() does for each
+  entity in the ENTITIES section. Useful for reprocessing entities
+  which have changed.
+*/
+
+bool
+DimeModel::traverseEntity(DimeEntity* entity,
+                          dimeCallback const& callback,
+                          bool explodeInserts,
+                          bool traversePolylineVertices)
+{
+	DimeState state(traversePolylineVertices, explodeInserts);
+	return entity->traverse(&state, callback);
+}
+
+/*!
+  \class dimeGeometryBatch Model.h
+  \brief The dimeGeometryBatch struct describes caller-owned buffers
+  for DimeModel::extractGeometry().
+
+  All buffers are optional, and are owned by the caller, so no memory
+  is allocated by the library. Set the buffers you need to arrays with
+  room for the sizes returned by the size query:
+
+  - \c x, \c y, \c z: numVertices coordinates each
+  - \c xyz: 3 * numVertices packed coordinates
+  - \c xyzf: 3 * numVertices packed single precision coordinates,
+    relative to \c offset to avoid losing precision
+  - \c indices: numIndices vertex indices into the batch, with -1
+    between faces or line strips
+  - \c vertexOffsets, \c indexOffsets: numEntities + 1 offsets, where
+    entity i uses vertices [vertexOffsets[i], vertexOffsets[i + 1])
+    and the same for indices. An entity with vertices but no indices
+    uses running indices for its vertices.
+  - \c types: numEntities DimeEntity::GeometryType values
+  - \c thickness: numEntities thickness values
+  - \c extrusionDirs: 3 * numEntities extrusion direction components
+
+  The geometry is the same as returned by DimeEntity::extractGeometry(),
+  i.e. in the entity's coordinate system, before thickness and
+  extrusion direction are applied.
+*/
+
+/*!
+  Constructor. Sets all sizes to 0 and all buffers to \c NULL.
+*/
+dimeGeometryBatch::dimeGeometryBatch()
+	: numEntities(0), numVertices(0), numIndices(0),
+	  x(nullptr), y(nullptr), z(nullptr), xyz(nullptr), xyzf(nullptr),
+	  offset(0.0, 0.0, 0.0), indices(nullptr), vertexOffsets(nullptr),
+	  indexOffsets(nullptr), types(nullptr), thickness(nullptr),
+	  extrusionDirs(nullptr)
+{
+}
+
+/*!
+  Extracts the geometry of \a count entities in the ENTITIES section,
+  starting at index \a first, into the buffers in \a batch. If
+  \a count is negative, all entities from \a first are extracted.
+  INSERT entities are not exploded, and give no geometry.
+
+  When all buffers in \a batch are \c NULL, only the sizes are
+  calculated and stored in \a batch. Allocate the buffers you need
+  with these sizes, and call this method again with the same range to
+  fill them. The sizes are then updated to the number of values
+  written. Returns \c FALSE if the buffers are too small, e.g. because
+  the model has changed since the size query.
+
+  This is much faster than calling DimeEntity::extractGeometry() for
+  each entity, since the same temporary arrays are used for all
+  entities, and since the result is returned in memory owned by the
+  caller.
+*/
+
+bool
+DimeModel::extractGeometry(dimeGeometryBatch& batch,
+                           const int first, int count)
+{
+	dimeDiagnosticScope scope(this);
+	auto es = static_cast<DimeEntitiesSection*>(this->findSection("ENTITIES"));
+	const int numentities = es ? es->getNumEntities() : 0;
+	if (first < 0 || first > numentities) return false;
+	if (count < 0 || first + count > numentities) count = numentities - first;
+
+	const bool query = !batch.x && !batch.y && !batch.z && !batch.xyz &&
+		!batch.xyzf && !batch.indices && !batch.vertexOffsets &&
+		!batch.indexOffsets && !batch.types && !batch.thickness &&
+		!batch.extrusionDirs;
+	const bool hasx = batch.x && batch.y && batch.z;
+	if (!query && count > batch.numEntities) return false;
+	const int maxverts = batch.numVertices;
+	const int maxindices = batch.numIndices;
+
+	dimeArray<dimeVec3> verts(64);
+	dimeArray<int> indices(64);
+	dimeVec3 extrusiondir;
+	dxfdouble thickness;
+	int numverts = 0;
+	int numindices = 0;
+	for (int i = 0; i < count; i++)
+	{
+		verts.setCount(0);
+		indices.setCount(0);
+		const DimeEntity::GeometryType type =
+			es->getEntity(first + i)->extractGeometry(verts, indices,
+			                                          extrusiondir, thickness);
+		const int nv = verts.count();
+		const int ni = indices.count();
+		if (query)
+		{
+			numverts += nv;
+			numindices += ni;
+			continue;
+		}
+		if (numverts + nv > maxverts || numindices + ni > maxindices) return false;
+
+		if (batch.vertexOffsets) batch.vertexOffsets[i] = numverts;
+		if (batch.indexOffsets) batch.indexOffsets[i] = numindices;
+		if (batch.types) batch.types[i] = static_cast<unsigned char>(type);
+		if (batch.thickness) batch.thickness[i] = thickness;
+		if (batch.extrusionDirs)
+		{
+			batch.extrusionDirs[i * 3] = extrusiondir[0];
+			batch.extrusionDirs[i * 3 + 1] = extrusiondir[1];
+			batch.extrusionDirs[i * 3 + 2] = extrusiondir[2];
+		}
+
+		const dimeVec3* v = verts.constArrayPointer();
+		int j;
+		if (hasx)
+		{
+			for (j = 0; j < nv; j++)
+			{
+				batch.x[numverts + j] = v[j][0];
+				batch.y[numverts + j] = v[j][1];
+				batch.z[numverts + j] = v[j][2];
+			}
+		}
+		if (batch.xyz)
+		{
+			dxfdouble* dst = batch.xyz + numverts * 3;
+			for (j = 0; j < nv; j++, dst += 3)
+			{
+				dst[0] = v[j][0];
+				dst[1] = v[j][1];
+				dst[2] = v[j][2];
+			}
+		}
+		if (batch.xyzf)
+		{
+			float* dst = batch.xyzf + numverts * 3;
+			for (j = 0; j < nv; j++, dst += 3)
+			{
+				dst[0] = static_cast<float>(v[j][0] - batch.offset[0]);
+				dst[1] = static_cast<float>(v[j][1] - batch.offset[1]);
+				dst[2] = static_cast<float>(v[j][2] - batch.offset[2]);
+			}
+		}
+		if (batch.indices)
+		{
+			const int* idx = indices.constArrayPointer();
+			int* dst = batch.indices + numindices;
+			for (j = 0; j < ni; j++)
+			{
+				dst[j] = idx[j] < 0 ? -1 : idx[j] + numverts;
+			}
+		}
+		numverts += nv;
+		numindices += ni;
+	}
+	if (!query)
+	{
+		if (batch.vertexOffsets) batch.vertexOffsets[count] = numverts;
+		if (batch.indexOffsets) batch.indexOffsets[count] = numindices;
+	}
+	batch.numEntities = count;
+	batch.numVertices = numverts;
+	batch.numIndices = numindices;
+	return true;
+}
+
 /*!
   Finds the section with section \a sectionname. Currently (directly) 
   supported sections are HEADER, CLASSES, TABLES, BLOCKS, ENTITIES and OBJECTS.
@@ -626,6 +1217,83 @@ DimeModel::insertSection(DimeSection* const section, const int idx)
   Removes a section from the list of sections.
 */
 
+/*!
+  Sets whether the bytes of the DXF file should be kept when reading,
+  so that unchanged data can be copied verbatim by write(). The
+  setting takes effect for the next call to read(), and is ignored
+  for binary files. This costs as much memory as the size of the
+  file, but saving a model where only a few entities were changed
+  becomes proportional to the size of the change, and the formatting
+  of the unchanged parts is preserved.
+
+  Entities are tracked through DimeEntity::isModified(), and sections
+  through DimeSection::isDirty(). Changes to table entries, classes
+  and objects are not tracked, so DimeSection::setDirty() must be
+  called on the section after such changes.
+*/
+
+void
+DimeModel::setPassthrough(const bool onOff)
+{
+	this->passthrough = onOff;
+}
+
+/*!
+  \fn bool DimeModel::getPassthrough() const
+  Returns whether the source bytes are kept when reading.
+  \sa setPassthrough()
+*/
+
+/*!
+  Sets the statistics object that collects counters while reading
+  and writing the model, and on the model's dictionaries. The object is
+  used for read() and write() unless the input or output has its own.
+  Set to \e nullptr (the default) to disable collection.
+
+  \sa DimeStats
+*/
+
+void
+DimeModel::setStats(DimeStats* const stats)
+{
+	this->stats = stats;
+	if (this->refDict) this->refDict->setStats(stats);
+	if (this->layerDict) this->layerDict->setStats(stats);
+}
+
+/*!
+  \fn DimeStats* DimeModel::getStats() const
+  Returns the statistics object, or \e nullptr if none is set.
+*/
+
+/*!
+  Sets the function that receives the warnings and errors reported
+  while reading, writing, traversing and converting this model. The
+  function is called with one message at a time, without a trailing
+  newline, and with \a userdata. It is called from the thread that
+  works on the model, or from the worker threads of
+  DimeOutput::writeEntities(), so it must be thread safe if the
+  handler is shared between models. Set to \e nullptr (the default)
+  to print the messages to stderr.
+*/
+
+void
+DimeModel::setDiagnosticHandler(const dimeDiagnosticHandler handler, void* const userdata)
+{
+	this->diagnosticHandler = handler;
+	this->diagnosticData = userdata;
+}
+
+/*!
+  \fn dimeDiagnosticHandler DimeModel::getDiagnosticHandler() const
+  Returns the diagnostic handler, or \e nullptr if none is set.
+*/
+
+/*!
+  \fn void* DimeModel::getDiagnosticData() const
+  Returns the user data passed to the diagnostic handler.
+*/
+
 void
 DimeModel::removeSection(const int idx)
 {
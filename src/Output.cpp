@@ -36,21 +36,52 @@
 */
 
 #include <dime/Output.h>
+#include <dime/Async.h>
+#include <dime/Model.h>
+#include <dime/entities/Block.h>
+#include <dime/entities/Polyline.h>
+#include <dime/entities/Vertex.h>
+#include <dime/records/Record.h>
+#include <dime/sections/BlocksSection.h>
+#include <dime/sections/EntitiesSection.h>
+#include "Compression.h"
+#include "Diagnostic.h"
+#include "SourceData.h"
+#include "Snapshot.h"
+#include "StatsData.h"
 #include <math.h>
-
-/*!
-  \fn bool dimeOutput::writeHeader()
-  This method does nothing now, but if binary files are supported in the
-  future, it must be called.
-*/
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+// number of entities formatted by each thread between writes
+#define ENTITIES_PER_CHUNK 2048
+#define BUFFER_START_SIZE 65536
+
+#define BINARY_SENTINEL "AutoCAD Binary DXF\r\n\x1a"
+#define BINARY_SENTINEL_SIZE 22 // including the terminating null
+
+// format for real values, 9 digits are enough to read back the same float
+#ifdef DIME_FLOAT_PRECISION
+#define REAL_FORMAT "%.9g\n"
+#else // !DIME_FLOAT_PRECISION
+#define REAL_FORMAT "%.15g\n"
+#endif // !DIME_FLOAT_PRECISION
 
 /*!
   Constructor.
 */
 
 DimeOutput::DimeOutput()
-	: fp(nullptr), binary(false), callback(nullptr), callbackdata(nullptr),
-	  aborted(false), didOpenFile(false)
+	: model(nullptr), fp(nullptr), binary(false), writer(nullptr),
+	  compression(DIME_COMPRESSION_NONE), compressionLevel(-1), compressionThreads(1),
+	  callback(nullptr), callbackdata(nullptr),
+	  numrecords(0), numwrites(0), aborted(false), didOpenFile(false),
+	  numThreads(1), buffer(nullptr), bufferSize(0), bufferAlloc(0),
+	  strings(nullptr), wroteSentinel(false), groupCode(0), stats(nullptr),
+	  asyncControl(nullptr), bytesWritten(0)
 {
 }
 
@@ -60,7 +91,9 @@ DimeOutput::DimeOutput()
 
 DimeOutput::~DimeOutput()
 {
+	this->closeWriter();
 	if (this->fp && this->didOpenFile) fclose(this->fp);
+	free(this->buffer);
 }
 
 /*!
@@ -89,10 +122,12 @@ DimeOutput::setCallback(const int num_records,
 bool
 DimeOutput::setFilename(const char* const filename)
 {
+	this->closeWriter();
 	if (this->fp && this->didOpenFile) fclose(this->fp);
 	this->fp = fopen(filename, "wb");
 	this->didOpenFile = true;
-	return (this->fp != nullptr);
+	this->wroteSentinel = false;
+	return (this->fp != nullptr) && this->openWriter();
 }
 
 /*!
@@ -102,17 +137,94 @@ DimeOutput::setFilename(const char* const filename)
 bool
 DimeOutput::setFileHandle(FILE* fp)
 {
+	this->closeWriter();
 	if (this->fp && this->didOpenFile) fclose(this->fp);
 
 	assert(fp);
 	this->fp = fp;
 	this->didOpenFile = false;
-	return true;
+	this->wroteSentinel = false;
+	return this->openWriter();
+}
+
+/*!
+  Compresses the output with \a compression, at \a level, or the
+  default level of the format if \a level is below 0. With more than
+  one thread in \a numthreads, gzip output is compressed in parallel
+  as a series of gzip members, and zstd output with the worker threads
+  of libzstd. Must be called before anything is written. Returns
+  \e false if this build of DIME does not support \a compression
+  (see dime_compression_supported()).
+
+  The file is complete after finish() has been called, which
+  DimeModel::write() and DimeStreamWriter::end() do.
+*/
+
+bool
+DimeOutput::setCompression(const dimeCompression compression, const int level,
+                           const int numthreads)
+{
+	if (!dime_compression_supported(compression)) return false;
+	this->closeWriter();
+	this->compression = compression;
+	this->compressionLevel = level;
+	this->compressionThreads = numthreads;
+	return this->fp == nullptr || this->openWriter();
 }
 
 /*!
-  Sets binary (DXB) or ASCII (DXF) format. Currently only ASCII
-  is supported.
+  \fn dimeCompression DimeOutput::getCompression() const
+  Returns the compression format of the output.
+*/
+
+/*!
+  Finishes the compressed stream, and flushes it to the file. Nothing
+  can be written to a compressed file after this. Returns \e true
+  if the output is not compressed.
+*/
+
+bool
+DimeOutput::finish()
+{
+	return this->writer ? this->writer->finish() : true;
+}
+
+//
+// Starts compressing to the file just set, if enabled.
+//
+
+bool
+DimeOutput::openWriter()
+{
+	if (this->compression == DIME_COMPRESSION_NONE) return true;
+	this->writer = new dimeFileWriter(this->fp, this->compression,
+	                                  this->compressionLevel, this->compressionThreads);
+	return this->writer->isValid();
+}
+
+//
+// Finishes and deletes the compressor. Returns false if the file
+// could not be finished.
+//
+
+bool
+DimeOutput::closeWriter()
+{
+	if (!this->writer) return true;
+	const bool ok = this->writer->finish();
+	delete this->writer;
+	this->writer = nullptr;
+	return ok;
+}
+
+/*!
+  Sets binary or ASCII DXF format. Must be called before anything is
+  written. Binary files are written with 16 bit group codes and little
+  endian values, as in AutoCAD Release 13 and later, and can be read
+  by DimeInput.
+
+  Binary files are always written from scratch, so the source bytes
+  kept by DimeModel::setPassthrough() are not used.
 */
 
 void
@@ -131,6 +243,59 @@ DimeOutput::isBinary() const
 	return this->binary;
 }
 
+/*!
+  Sets the number of threads used by writeEntities() to format
+  entities. The default is 1, which writes everything from the calling
+  thread. Set to 0 to use one thread per hardware core.
+*/
+
+void
+DimeOutput::setNumThreads(const int num)
+{
+	this->numThreads = num < 0 ? 0 : num;
+}
+
+/*!
+  \fn int DimeOutput::getNumThreads() const
+  Returns the number of threads used by writeEntities().
+*/
+
+/*!
+  Sets the statistics object that counts the bytes written to the
+  file. Set to \e nullptr (the default) to disable counting.
+
+  \sa DimeStats
+*/
+
+void
+DimeOutput::setStats(DimeStats* const stats)
+{
+	this->stats = stats;
+}
+
+/*!
+  \fn DimeStats* DimeOutput::getStats() const
+  Returns the statistics object, or \e nullptr if none is set.
+*/
+
+/*!
+  Sets the object that receives the progress of the write, and that
+  can cancel it from another thread. Set to \e nullptr (the default)
+  to disable. The progress is only known if the number of records has
+  been set with setCallback(), see DimeModel::writeAsync().
+*/
+
+void
+DimeOutput::setAsyncControl(DimeAsyncControl* const control)
+{
+	this->asyncControl = control;
+}
+
+/*!
+  \fn DimeAsyncControl* DimeOutput::getAsyncControl() const
+  Returns the async control object, or \e nullptr if none is set.
+*/
+
 /*!
   Writes a record group code to the file.
 */
@@ -149,7 +314,24 @@ DimeOutput::writeGroupCode(const int groupcode)
 		}
 		this->numwrites++;
 	}
-	return fprintf(this->fp, "%3d\n", groupcode) > 0;
+	else if (this->buffer || this->asyncControl) this->numwrites++;
+	if (this->strings)
+	{
+		const int16_t code = static_cast<int16_t>(groupcode);
+		return this->writeBytes(reinterpret_cast<const char*>(&code), sizeof(code));
+	}
+	if (this->binary)
+	{
+		if (!this->wroteSentinel)
+		{
+			this->wroteSentinel = true;
+			if (!this->writeBytes(BINARY_SENTINEL, BINARY_SENTINEL_SIZE)) return false;
+		}
+		const int16_t code = static_cast<int16_t>(groupcode);
+		this->groupCode = groupcode;
+		return this->writeBinary(&code, sizeof(code));
+	}
+	return this->print("%3d\n", groupcode);
 }
 
 /*!
@@ -159,7 +341,9 @@ DimeOutput::writeGroupCode(const int groupcode)
 bool
 DimeOutput::writeInt8(const int8_t val)
 {
-	return fprintf(this->fp, "%6d\n", static_cast<int>(val)) > 0;
+	if (this->strings) return this->writeValue(DIME_SNAPSHOT_INT8, &val, sizeof(val));
+	if (this->binary) return this->writeBinaryValue(static_cast<int32_t>(val));
+	return this->print("%6d\n", static_cast<int>(val));
 }
 
 /*!
@@ -169,7 +353,9 @@ DimeOutput::writeInt8(const int8_t val)
 bool
 DimeOutput::writeInt16(const int16_t val)
 {
-	return fprintf(this->fp, "%6d\n", static_cast<int>(val)) > 0;
+	if (this->strings) return this->writeValue(DIME_SNAPSHOT_INT16, &val, sizeof(val));
+	if (this->binary) return this->writeBinaryValue(static_cast<int32_t>(val));
+	return this->print("%6d\n", static_cast<int>(val));
 }
 
 /*!
@@ -179,7 +365,9 @@ DimeOutput::writeInt16(const int16_t val)
 bool
 DimeOutput::writeInt32(const int32_t val)
 {
-	return fprintf(this->fp, "%6d\n", val) > 0;
+	if (this->strings) return this->writeValue(DIME_SNAPSHOT_INT32, &val, sizeof(val));
+	if (this->binary) return this->writeBinaryValue(val);
+	return this->print("%6d\n", val);
 }
 
 /*!
@@ -189,12 +377,14 @@ DimeOutput::writeInt32(const int32_t val)
 bool
 DimeOutput::writeFloat(const float val)
 {
+	if (this->strings) return this->writeValue(DIME_SNAPSHOT_FLOAT, &val, sizeof(val));
+	if (this->binary) return this->writeBinaryValue(static_cast<dxfmath>(val));
 	// Check for integer value, force decimal and one zero.
 	if (fabsf(val) < 1000000.0 && floorf(val) == val)
 	{
-		return fprintf(this->fp, "%.1f\n", val);
+		return this->print("%.1f\n", val);
 	}
-	return fprintf(this->fp, "%.15g\n", val);
+	return this->print("%.15g\n", val);
 }
 
 /*!
@@ -204,12 +394,18 @@ DimeOutput::writeFloat(const float val)
 bool
 DimeOutput::writeDouble(const dxfdouble val)
 {
+	if (this->strings)
+	{
+		const double tmp = val;
+		return this->writeValue(DIME_SNAPSHOT_DOUBLE, &tmp, sizeof(tmp));
+	}
+	if (this->binary) return this->writeBinaryValue(static_cast<dxfmath>(val));
 	// Check for integer value, force decimal and one zero.
 	if (fabs(val) < 1000000.0 && floor(val) == val)
 	{
-		return fprintf(this->fp, "%.1f\n", val);
+		return this->print("%.1f\n", val);
 	}
-	return fprintf(this->fp, "%.15g\n", val) > 0;
+	return this->print(REAL_FORMAT, val);
 }
 
 /*!
@@ -219,7 +415,447 @@ DimeOutput::writeDouble(const dxfdouble val)
 bool
 DimeOutput::writeString(const char* const str)
 {
-	return fprintf(this->fp, "%s\n", str) > 0;
+	if (this->strings)
+	{
+		const uint32_t idx = this->strings->intern(str);
+		return this->writeValue(DIME_SNAPSHOT_STRING, &idx, sizeof(idx));
+	}
+	if (this->binary) return this->writeBytes(str, static_cast<long>(strlen(str) + 1));
+	return this->print("%s\n", str);
+}
+
+/*!
+  Writes \a num entities in order. If more than one thread is set with
+  setNumThreads(), the entities are formatted in chunks into per
+  thread memory buffers, and the buffers are written to the file in
+  the original order. The progress callback is only called from the
+  calling thread. Returns \e false if an entity could not be written
+  or the write was aborted.
+
+  When the model being written keeps its source bytes (see
+  DimeModel::setPassthrough()), runs of unchanged entities which were
+  adjacent in the source file are copied verbatim instead.
+*/
+
+bool
+DimeOutput::writeEntities(DimeEntity* const* const entities, const int num)
+{
+	const dimeSourceData* source = this->model ? this->model->source : nullptr;
+	if (!source || this->buffer || this->binary) return this->formatEntities(entities, num);
+
+	int i = 0;
+	while (i < num)
+	{
+		// entities that must be formatted
+		int j = i;
+		while (j < num && !findUnchanged(source, entities[j])) j++;
+		if (j > i && !this->formatEntities(entities + i, j - i)) return false;
+		if (j == num) break;
+
+		// adjacent unchanged entities
+		const long start = findUnchanged(source, entities[j])->start;
+		long end = start;
+		int numgroups = 0;
+		for (i = j; i < num; i++)
+		{
+			const dimeSourceRange* range = findUnchanged(source, entities[i]);
+			if (!range || range->start != end) break;
+			end = range->end;
+			if (this->callback || this->asyncControl) numgroups += entities[i]->countRecords();
+		}
+		if (!this->writeBytes(source->bytes.data() + start, end - start)) return false;
+		this->addProgress(numgroups);
+		if (this->checkAborted()) return false;
+	}
+	return true;
+}
+
+//
+// Copies the section from the source file if neither the section nor
+// any entities in it have changed. Returns false if the section must be
+// written normally.
+//
+
+bool
+DimeOutput::copySource(const DimeSection* const section)
+{
+	const dimeSourceData* source = this->model ? this->model->source : nullptr;
+	if (!source || this->buffer || this->binary || section->isDirty()) return false;
+	const dimeSourceRange* range = source->find(section, section->sourceIndex);
+	if (!range) return false;
+
+	int i, n;
+	switch (section->typeId())
+	{
+	case DimeBase::dimeEntitiesSectionType:
+	{
+		auto es = static_cast<DimeEntitiesSection*>(const_cast<DimeSection*>(section));
+		n = es->getNumEntities();
+		for (i = 0; i < n; i++)
+		{
+			if (!findUnchanged(source, es->getEntity(i))) return false;
+		}
+		break;
+	}
+	case DimeBase::dimeBlocksSectionType:
+	{
+		auto bs = static_cast<DimeBlocksSection*>(const_cast<DimeSection*>(section));
+		n = bs->getNumBlocks();
+		for (i = 0; i < n; i++)
+		{
+			if (!findUnchanged(source, bs->getBlock(i))) return false;
+		}
+		break;
+	}
+	default:
+		break;
+	}
+	if (!this->writeBytes(source->bytes.data() + range->start, range->end - range->start))
+		return false;
+	this->addProgress(section->countRecords());
+	return true;
+}
+
+//
+// Writes \a num bytes unformatted.
+//
+
+bool
+DimeOutput::writeBytes(const char* const data, const long num)
+{
+	if (this->aborted) return false;
+	if (this->buffer)
+	{
+		size_t newalloc = this->bufferAlloc;
+		while (newalloc - this->bufferSize < static_cast<size_t>(num)) newalloc *= 2;
+		if (newalloc != this->bufferAlloc)
+		{
+			char* newbuffer = static_cast<char*>(realloc(this->buffer, newalloc));
+			if (!newbuffer) return false;
+			this->buffer = newbuffer;
+			this->bufferAlloc = newalloc;
+		}
+		memcpy(this->buffer + this->bufferSize, data, num);
+		this->bufferSize += num;
+		return true;
+	}
+	if (dimeStatsData* s = dimeStatsData::get(this->stats)) dimeStatsData::add(s->bytesWritten, num);
+	this->bytesWritten += num;
+	if (this->writer) return this->writer->write(data, static_cast<size_t>(num));
+	return fwrite(data, 1, num, this->fp) == static_cast<size_t>(num);
+}
+
+//
+// returns the source range of entity if it can be copied verbatim
+//
+const dimeSourceRange*
+DimeOutput::findUnchanged(const dimeSourceData* const source, DimeEntity* const entity)
+{
+	if (entity->isModified() || entity->isDeleted()) return nullptr;
+	const dimeSourceRange* range = source->find(entity, entity->sourceIndex);
+	if (!range) return nullptr;
+
+	int i, n;
+	switch (entity->typeId())
+	{
+	case DimeBase::dimePolylineType:
+	{
+		auto pline = static_cast<DimePolyline*>(entity);
+		n = pline->getNumCoordVertices();
+		for (i = 0; i < n; i++)
+		{
+			if (pline->getCoordVertex(i)->isModified()) return nullptr;
+		}
+		n = pline->getNumIndexVertices();
+		for (i = 0; i < n; i++)
+		{
+			if (pline->getIndexVertex(i)->isModified()) return nullptr;
+		}
+		break;
+	}
+	case DimeBase::dimeBlockType:
+	{
+		auto block = static_cast<DimeBlock*>(entity);
+		if (block->endblock && block->endblock->isModified()) return nullptr;
+		n = block->getNumEntities();
+		for (i = 0; i < n; i++)
+		{
+			if (!findUnchanged(source, block->getEntity(i))) return nullptr;
+		}
+		break;
+	}
+	default:
+		break;
+	}
+	return range;
+}
+
+//
+// Writes a snapshot value, see Snapshot.h.
+//
+
+bool
+DimeOutput::writeValue(const int type, const void* const data, const int size)
+{
+	char tmp[16];
+	tmp[0] = static_cast<char>(type);
+	memcpy(tmp + 1, data, size);
+	return this->writeBytes(tmp, size + 1);
+}
+
+//
+// Writes a binary DXF value in little endian byte order.
+//
+
+bool
+DimeOutput::writeBinary(const void* const data, const int size)
+{
+	static const uint16_t endiantest = 1;
+	if (*reinterpret_cast<const unsigned char*>(&endiantest) == 1)
+		return this->writeBytes(static_cast<const char*>(data), size);
+	char tmp[8];
+	for (int i = 0; i < size; i++)
+		tmp[i] = static_cast<const char*>(data)[size - 1 - i];
+	return this->writeBytes(tmp, size);
+}
+
+//
+// Writes a number as the type the reader expects for the current group
+// code. Entities do not always use the matching write method, which
+// does not matter for ASCII files. Integers and reals have separate
+// overloads so that neither is rounded through dxfdouble.
+//
+
+bool
+DimeOutput::writeBinaryValue(const int32_t val)
+{
+	switch (DimeRecord::getRecordType(this->groupCode))
+	{
+	case DimeBase::dimeInt8RecordType:
+	{
+		const int8_t tmp = static_cast<int8_t>(val);
+		return this->writeBinary(&tmp, sizeof(tmp));
+	}
+	case DimeBase::dimeInt16RecordType:
+	{
+		const int16_t tmp = static_cast<int16_t>(val);
+		return this->writeBinary(&tmp, sizeof(tmp));
+	}
+	case DimeBase::dimeInt32RecordType:
+		return this->writeBinary(&val, sizeof(val));
+	case DimeBase::dimeFloatRecordType:
+	case DimeBase::dimeDoubleRecordType:
+		return this->writeBinaryValue(static_cast<dxfmath>(val));
+	default:
+	{
+		char buf[64];
+		sprintf(buf, "%ld", static_cast<long>(val));
+		return this->writeBytes(buf, static_cast<long>(strlen(buf) + 1));
+	}
+	}
+}
+
+bool
+DimeOutput::writeBinaryValue(const dxfmath val)
+{
+	switch (DimeRecord::getRecordType(this->groupCode))
+	{
+	case DimeBase::dimeInt8RecordType:
+	case DimeBase::dimeInt16RecordType:
+	case DimeBase::dimeInt32RecordType:
+		return this->writeBinaryValue(static_cast<int32_t>(val));
+	case DimeBase::dimeFloatRecordType: // binary files only contain doubles
+	case DimeBase::dimeDoubleRecordType:
+	{
+		const double tmp = val;
+		return this->writeBinary(&tmp, sizeof(tmp));
+	}
+	default:
+	{
+		char buf[64];
+		sprintf(buf, "%.16g", val);
+		return this->writeBytes(buf, static_cast<long>(strlen(buf) + 1));
+	}
+	}
+}
+
+//
+// Formats and writes entities, using worker threads if enabled.
+//
+
+bool
+DimeOutput::formatEntities(DimeEntity* const* const entities, const int num)
+{
+	int numthreads = this->numThreads;
+	if (numthreads == 0) numthreads = static_cast<int>(std::thread::hardware_concurrency());
+	if (numthreads > num / ENTITIES_PER_CHUNK) numthreads = num / ENTITIES_PER_CHUNK;
+	if (numthreads <= 1 || this->buffer)
+	{
+		for (int i = 0; i < num; i++)
+		{
+			if (this->checkAborted() || !entities[i]->write(this)) return false;
+		}
+		return true;
+	}
+
+	std::vector<DimeOutput> workers(numthreads);
+	std::vector<char> status(numthreads);
+	for (DimeOutput& w : workers)
+	{
+		w.binary = this->binary;
+		w.wroteSentinel = true;
+		w.model = this->model;
+		w.buffer = static_cast<char*>(malloc(BUFFER_START_SIZE));
+		w.bufferAlloc = w.buffer ? BUFFER_START_SIZE : 0;
+	}
+	// worker threads report to the same model as the calling thread
+	const DimeModel* const diagnosticmodel = dimeDiagnosticScope::getModel();
+	const auto format = [&](const int t, const int begin)
+	{
+		dimeDiagnosticScope scope(diagnosticmodel);
+		DimeOutput& w = workers[t];
+		const int end = begin + ENTITIES_PER_CHUNK < num ? begin + ENTITIES_PER_CHUNK : num;
+		status[t] = 1;
+		for (int i = begin; i < end && status[t]; i++)
+		{
+			status[t] = entities[i]->write(&w);
+		}
+	};
+
+	std::vector<std::thread> threads;
+	threads.reserve(numthreads - 1);
+	for (int first = 0; first < num; first += numthreads * ENTITIES_PER_CHUNK)
+	{
+		int t, n = 0;
+		for (t = 0; t < numthreads && first + t * ENTITIES_PER_CHUNK < num; t++)
+		{
+			workers[t].bufferSize = 0;
+			workers[t].numwrites = 0;
+			n++;
+		}
+		for (t = 1; t < n; t++)
+		{
+			threads.emplace_back(format, t, first + t * ENTITIES_PER_CHUNK);
+		}
+		format(0, first);
+		for (std::thread& thread : threads) thread.join();
+		threads.clear();
+
+		for (t = 0; t < n; t++)
+		{
+			const DimeOutput& w = workers[t];
+			if (!this->writeBytes(w.buffer, static_cast<long>(w.bufferSize))) return false;
+			this->addProgress(w.numwrites);
+			if (!status[t] || this->checkAborted()) return false;
+		}
+	}
+	return true;
+}
+
+//
+// Formats to the memory buffer, or to the file if no buffer is set.
+//
+
+bool
+DimeOutput::print(const char* const format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	int ret;
+	if (this->buffer)
+	{
+		size_t avail = this->bufferAlloc - this->bufferSize;
+		va_list copy;
+		va_copy(copy, args);
+		ret = vsnprintf(this->buffer + this->bufferSize, avail, format, copy);
+		va_end(copy);
+		if (ret >= 0 && static_cast<size_t>(ret) >= avail)
+		{
+			size_t newalloc = this->bufferAlloc * 2;
+			while (newalloc - this->bufferSize <= static_cast<size_t>(ret)) newalloc *= 2;
+			char* newbuffer = static_cast<char*>(realloc(this->buffer, newalloc));
+			if (!newbuffer)
+			{
+				va_end(args);
+				return false;
+			}
+			this->buffer = newbuffer;
+			this->bufferAlloc = newalloc;
+			ret = vsnprintf(this->buffer + this->bufferSize, newalloc - this->bufferSize,
+			                format, args);
+		}
+		if (ret > 0) this->bufferSize += ret;
+	}
+	else if (this->writer)
+	{
+		char buf[512];
+		va_list copy;
+		va_copy(copy, args);
+		ret = vsnprintf(buf, sizeof(buf), format, copy);
+		va_end(copy);
+		if (ret >= static_cast<int>(sizeof(buf)))
+		{
+			std::vector<char> longbuf(ret + 1);
+			vsnprintf(longbuf.data(), longbuf.size(), format, args);
+			if (!this->writer->write(longbuf.data(), ret)) ret = -1;
+		}
+		else if (ret > 0 && !this->writer->write(buf, ret)) ret = -1;
+		dimeStatsData* s = dimeStatsData::get(this->stats);
+		if (s && ret > 0) dimeStatsData::add(s->bytesWritten, ret);
+		if (ret > 0) this->bytesWritten += ret;
+	}
+	else
+	{
+		ret = vfprintf(this->fp, format, args);
+		dimeStatsData* s = dimeStatsData::get(this->stats);
+		if (s && ret > 0) dimeStatsData::add(s->bytesWritten, ret);
+		if (ret > 0) this->bytesWritten += ret;
+	}
+	va_end(args);
+	return ret > 0;
+}
+
+//
+// Updates the progress callback after numgroups group codes were
+// written by a worker thread.
+//
+
+void
+DimeOutput::addProgress(const int numgroups)
+{
+	if ((!this->callback && !this->asyncControl) || !this->numrecords) return;
+	const int prev = this->numwrites;
+	this->numwrites += numgroups;
+	if (this->callback && (prev >> 8) != (this->numwrites >> 8))
+	{
+		float val = static_cast<float>(this->numwrites) / static_cast<float>(this->numrecords);
+		if (val > 1.0f) val = 1.0f;
+		this->aborted = !static_cast<bool>(callback(val, this->callbackdata));
+	}
+}
+
+//
+// Called before each entity is written. Publishes the progress to the
+// async control object, and returns true if the write has been
+// cancelled or was aborted from the progress callback.
+//
+
+bool
+DimeOutput::checkAborted()
+{
+	DimeAsyncControl* const control = this->asyncControl;
+	if (control && !this->aborted)
+	{
+		float pos = 0.0f;
+		if (this->numrecords > 0)
+		{
+			pos = static_cast<float>(this->numwrites) / static_cast<float>(this->numrecords);
+			if (pos > 1.0f) pos = 1.0f;
+		}
+		control->setProgress(pos, this->bytesWritten);
+		if (control->isCancelled()) this->aborted = true;
+	}
+	return this->aborted;
 }
 
 int
@@ -0,0 +1,138 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include "ReadAhead.h"
+
+//
+// Starts the reader thread, which begins filling the buffers at once.
+//
+
+dimeReadAhead::dimeReadAhead(const int numbuffers, const size_t buffersize, readFunc read)
+	: numBuffers(numbuffers < 2 ? 2 : numbuffers), bufferSize(buffersize),
+	  read(std::move(read)), filled(0), released(0), taken(0), atEnd(false),
+	  stopping(false), readerWaiting(false), consumerWaiting(false)
+{
+	this->data.resize(this->numBuffers * this->bufferSize);
+	this->lengths.resize(this->numBuffers);
+	this->thread = std::thread(&dimeReadAhead::run, this);
+}
+
+//
+// Stops the reader thread. Buffers read ahead are discarded.
+//
+
+dimeReadAhead::~dimeReadAhead()
+{
+	this->stopping = true;
+	this->wake(this->readerWaiting);
+	this->thread.join();
+}
+
+//
+// Releases the buffer returned by the previous call and returns the
+// next one in buffer. Returns the number of bytes in it, or 0 at end
+// of file.
+//
+
+size_t
+dimeReadAhead::next(char*& buffer)
+{
+	if (this->atEnd) return 0;
+	if (this->released != this->taken)
+	{
+		this->released = this->taken;
+		this->wake(this->readerWaiting);
+	}
+	if (this->filled.load() == this->taken)
+	{
+		this->wait(this->consumerWaiting, [this]()
+		{
+			return this->filled.load() != this->taken;
+		});
+	}
+	const unsigned int slot = this->taken++ % this->numBuffers;
+	buffer = this->data.data() + slot * this->bufferSize;
+	const size_t len = this->lengths[slot];
+	if (len == 0) this->atEnd = true;
+	return len;
+}
+
+//
+// The reader thread. A buffer of length 0 marks the end of the file.
+//
+
+void
+dimeReadAhead::run()
+{
+	while (!this->stopping)
+	{
+		const unsigned int num = this->filled.load();
+		if (num - this->released >= this->numBuffers)
+		{
+			this->wait(this->readerWaiting, [this, num]()
+			{
+				return this->stopping || num - this->released < this->numBuffers;
+			});
+			continue;
+		}
+		const unsigned int slot = num % this->numBuffers;
+		const size_t len = this->read(this->data.data() + slot * this->bufferSize, this->bufferSize);
+		this->lengths[slot] = len;
+		this->filled.store(num + 1);
+		this->wake(this->consumerWaiting);
+		if (len == 0) break;
+	}
+}
+
+//
+// Blocks until ready() returns true. The other thread calls wake()
+// after changing the state tested by ready().
+//
+
+void
+dimeReadAhead::wait(std::atomic<bool>& waiting, const std::function<bool()>& ready)
+{
+	std::unique_lock<std::mutex> lock(this->mutex);
+	waiting = true;
+	while (!ready()) this->cond.wait(lock);
+	waiting = false;
+}
+
+void
+dimeReadAhead::wake(std::atomic<bool>& waiting)
+{
+	if (!waiting) return;
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+	}
+	this->cond.notify_all();
+}
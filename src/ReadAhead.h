@@ -0,0 +1,89 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#ifndef DIME_READAHEAD_H
+#define DIME_READAHEAD_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//
+// A background thread that reads a file into a ring of buffers ahead
+// of DimeInput. There is one reader and one consumer. The buffers are
+// handed over with atomic counters, and the mutex is only used by a
+// thread that has to wait for the other.
+//
+
+class dimeReadAhead
+{
+public:
+	// reads up to size bytes into buffer, returns 0 at end of file
+	using readFunc = std::function<size_t(char* buffer, size_t size)>;
+
+	dimeReadAhead(int numbuffers, size_t buffersize, readFunc read);
+	~dimeReadAhead();
+
+	size_t next(char*& buffer);
+
+private:
+	dimeReadAhead(const dimeReadAhead&) = delete;
+	dimeReadAhead& operator=(const dimeReadAhead&) = delete;
+
+	void run();
+	void wait(std::atomic<bool>& waiting, const std::function<bool()>& ready);
+	void wake(std::atomic<bool>& waiting);
+
+	const unsigned int numBuffers;
+	const size_t bufferSize;
+	readFunc read;
+	std::vector<char> data;
+	std::vector<size_t> lengths;
+
+	// buffers are filled, taken and released in order, counting from 0
+	std::atomic<unsigned int> filled;
+	std::atomic<unsigned int> released;
+	unsigned int taken; // only used by the consumer
+	bool atEnd;         // only used by the consumer
+
+	std::atomic<bool> stopping;
+	std::atomic<bool> readerWaiting;
+	std::atomic<bool> consumerWaiting;
+	std::mutex mutex;
+	std::condition_variable cond;
+	std::thread thread;
+};
+
+#endif // ! DIME_READAHEAD_H
@@ -46,6 +46,8 @@
 #include <dime/Output.h>
 
 #include <dime/records/Record.h>
+#include <dime/Model.h>
+#include "Diagnostic.h"
 
 /*!
   Constructor. \a separator is the group code that will separate objects,
@@ -143,7 +145,7 @@ DimeRecordHolder::read(DimeInput* const file)
 		ok = DimeRecord::readRecordData(file, groupcode, param);
 		if (!ok)
 		{
-			fprintf(stderr, "Unable to read record data for groupcode: %d\n", groupcode);
+			dime_diagnostic("Unable to read record data for groupcode: %d\n", groupcode);
 			//	sim_warning("Unable to read record data for groupcode: %d\n",
 			//		    groupcode);
 			break;
@@ -153,7 +155,7 @@ DimeRecordHolder::read(DimeInput* const file)
 			record = DimeRecord::createRecord(groupcode, param);
 			if (!record)
 			{
-				fprintf(stderr, "Could not create record for group code: %d\n", groupcode);
+				dime_diagnostic("Could not create record for group code: %d\n", groupcode);
 				//	  sim_warning("could not create record for group code: %d\n",
 				//		      groupcode);
 				ok = false;
@@ -307,13 +309,13 @@ DimeRecordHolder::setRecords(const int* const groupcodes,
 
 		if (groupcode == 8)
 		{
-			fprintf(stderr, "Cannot set layer name in setRecords()!\n");
+			dime_diagnostic("Cannot set layer name in setRecords()!\n");
 			//      sim_warning("Cannot set layer name in setRecords()!\n");
 			assert(0);
 		}
 		else if (groupcode == 2 && this->typeId() == DimeBase::dimeInsertType)
 		{
-			fprintf(stderr, "Cannot set block name for INSERT entities using setRecords()\n");
+			dime_diagnostic("Cannot set block name for INSERT entities using setRecords()\n");
 			//      sim_warning("Cannot set block name for INSERT entities using setRecords()\n");
 			assert(0);
 		}
@@ -332,6 +334,7 @@ DimeRecordHolder::setRecords(const int* const groupcodes,
 			}
 		}
 	}
+	this->recordsChanged();
 	if (newrecords.count())
 	{
 		// don't forget the old records...
@@ -367,6 +370,26 @@ DimeRecordHolder::countRecords() const
 	return this->numRecords;
 }
 
+/*!
+  Returns the number of bytes allocated for the records in the record
+  holder, and adds them to \e records and \e strings in \a usage.
+  Subclasses should overload this method, add the size of the object
+  itself and of the other memory it owns, and call the parent's method.
+  Entities owned by an entity are counted with
+  DimeEntity::countEntityMemory() instead, so they are attributed to
+  their own type.
+*/
+
+size_t
+DimeRecordHolder::countMemory(dimeMemoryUsage& usage) const
+{
+	size_t size = this->numRecords * sizeof(DimeRecord*);
+	usage.records += size;
+	for (int i = 0; i < this->numRecords; i++)
+		size += this->records[i]->countMemory(usage);
+	return size;
+}
+
 /*!  
   Returns the record with group code \a groupcode. If \a index > 0,
   the index'th record with group code \a groupcode will be
@@ -390,6 +413,16 @@ DimeRecordHolder::findRecord(const int groupcode, const int index)
 	return nullptr;
 }
 
+/*!
+  Called after records have been changed by setRecord(),
+  setIndexedRecord() or setRecords(), but not during read(). Default
+  method does nothing.
+*/
+void
+DimeRecordHolder::recordsChanged()
+{
+}
+
 /*!
   Can be overloaded by subclasses that want the record holder to
   store a record, but handle writing themselves. Default
@@ -408,13 +441,13 @@ DimeRecordHolder::setRecordCommon(const int groupcode, const dimeParam& param,
 	// some safety checks
 	if (groupcode == 8 && this->isOfType(DimeBase::dimeEntityType))
 	{
-		fprintf(stderr, "Cannot set layer name in setRecord()!\n");
+		dime_diagnostic("Cannot set layer name in setRecord()!\n");
 		assert(0);
 		return;
 	}
 	if (groupcode == 2 && this->typeId() == DimeBase::dimeInsertType)
 	{
-		fprintf(stderr, "Cannot set block name for INSERT entities using setRecord()\n");
+		dime_diagnostic("Cannot set block name for INSERT entities using setRecord()\n");
 		assert(0);
 		return;
 	}
@@ -428,7 +461,7 @@ DimeRecordHolder::setRecordCommon(const int groupcode, const dimeParam& param,
 			record = DimeRecord::createRecord(groupcode);
 			if (!record)
 			{
-				fprintf(stderr, "Could not create record for group code: %d\n", groupcode);
+				dime_diagnostic("Could not create record for group code: %d\n", groupcode);
 				return;
 			}
 			DimeRecord** newarray = ARRAY_NEW(DimeRecord*,
@@ -440,6 +473,7 @@ DimeRecordHolder::setRecordCommon(const int groupcode, const dimeParam& param,
 		}
 		record->setValue(param);
 	}
+	this->recordsChanged();
 }
 
 /*!
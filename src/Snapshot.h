@@ -0,0 +1,94 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#ifndef DIME_SNAPSHOT_H
+#define DIME_SNAPSHOT_H
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//
+// Layout of the files written by DimeModel::saveSnapshot():
+//
+//   dimeSnapshotHeader
+//   string table: numStrings null-terminated strings, stringsSize bytes
+//   record stream: streamSize bytes
+//
+// The record stream is the model written through DimeOutput, with each
+// group code stored as an int16_t and each value as a type tag byte
+// followed by the value in native byte order. Strings are stored as a
+// uint32_t index into the string table, so each distinct string is only
+// stored once.
+//
+
+#define DIME_SNAPSHOT_MAGIC "DIMESNAP"
+#define DIME_SNAPSHOT_VERSION 1
+#define DIME_SNAPSHOT_BYTEORDER 0x01020304
+
+enum
+{
+	DIME_SNAPSHOT_INT8 = 1,
+	DIME_SNAPSHOT_INT16,
+	DIME_SNAPSHOT_INT32,
+	DIME_SNAPSHOT_FLOAT,
+	DIME_SNAPSHOT_DOUBLE,
+	DIME_SNAPSHOT_STRING
+};
+
+struct dimeSnapshotHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t byteorder;
+	int32_t largestHandle;
+	uint32_t numStrings;
+	uint64_t stringsSize;
+	uint64_t streamSize;
+};
+
+struct dimeSnapshotStrings
+{
+	std::unordered_map<std::string, uint32_t> map;
+	std::vector<char> blob;
+
+	uint32_t intern(const char* str)
+	{
+		auto res = this->map.emplace(str, static_cast<uint32_t>(this->map.size()));
+		if (res.second) this->blob.insert(this->blob.end(), str, str + strlen(str) + 1);
+		return res.first->second;
+	}
+};
+
+#endif // ! DIME_SNAPSHOT_H
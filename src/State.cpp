@@ -36,6 +36,14 @@
   model is traversed.
 */
 
+/*!
+  \fn const DimeInsert* DimeState::getRootInsert() const
+  Returns the outermost INSERT entity being exploded, or \c NULL if
+  the current entity is not part of a block. Unlike getCurrentInsert(),
+  this is always an entity in the ENTITIES section (or in the block
+  being traversed).
+*/
+
 #include <dime/State.h>
 
 /*!
@@ -48,6 +56,7 @@ DimeState::DimeState(const bool traversePolylineVertices,
 	this->matrix.makeIdentity();
 	this->invmatrix.makeIdentity();
 	this->currentInsert = nullptr;
+	this->rootInsert = nullptr;
 	this->flags = 0;
 	if (traversePolylineVertices)
 	{
@@ -69,6 +78,7 @@ DimeState::DimeState(const DimeState& st)
 	this->invmatrix = st.invmatrix;
 	this->flags = st.flags;
 	this->currentInsert = st.currentInsert;
+	this->rootInsert = st.rootInsert;
 }
 
 void
@@ -0,0 +1,335 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*!
+  \class DimeStats dime/Stats.h
+  \brief The DimeStats class collects statistics about reading,
+  writing and converting DXF files.
+
+  Attach a DimeStats object to a DimeModel, DimeInput, DimeOutput or
+  dxfConverter with setStats(), and query it after the run. The same
+  object can be attached to several of them, and the counters add up.
+  Counting uses relaxed atomic increments, and nothing is counted when
+  no DimeStats is attached, so statistics can be left on in production.
+  The library can be built with DIME_STATS set to 0 to remove the
+  counters completely, in which case isEnabled() returns \e false and
+  all counters stay 0.
+
+  \code
+  DimeStats stats;
+  DimeModel model;
+  model.setStats(&stats);
+  model.read(&in);
+  stats.print(stderr);
+  \endcode
+*/
+
+#include <dime/Stats.h>
+#include "StatsData.h"
+
+//
+// returns the name of an entity or record type, for print()
+//
+
+static const char*
+type_name(const int type)
+{
+	switch (type)
+	{
+	case DimeBase::dimeStringRecordType: return "string";
+	case DimeBase::dimeFloatRecordType: return "float";
+	case DimeBase::dimeDoubleRecordType: return "double";
+	case DimeBase::dimeInt8RecordType: return "int8";
+	case DimeBase::dimeInt16RecordType: return "int16";
+	case DimeBase::dimeInt32RecordType: return "int32";
+	case DimeBase::dimeHexRecordType: return "hex";
+	case DimeBase::dimeUnknownEntityType: return "unknown";
+	case DimeBase::dimePolylineType: return "POLYLINE";
+	case DimeBase::dimeVertexType: return "VERTEX";
+	case DimeBase::dime3DFaceType: return "3DFACE";
+	case DimeBase::dimeSolidType: return "SOLID";
+	case DimeBase::dimeTraceType: return "TRACE";
+	case DimeBase::dimeLineType: return "LINE";
+	case DimeBase::dimeTextType: return "TEXT";
+	case DimeBase::dimePointType: return "POINT";
+	case DimeBase::dimeBlockType: return "BLOCK";
+	case DimeBase::dimeInsertType: return "INSERT";
+	case DimeBase::dimeCircleType: return "CIRCLE";
+	case DimeBase::dimeArcType: return "ARC";
+	case DimeBase::dimeLWPolylineType: return "LWPOLYLINE";
+	case DimeBase::dimeEllipseType: return "ELLIPSE";
+	case DimeBase::dimeSplineType: return "SPLINE";
+	case DimeBase::dimeEndBlockType: return "ENDBLK";
+	default: return "other";
+	}
+}
+
+static const char* const sectionnames[DimeStats::NUM_SECTIONS] =
+{
+	"HEADER", "CLASSES", "TABLES", "BLOCKS", "ENTITIES", "OBJECTS", "other"
+};
+
+/*!
+  Constructor. All counters start at 0.
+*/
+
+DimeStats::DimeStats()
+	: data(new dimeStatsData)
+{
+	this->reset();
+}
+
+/*!
+  Destructor.
+*/
+
+DimeStats::~DimeStats()
+{
+	delete this->data;
+}
+
+/*!
+  Returns \e false if the library was built without statistics.
+*/
+
+bool
+DimeStats::isEnabled()
+{
+	return DIME_STATS != 0;
+}
+
+/*!
+  Sets all counters to 0. Should not be called while the object is
+  being updated.
+*/
+
+void
+DimeStats::reset()
+{
+	int i;
+	for (i = 0; i < NUM_SECTIONS; i++)
+	{
+		this->data->sectionNanos[i] = 0;
+		this->data->sectionBytes[i] = 0;
+	}
+	for (i = 0; i < DimeBase::dimeLastTypeTag; i++)
+	{
+		this->data->records[i] = 0;
+		this->data->entities[i] = 0;
+		this->data->vertices[i] = 0;
+	}
+	this->data->dictLookups = 0;
+	this->data->dictCollisions = 0;
+	this->data->bspInserts = 0;
+	this->data->bspSplits = 0;
+	this->data->bytesWritten = 0;
+	this->data->writeNanos = 0;
+}
+
+/*!
+  Returns the wall time in seconds spent reading \a section in
+  DimeModel::read().
+*/
+
+double
+DimeStats::getSectionTime(const Section section) const
+{
+	return this->data->sectionNanos[section] * 1e-9;
+}
+
+/*!
+  Returns the number of bytes of \a section read by DimeModel::read().
+  Not counted for snapshots.
+*/
+
+uint64_t
+DimeStats::getSectionBytes(const Section section) const
+{
+	return this->data->sectionBytes[section];
+}
+
+/*!
+  Returns the number of records of \a recordtype read, where
+  \a recordtype is one of the record types in DimeBase, such as
+  DimeBase::dimeDoubleRecordType.
+*/
+
+uint64_t
+DimeStats::getNumRecords(const int recordtype) const
+{
+	if (recordtype < 0 || recordtype >= DimeBase::dimeLastTypeTag) return 0;
+	return this->data->records[recordtype];
+}
+
+/*!
+  Returns the number of entities of \a entitytype read, where
+  \a entitytype is an entity type in DimeBase, such as
+  DimeBase::dimeLineType.
+*/
+
+uint64_t
+DimeStats::getNumEntities(const int entitytype) const
+{
+	if (entitytype < 0 || entitytype >= DimeBase::dimeLastTypeTag) return 0;
+	return this->data->entities[entitytype];
+}
+
+/*!
+  Returns the number of lookups in the dictionaries of the model.
+*/
+
+uint64_t
+DimeStats::getNumDictLookups() const
+{
+	return this->data->dictLookups;
+}
+
+/*!
+  Returns the number of other keys compared against during dictionary
+  lookups, i.e. the cost of hash collisions.
+*/
+
+uint64_t
+DimeStats::getNumDictCollisions() const
+{
+	return this->data->dictCollisions;
+}
+
+/*!
+  Returns the number of points added to the BSP trees used by
+  dxfConverter to merge vertices.
+*/
+
+uint64_t
+DimeStats::getNumBSPInserts() const
+{
+	return this->data->bspInserts;
+}
+
+/*!
+  Returns the number of BSP tree node splits.
+*/
+
+uint64_t
+DimeStats::getNumBSPSplits() const
+{
+	return this->data->bspSplits;
+}
+
+/*!
+  Returns the number of vertex indices dxfConverter produced for
+  entities of \a entitytype. Entities in blocks are counted once for
+  each time they are inserted. Polygon and line strip end markers
+  are included.
+*/
+
+uint64_t
+DimeStats::getNumTessellatedVertices(const int entitytype) const
+{
+	if (entitytype < 0 || entitytype >= DimeBase::dimeLastTypeTag) return 0;
+	return this->data->vertices[entitytype];
+}
+
+/*!
+  Returns the number of bytes written by DimeOutput.
+*/
+
+uint64_t
+DimeStats::getBytesWritten() const
+{
+	return this->data->bytesWritten;
+}
+
+/*!
+  Returns the wall time in seconds spent in DimeModel::write().
+*/
+
+double
+DimeStats::getWriteTime() const
+{
+	return this->data->writeNanos * 1e-9;
+}
+
+/*!
+  Prints all non-zero counters to \a fp.
+*/
+
+void
+DimeStats::print(FILE* const fp) const
+{
+	int i;
+	for (i = 0; i < NUM_SECTIONS; i++)
+	{
+		if (this->data->sectionNanos[i] == 0 && this->data->sectionBytes[i] == 0) continue;
+		fprintf(fp, "section %-12s %10.4f s %14llu bytes\n", sectionnames[i],
+		        this->getSectionTime(static_cast<Section>(i)),
+		        static_cast<unsigned long long>(this->data->sectionBytes[i]));
+	}
+	for (i = 0; i < DimeBase::dimeLastTypeTag; i++)
+	{
+		if (this->data->records[i])
+			fprintf(fp, "records %-12s %14llu\n", type_name(i),
+			        static_cast<unsigned long long>(this->data->records[i]));
+	}
+	for (i = 0; i < DimeBase::dimeLastTypeTag; i++)
+	{
+		if (this->data->entities[i])
+			fprintf(fp, "entities %-11s %14llu\n", type_name(i),
+			        static_cast<unsigned long long>(this->data->entities[i]));
+	}
+	for (i = 0; i < DimeBase::dimeLastTypeTag; i++)
+	{
+		if (this->data->vertices[i])
+			fprintf(fp, "vertices %-11s %14llu\n", type_name(i),
+			        static_cast<unsigned long long>(this->data->vertices[i]));
+	}
+	fprintf(fp, "dict lookups %21llu\n", static_cast<unsigned long long>(this->getNumDictLookups()));
+	fprintf(fp, "dict collisions %18llu\n", static_cast<unsigned long long>(this->getNumDictCollisions()));
+	fprintf(fp, "bsp inserts %22llu\n", static_cast<unsigned long long>(this->getNumBSPInserts()));
+	fprintf(fp, "bsp splits %23llu\n", static_cast<unsigned long long>(this->getNumBSPSplits()));
+	fprintf(fp, "bytes written %20llu\n", static_cast<unsigned long long>(this->getBytesWritten()));
+	fprintf(fp, "write time %21.4f s\n", this->getWriteTime());
+}
+
+/*!
+  Returns the section a section name is counted as.
+*/
+
+DimeStats::Section
+DimeStats::getSection(const char* const sectionname)
+{
+	for (int i = 0; i < OTHER; i++)
+	{
+		if (!strcmp(sectionname, sectionnames[i])) return static_cast<Section>(i);
+	}
+	return OTHER;
+}
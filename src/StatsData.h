@@ -0,0 +1,83 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#ifndef DIME_STATSDATA_H
+#define DIME_STATSDATA_H
+
+#include <dime/Stats.h>
+#include <dime/Base.h>
+#include <atomic>
+
+//
+// Set DIME_STATS to 0 to compile out all statistics collection. The
+// counters are relaxed atomics, since only the totals are of interest.
+//
+
+#ifndef DIME_STATS
+#define DIME_STATS 1
+#endif
+
+struct dimeStatsData
+{
+	std::atomic<uint64_t> sectionNanos[DimeStats::NUM_SECTIONS];
+	std::atomic<uint64_t> sectionBytes[DimeStats::NUM_SECTIONS];
+	std::atomic<uint64_t> records[DimeBase::dimeLastTypeTag];
+	std::atomic<uint64_t> entities[DimeBase::dimeLastTypeTag];
+	std::atomic<uint64_t> vertices[DimeBase::dimeLastTypeTag];
+	std::atomic<uint64_t> dictLookups;
+	std::atomic<uint64_t> dictCollisions;
+	std::atomic<uint64_t> bspInserts;
+	std::atomic<uint64_t> bspSplits;
+	std::atomic<uint64_t> bytesWritten;
+	std::atomic<uint64_t> writeNanos;
+
+	static dimeStatsData* get(DimeStats* stats)
+	{
+#if DIME_STATS
+		return stats ? stats->data : nullptr;
+#else
+		return nullptr;
+#endif
+	}
+
+	static void add(std::atomic<uint64_t>& counter, const uint64_t num)
+	{
+		counter.fetch_add(num, std::memory_order_relaxed);
+	}
+
+	static void addType(std::atomic<uint64_t>* counters, const int type, const uint64_t num)
+	{
+		if (type >= 0 && type < DimeBase::dimeLastTypeTag) add(counters[type], num);
+	}
+};
+
+#endif // ! DIME_STATSDATA_H
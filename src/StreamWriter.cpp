@@ -0,0 +1,471 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*!
+  \class DimeStreamWriter dime/StreamWriter.h
+  \brief The DimeStreamWriter class writes DXF files entity by entity.
+
+  Use this class instead of DimeModel::write() when the entities are
+  generated on the fly and there are too many of them to keep in a
+  DimeModel. begin() writes everything up to the ENTITIES section
+  (typically the HEADER, TABLES and BLOCKS sections of a model
+  holding layers and block definitions), after which entities are
+  appended directly to the output with writeEntity() or one of the
+  convenience methods. end() closes the ENTITIES section, writes the
+  remaining sections of the model, and finally updates the $HANDSEED
+  header variable.
+
+  Each streamed entity gets a new handle. Since the handle seed is
+  not known until the last entity has been written, a fixed width
+  placeholder is written in the header and patched in end(). If the
+  output is not seekable (a pipe, for instance), the placeholder will
+  contain the largest possible handle instead.
+
+  \code
+  DimeOutput out;
+  out.setFilename("points.dxf");
+  DimeStreamWriter writer(&out);
+  writer.begin(&model); // model contains HEADER and TABLES only
+  for (int i = 0; i < numpoints; i++) {
+    writer.writePoint(points[i], "POINTS");
+  }
+  writer.end();
+  \endcode
+*/
+
+#include <dime/StreamWriter.h>
+#include <dime/Model.h>
+#include <dime/Output.h>
+#include <dime/entities/Entity.h>
+#include <dime/records/Record.h>
+#include <dime/sections/HeaderSection.h>
+#include <dime/sections/EntitiesSection.h>
+#include "Diagnostic.h"
+#include <string.h>
+
+#define HANDSEED_PLACEHOLDER "7fffffff"
+
+/*!
+  Constructor. The writer will write to \a out, which should be ready
+  for writing. The writer does not take ownership of \a out.
+*/
+
+DimeStreamWriter::DimeStreamWriter(DimeOutput* const out)
+	: out(out), model(nullptr), sectionIdx(0), numEntities(0), handle(0),
+	  handleSeedPos(-1), handleSeedPatched(false), active(false), ok(true)
+{
+}
+
+/*!
+  Destructor. Calls end() if the stream is still open.
+*/
+
+DimeStreamWriter::~DimeStreamWriter()
+{
+	if (this->active) this->end();
+}
+
+/*!
+  Writes all sections of \a model preceding the ENTITIES section and
+  opens the ENTITIES section for streaming. If \a model has an
+  ENTITIES section, the entities in it are written first. \a model is
+  not modified, except for its handle counter, and must stay alive
+  until end() has been called.
+
+  If \a model is \c NULL, a minimal HEADER section containing only the
+  $HANDSEED variable is written.
+*/
+
+bool
+DimeStreamWriter::begin(DimeModel* const model)
+{
+	dimeDiagnosticScope scope(model);
+	if (this->active)
+	{
+		dime_diagnostic("DimeStreamWriter::begin() called twice.\n");
+		return false;
+	}
+	this->model = model;
+	this->numEntities = 0;
+	this->handleSeedPos = -1;
+	this->handleSeedPatched = false;
+	this->handle = model ? model->largestHandle : 0;
+	this->active = true;
+	this->ok = true;
+
+	DimeEntitiesSection* entities = nullptr;
+	if (model)
+	{
+		int i, n = model->headerComments.count();
+		for (i = 0; i < n; i++)
+		{
+			model->headerComments[i]->write(this->out);
+		}
+		n = model->sections.count();
+		for (i = 0; i < n; i++)
+		{
+			DimeSection* section = model->sections[i];
+			if (section->typeId() == DimeBase::dimeEntitiesSectionType)
+			{
+				entities = static_cast<DimeEntitiesSection*>(section);
+				i++;
+				break;
+			}
+			if (section->typeId() == DimeBase::dimeObjectsSectionType) break;
+			if (section->typeId() == DimeBase::dimeHeaderSectionType)
+			{
+				this->ok = this->writeHeader() && this->ok;
+			}
+			else
+			{
+				this->out->writeGroupCode(0);
+				this->out->writeString("SECTION");
+				this->ok = section->write(this->out) && this->ok;
+			}
+		}
+		this->sectionIdx = i;
+	}
+	else
+	{
+		this->ok = this->writeHeader();
+	}
+
+	this->out->writeGroupCode(0);
+	this->out->writeString("SECTION");
+	this->out->writeGroupCode(2);
+	this->ok = this->out->writeString("ENTITIES") && this->ok;
+
+	if (entities)
+	{
+		const int n = entities->getNumEntities();
+		for (int i = 0; i < n; i++)
+		{
+			this->ok = entities->getEntity(i)->write(this->out) && this->ok;
+		}
+	}
+	return this->ok;
+}
+
+/*!
+  Writes \a entity to the ENTITIES section. A new handle is assigned
+  to the entity before writing, replacing any handle it already has.
+  The entity is not stored, and can be modified and written again
+  as a new entity.
+*/
+
+bool
+DimeStreamWriter::writeEntity(DimeEntity* const entity)
+{
+	dimeDiagnosticScope scope(this->model);
+	if (!this->active) return false;
+	char buf[16];
+	sprintf(buf, "%x", this->nextHandle());
+	dimeParam param;
+	param.string_data = buf;
+	entity->setRecord(5, param);
+	this->numEntities++;
+	this->ok = entity->write(this->out) && this->ok;
+	return this->ok;
+}
+
+/*!
+  \overload
+
+  Writes an entity named \a entityname without creating a DimeEntity.
+  The handle, layer and color number records are written first,
+  followed by the \a numrecords records in \a groupcodes and \a params.
+  The type of each value in \a params is decided by its group code.
+  The color number is only written if \a colnum is not 256 (BYLAYER).
+*/
+
+bool
+DimeStreamWriter::writeEntity(const char* const entityname,
+                              const int* const groupcodes,
+                              const dimeParam* const params,
+                              const int numrecords,
+                              const char* const layername,
+                              const int16_t colnum)
+{
+	if (!this->writeCommon(entityname, layername, colnum)) return false;
+
+	for (int i = 0; i < numrecords; i++)
+	{
+		this->out->writeGroupCode(groupcodes[i]);
+		bool ret = true;
+		switch (DimeRecord::getRecordType(groupcodes[i]))
+		{
+		case DimeBase::dimeInt8RecordType:
+			ret = this->out->writeInt8(params[i].int8_data);
+			break;
+		case DimeBase::dimeInt16RecordType:
+			ret = this->out->writeInt16(params[i].int16_data);
+			break;
+		case DimeBase::dimeInt32RecordType:
+			ret = this->out->writeInt32(params[i].int32_data);
+			break;
+		case DimeBase::dimeFloatRecordType:
+			ret = this->out->writeFloat(params[i].float_data);
+			break;
+		case DimeBase::dimeDoubleRecordType:
+			ret = this->out->writeDouble(params[i].double_data);
+			break;
+		case DimeBase::dimeHexRecordType:
+			ret = this->out->writeString(params[i].hex_data);
+			break;
+		default:
+			ret = this->out->writeString(params[i].string_data);
+			break;
+		}
+		this->ok = ret && this->ok;
+	}
+	return this->ok;
+}
+
+/*!
+  Writes a POINT entity at \a p.
+*/
+
+bool
+DimeStreamWriter::writePoint(const dimeVec3& p,
+                             const char* const layername,
+                             const int16_t colnum)
+{
+	return this->writeCommon("POINT", layername, colnum) &&
+		this->writeCoords(10, p);
+}
+
+/*!
+  Writes a LINE entity from \a p0 to \a p1.
+*/
+
+bool
+DimeStreamWriter::writeLine(const dimeVec3& p0, const dimeVec3& p1,
+                            const char* const layername,
+                            const int16_t colnum)
+{
+	return this->writeCommon("LINE", layername, colnum) &&
+		this->writeCoords(10, p0) &&
+		this->writeCoords(11, p1);
+}
+
+/*!
+  Writes a 3DFACE entity. Set \a p3 equal to \a p2 for a triangle.
+*/
+
+bool
+DimeStreamWriter::write3DFace(const dimeVec3& p0, const dimeVec3& p1,
+                              const dimeVec3& p2, const dimeVec3& p3,
+                              const char* const layername,
+                              const int16_t colnum)
+{
+	return this->writeCommon("3DFACE", layername, colnum) &&
+		this->writeCoords(10, p0) &&
+		this->writeCoords(11, p1) &&
+		this->writeCoords(12, p2) &&
+		this->writeCoords(13, p3);
+}
+
+/*!
+  Closes the ENTITIES section, writes the model sections following it
+  and the end of file marker, and patches the $HANDSEED header
+  variable. Returns \e false if any write failed.
+*/
+
+bool
+DimeStreamWriter::end()
+{
+	dimeDiagnosticScope scope(this->model);
+	if (!this->active) return false;
+	this->active = false;
+
+	this->out->writeGroupCode(0);
+	this->ok = this->out->writeString("ENDSEC") && this->ok;
+
+	if (this->model)
+	{
+		const int n = this->model->sections.count();
+		for (int i = this->sectionIdx; i < n; i++)
+		{
+			DimeSection* section = this->model->sections[i];
+			if (section->typeId() == DimeBase::dimeEntitiesSectionType) continue;
+			this->out->writeGroupCode(0);
+			this->out->writeString("SECTION");
+			this->ok = section->write(this->out) && this->ok;
+		}
+		this->model->registerHandle(this->handle);
+	}
+	this->out->writeGroupCode(0);
+	this->ok = this->out->writeString("EOF") && this->ok;
+	this->ok = this->out->finish() && this->ok;
+
+	FILE* fp = this->out->fp;
+	if (this->handleSeedPos >= 0)
+	{
+		const long endpos = ftell(fp);
+		if (endpos >= 0 && fseek(fp, this->handleSeedPos, SEEK_SET) == 0)
+		{
+			this->handleSeedPatched =
+				fprintf(fp, "%08x", this->handle + 1) == int(strlen(HANDSEED_PLACEHOLDER));
+			fseek(fp, endpos, SEEK_SET);
+		}
+	}
+	this->ok = fflush(fp) == 0 && this->ok;
+	return this->ok;
+}
+
+/*!
+  Returns the number of entities written since begin(), not counting
+  the entities already present in the model.
+*/
+
+int
+DimeStreamWriter::getNumEntities() const
+{
+	return this->numEntities;
+}
+
+/*!
+  Returns \e true if the $HANDSEED variable was updated by end(). This
+  fails if the output is not seekable or is compressed, or if the
+  header had no $HANDSEED variable.
+*/
+
+bool
+DimeStreamWriter::isHandleSeedPatched() const
+{
+	return this->handleSeedPatched;
+}
+
+//
+// Writes the HEADER section, replacing the $HANDSEED value with a
+// placeholder and remembering its file position.
+//
+
+bool
+DimeStreamWriter::writeHeader()
+{
+	bool ret = this->out->writeGroupCode(0) && this->out->writeString("SECTION") &&
+		this->out->writeGroupCode(2) && this->out->writeString("HEADER");
+
+	DimeHeaderSection* hs = this->model ?
+		static_cast<DimeHeaderSection*>(this->model->findSection("HEADER")) : nullptr;
+	bool handseed = false;
+	if (hs)
+	{
+		const int n = hs->records.count();
+		for (int i = 0; i < n && ret; i++)
+		{
+			DimeRecord* record = hs->records[i];
+			if (handseed && record->getGroupCode() == 5)
+			{
+				this->out->writeGroupCode(5);
+				this->handleSeedPos = this->out->writer ? -1 : ftell(this->out->fp);
+				ret = this->out->writeString(HANDSEED_PLACEHOLDER);
+			}
+			else
+			{
+				ret = record->write(this->out);
+			}
+			dimeParam param;
+			record->getValue(param);
+			handseed = record->getGroupCode() == 9 &&
+				!strcmp(param.string_data, "$HANDSEED");
+		}
+	}
+	else
+	{
+		this->out->writeGroupCode(9);
+		this->out->writeString("$HANDSEED");
+		this->out->writeGroupCode(5);
+		this->handleSeedPos = this->out->writer ? -1 : ftell(this->out->fp);
+		ret = ret && this->out->writeString(HANDSEED_PLACEHOLDER);
+	}
+	this->out->writeGroupCode(0);
+	return this->out->writeString("ENDSEC") && ret;
+}
+
+//
+// Writes the entity name, a new handle, the layer name and the color
+// number.
+//
+
+bool
+DimeStreamWriter::writeCommon(const char* const entityname,
+                              const char* const layername,
+                              const int16_t colnum)
+{
+	if (!this->active) return false;
+	char buf[16];
+	sprintf(buf, "%x", this->nextHandle());
+	this->numEntities++;
+
+	this->out->writeGroupCode(0);
+	this->out->writeString(entityname);
+	this->out->writeGroupCode(5);
+	this->out->writeString(buf);
+	this->out->writeGroupCode(8);
+	bool ret = this->out->writeString(layername);
+	if (colnum != 256)
+	{
+		this->out->writeGroupCode(62);
+		ret = this->out->writeInt16(colnum);
+	}
+	this->ok = ret && this->ok;
+	return this->ok;
+}
+
+//
+// Writes a point using group codes groupcode, groupcode+10 and
+// groupcode+20.
+//
+
+bool
+DimeStreamWriter::writeCoords(const int groupcode, const dimeVec3& p)
+{
+	this->out->writeGroupCode(groupcode);
+	this->out->writeDouble(p.x);
+	this->out->writeGroupCode(groupcode + 10);
+	this->out->writeDouble(p.y);
+	this->out->writeGroupCode(groupcode + 20);
+	this->ok = this->out->writeDouble(p.z) && this->ok;
+	return this->ok;
+}
+
+//
+// Allocates a new handle.
+//
+
+int
+DimeStreamWriter::nextHandle()
+{
+	return ++this->handle;
+}
@@ -183,6 +183,18 @@ DimeClass::countRecords() const
 
 //!
 
+size_t
+DimeClass::countMemory(dimeMemoryUsage& usage) const
+{
+	size_t size = 0;
+	if (this->className) size += strlen(this->className) + 1;
+	if (this->appName) size += strlen(this->appName) + 1;
+	usage.strings += size;
+	return size + DimeRecordHolder::countMemory(usage);
+}
+
+//!
+
 bool
 DimeClass::isOfType(const int thetypeid) const
 {
@@ -103,6 +103,21 @@ dimeUnknownClass::countRecords() const
 
 //!
 
+size_t
+dimeUnknownClass::countMemory(dimeMemoryUsage& usage) const
+{
+	size_t size = sizeof(dimeUnknownClass);
+	if (this->dxfClassName)
+	{
+		const size_t len = strlen(this->dxfClassName) + 1;
+		usage.strings += len;
+		size += len;
+	}
+	return size + DimeClass::countMemory(usage);
+}
+
+//!
+
 const char*
 dimeUnknownClass::getDxfClassName() const
 {
@@ -31,32 +31,13 @@
 \**************************************************************************/
 
 #include "convert_funcs.h"
+#include "tessellation.h"
 #include <dime/convert/convert.h>
 #include <dime/convert/layerdata.h>
 #include <dime/entities/Arc.h>
 #include <dime/util/Linear.h>
 #include <dime/State.h>
-
-//
-// find intersection between circle and the line x=r-maxerr,
-// and return the number of circle subdivisions necessary
-// to respect the maxerr parameter.
-//
-static int
-calc_num_sub(dxfdouble maxerr, dxfdouble radius)
-{
-	radius = fabs(radius);
-
-	if (maxerr >= radius || maxerr <= 0.0) maxerr = radius / 40.0f;
-
-	dxfdouble x = radius - maxerr;
-	dxfdouble y = sqrt(radius * radius - x * x);
-
-	dxfdouble rad = atan(y / x);
-
-	return static_cast<int>(M_PI / fabs(rad)) + 1;
-}
-
+#include "../Diagnostic.h"
 
 void
 convert_arc(const DimeEntity* entity, const DimeState* state,
@@ -101,17 +82,19 @@ convert_arc(const DimeEntity* entity, const DimeState* state,
 	if (delta == 0.0)
 	{
 #ifndef NDEBUG
-		fprintf(stderr, "ARC with startAngle == endAngle!\n");
+		dime_diagnostic("ARC with startAngle == endAngle!\n");
 #endif
 		end += 2 * M_PI;
 		delta = DXFDEG2RAD(end - arc->getStartAngle());
 	}
 
+	dxfTessellationCache* cache = converter->getTessellationCache();
+
 	int ARC_NUMPTS = converter->getNumSub();
 	if (ARC_NUMPTS <= 0)
 	{
 		// use maxerr
-		ARC_NUMPTS = calc_num_sub(converter->getMaxerr(), radius);
+		ARC_NUMPTS = cache->getCircleNumSub(converter->getMaxerr(), radius);
 	}
 
 	// find the number of this ARC that fits inside 2PI
@@ -122,44 +105,54 @@ convert_arc(const DimeEntity* entity, const DimeState* state,
 	int numpts = ARC_NUMPTS / parts + 1;
 	if (numpts > ARC_NUMPTS) numpts = ARC_NUMPTS;
 
-	double inc = delta / numpts;
 	double rad = DXFDEG2RAD(arc->getStartAngle());
+	dimeArray<dimeVec3>& pts = cache->getScratch();
 	int i;
-
-	dimeVec3 v;
-	dimeVec3 prev(center[0] + radius * cos(rad),
-	               center[1] + radius * sin(rad),
-	               center[2]);
-	rad += inc;
-
-	for (i = 1; i < numpts; i++)
+	if (delta == 2 * M_PI)
 	{
-		v = dimeVec3(center[0] + radius * cos(rad),
-		              center[1] + radius * sin(rad),
-		              center[2]);
-		if (thickness == 0.0)
+		// rotate the cached unit circle to the start angle, and scale
+		// and translate it into place
+		const dxfUnitArcTable* table = cache->getUnitCircle(numpts);
+		const dxfdouble* ct = table->cosv.constArrayPointer();
+		const dxfdouble* st = table->sinv.constArrayPointer();
+		dxfdouble rc = radius * cos(rad);
+		dxfdouble rs = radius * sin(rad);
+		for (i = 0; i < numpts; i++)
 		{
-			layerData->addLine(prev, v, &matrix);
+			pts.append(dimeVec3(center[0] + rc * ct[i] - rs * st[i],
+			                    center[1] + rs * ct[i] + rc * st[i],
+			                    center[2]));
 		}
-		else
+	}
+	else
+	{
+		// the sweep of arcs rarely repeats, so a cached table would
+		// hardly ever be reused
+		double inc = delta / numpts;
+		for (i = 0; i < numpts; i++, rad += inc)
 		{
-			layerData->addQuad(prev, v, v + e * thickness, prev + e * thickness,
-			                   &matrix);
+			pts.append(dimeVec3(center[0] + radius * cos(rad),
+			                    center[1] + radius * sin(rad),
+			                    center[2]));
 		}
-		prev = v;
-		rad += inc;
 	}
 	rad = DXFDEG2RAD(end);
-	v = dimeVec3(center[0] + radius * cos(rad),
-	              center[1] + radius * sin(rad),
-	              center[2]);
+	pts.append(dimeVec3(center[0] + radius * cos(rad),
+	                    center[1] + radius * sin(rad),
+	                    center[2]));
+
+	const dimeVec3* v = pts.constArrayPointer();
 	if (thickness == 0.0)
 	{
-		layerData->addLine(prev, v, &matrix);
+		layerData->addLineStrip(v, numpts + 1, &matrix);
 	}
 	else
 	{
-		layerData->addQuad(prev, v, v + e * thickness, prev + e * thickness,
-		                   &matrix);
+		dimeVec3 t = e * thickness;
+		for (i = 0; i < numpts; i++)
+		{
+			layerData->addQuad(v[i], v[i + 1], v[i + 1] + t, v[i] + t,
+			                   &matrix);
+		}
 	}
 }
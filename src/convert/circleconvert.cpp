@@ -31,31 +31,13 @@
 \**************************************************************************/
 
 #include "convert_funcs.h"
+#include "tessellation.h"
 #include <dime/convert/convert.h>
 #include <dime/convert/layerdata.h>
 #include <dime/entities/Circle.h>
 #include <dime/util/Linear.h>
 #include <dime/State.h>
 
-//
-// find intersection between circle and the line x=r-maxerr,
-// and return the number of circle subdivisions necessary
-// to respect the maxerr parameter.
-//
-static int
-calc_num_sub(dxfdouble maxerr, dxfdouble radius)
-{
-	if (maxerr >= radius || maxerr <= 0.0) maxerr = radius / 40.0f;
-
-	dxfdouble x = radius - maxerr;
-	dxfdouble y = sqrt(radius * radius - x * x);
-
-	dxfdouble rad = atan(y / x);
-
-	return static_cast<int>(M_PI / fabs(rad)) + 1;
-}
-
-
 void
 convert_circle(const DimeEntity* entity, const DimeState* state,
                dxfLayerData* layerData, dxfConverter* converter)
@@ -85,52 +67,42 @@ convert_circle(const DimeEntity* entity, const DimeState* state,
 		center[2] = param.double_data;
 	}
 
+	dxfTessellationCache* cache = converter->getTessellationCache();
+
 	int numpts = converter->getNumSub();
 	if (numpts <= 0)
 	{
 		// use maxerr
-		numpts = calc_num_sub(converter->getMaxerr(), radius);
+		numpts = cache->getCircleNumSub(converter->getMaxerr(), radius);
 	}
-	dxfdouble inc = (2 * M_PI) / numpts;
-	dxfdouble rad = inc;
-	int i;
 
-	dimeVec3 v;
-	dimeVec3 prev(center[0] + radius,
-	               center[1],
-	               center[2]);
+	// the last sample of a full unit circle is exactly (1, 0), so the
+	// circle is closed in the same point it started
+	const dxfUnitArcTable* table = cache->getUnitCircle(numpts);
+	const dxfdouble* ct = table->cosv.constArrayPointer();
+	const dxfdouble* st = table->sinv.constArrayPointer();
 
-	for (i = 1; i < numpts; i++)
+	dimeArray<dimeVec3>& pts = cache->getScratch();
+	int i;
+	for (i = 0; i <= numpts; i++)
 	{
-		v = dimeVec3(center[0] + radius * cos(rad),
-		              center[1] + radius * sin(rad),
-		              center[2]);
-
-		if (thickness == 0.0)
-		{
-			layerData->addLine(prev, v, &matrix);
-		}
-		else
-		{
-			layerData->addQuad(prev, v, v + e, prev + e,
-			                   &matrix);
-		}
-		prev = v;
-		rad += inc;
+		pts.append(dimeVec3(center[0] + radius * ct[i],
+		                    center[1] + radius * st[i],
+		                    center[2]));
 	}
 
-	v = dimeVec3(center[0] + radius,
-	              center[1],
-	              center[2]);
-
+	const dimeVec3* v = pts.constArrayPointer();
 	if (thickness == 0.0)
 	{
-		layerData->addLine(prev, v, &matrix);
+		layerData->addLineStrip(v, numpts + 1, &matrix);
 	}
 	else
 	{
-		layerData->addQuad(prev, v, v + e, prev + e,
-		                   &matrix);
+		for (i = 0; i < numpts; i++)
+		{
+			layerData->addQuad(v[i], v[i + 1], v[i + 1] + e, v[i] + e,
+			                   &matrix);
+		}
 	}
 	// FIXME: code to close cylinder?
 }
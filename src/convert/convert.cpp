@@ -32,13 +32,122 @@
 
 #include <dime/convert/convert.h>
 #include <dime/convert/layerdata.h>
+#include <dime/convert/geometrysink.h>
+#include <dime/convert/vrmlwriter.h>
+#include <dime/convert/meshoptimizer.h>
 #include "convert_funcs.h"
+#include "tessellation.h"
+#include "../StatsData.h"
 
 #include <dime/entities/Insert.h>
+#include <dime/entities/Block.h>
+#include <dime/entities/Polyline.h>
+#include <dime/entities/Vertex.h>
+#include <dime/sections/BlocksSection.h>
+#include <dime/sections/EntitiesSection.h>
 #include <dime/sections/HeaderSection.h>
 #include <dime/Model.h>
 #include <dime/State.h>
 #include <dime/Layer.h>
+#include "../Diagnostic.h"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+	struct dxfGroupKey
+	{
+		const void* ptr;
+		int colidx;
+
+		bool operator==(const dxfGroupKey& other) const
+		{
+			return ptr == other.ptr && colidx == other.colidx;
+		}
+	};
+
+	struct dxfGroupKeyHash
+	{
+		size_t operator()(const dxfGroupKey& key) const
+		{
+			return std::hash<const void*>()(key.ptr) * 257 + key.colidx;
+		}
+	};
+
+	// returns true if entity, or one of its polyline vertices, is dirty
+	bool
+	entity_changed(DimeEntity* entity)
+	{
+		if (entity->isDirty()) return true;
+		if (entity->typeId() == DimeBase::dimePolylineType)
+		{
+			auto pline = static_cast<DimePolyline*>(entity);
+			int i, n = pline->getNumCoordVertices();
+			for (i = 0; i < n; i++)
+			{
+				if (pline->getCoordVertex(i)->isDirty()) return true;
+			}
+			n = pline->getNumIndexVertices();
+			for (i = 0; i < n; i++)
+			{
+				if (pline->getIndexVertex(i)->isDirty()) return true;
+			}
+		}
+		return false;
+	}
+
+	void
+	entity_clear_dirty(DimeEntity* entity)
+	{
+		entity->setDirty(false);
+		if (entity->typeId() == DimeBase::dimePolylineType)
+		{
+			auto pline = static_cast<DimePolyline*>(entity);
+			int i, n = pline->getNumCoordVertices();
+			for (i = 0; i < n; i++) pline->getCoordVertex(i)->setDirty(false);
+			n = pline->getNumIndexVertices();
+			for (i = 0; i < n; i++) pline->getIndexVertex(i)->setDirty(false);
+		}
+	}
+
+	// returns true if block, or any block it inserts, has changed
+	bool
+	block_changed(DimeBlock* block, std::unordered_map<const DimeBlock*, bool>& visited)
+	{
+		if (block == nullptr) return false;
+		auto res = visited.emplace(block, false); // recursive blocks are not changed
+		if (!res.second) return res.first->second;
+		bool changed = block->isDirty();
+		const int n = block->getNumEntities();
+		for (int i = 0; i < n && !changed; i++)
+		{
+			DimeEntity* entity = block->getEntity(i);
+			changed = entity_changed(entity) ||
+				(entity->typeId() == DimeBase::dimeInsertType &&
+					block_changed(static_cast<DimeInsert*>(entity)->getBlock(), visited));
+		}
+		visited[block] = changed;
+		return changed;
+	}
+}
+
+//
+// the layer data for the non-color group modes, and the entity ID table
+//
+struct dxfGroupTable
+{
+	std::unordered_map<dxfGroupKey, dxfLayerData*, dxfGroupKeyHash> map;
+	std::vector<dxfLayerData*> list;
+	std::vector<const DimeEntity*> entities;
+	// the following are only used in incremental mode
+	std::unordered_map<const DimeEntity*, int> ids;
+	std::vector<dxfLayerData*> entitylayer;
+	std::vector<bool> entitymulti;
+	bool converted = false;
+};
 
 
 /*!
@@ -86,6 +195,168 @@
   Returns whether polylines with width and SOLID and TRACE should be filled.
 */
 
+/*!
+  \fn void dxfConverter::setFillPolygons(const bool fill)
+  Sets whether closed polylines without width should be triangulated
+  and filled. This is off by default, since AutoCAD only draws the
+  outline of such polylines. Filling also requires the fill mode to be
+  set.
+
+  \sa dxfConverter::setFillmode()
+*/
+
+/*!
+  \fn bool dxfConverter::getFillPolygons() const
+  Returns whether closed polylines without width should be filled.
+*/
+
+/*!
+  \fn void dxfConverter::setStitchLines(const bool stitch)
+  Sets whether the line segments of each layer should be joined into
+  as few line strips as possible after conversion. Default value is
+  \c FALSE.
+
+  \sa dxfLayerData::stitchLines()
+*/
+
+/*!
+  \fn bool dxfConverter::getStitchLines() const
+  Returns whether line segments are joined into long line strips.
+*/
+
+/*!
+  \enum dxfConverter::OriginMode
+  Specifies how the origin for the converted geometry is found.
+  With any mode except \c ORIGIN_NONE, vertices are stored as single
+  precision coordinates relative to the origin, which halves the
+  memory used for vertices and keeps full precision for drawings in
+  geographical coordinates. The origin is reported to
+  dxfGeometrySink::setOrigin().
+*/
+
+/*!
+  \var dxfConverter::OriginMode dxfConverter::ORIGIN_NONE
+  Vertices are stored in double precision, and are not rebased. This
+  is the default.
+*/
+
+/*!
+  \var dxfConverter::OriginMode dxfConverter::ORIGIN_FIRST_POINT
+  The origin is the first vertex of the first entity with geometry.
+*/
+
+/*!
+  \var dxfConverter::OriginMode dxfConverter::ORIGIN_EXTENTS
+  The origin is the center of the $EXTMIN and $EXTMAX header
+  variables. If these are missing or invalid, the first vertex is
+  used, like for \c ORIGIN_FIRST_POINT.
+*/
+
+/*!
+  \var dxfConverter::OriginMode dxfConverter::ORIGIN_CUSTOM
+  The origin set with setOrigin() is used.
+*/
+
+/*!
+  \fn void dxfConverter::setOriginMode(const OriginMode mode)
+  Sets how the origin for the vertices is found. Must be set before
+  doConvert() is called.
+*/
+
+/*!
+  \fn OriginMode dxfConverter::getOriginMode() const
+  Returns how the origin for the vertices is found.
+*/
+
+/*!
+  \fn void dxfConverter::setOrigin(const dimeVec3& origin)
+  Sets the origin for the vertices, and sets the origin mode to
+  \c ORIGIN_CUSTOM.
+*/
+
+/*!
+  \fn const dimeVec3& dxfConverter::getOrigin() const
+  Returns the origin of the vertices. Only valid after doConvert() has
+  been called, and when the origin mode is not \c ORIGIN_NONE.
+*/
+
+/*!
+  \enum dxfConverter::GroupMode
+  Specifies how the geometry is grouped into dxfLayerData instances.
+  The geometry is always grouped by color index too, since each
+  dxfLayerData has one color.
+*/
+
+/*!
+  \var dxfConverter::GroupMode dxfConverter::GROUP_BY_COLOR
+  Group by color index only. This is the default.
+*/
+
+/*!
+  \var dxfConverter::GroupMode dxfConverter::GROUP_BY_LAYER
+  Group by DXF layer. Entities on layer 0 in a block are put on the
+  layer of the INSERT, like AutoCAD does.
+*/
+
+/*!
+  \var dxfConverter::GroupMode dxfConverter::GROUP_BY_INSERT
+  Group by top level INSERT entity. Entities not in a block are grouped
+  together.
+*/
+
+/*!
+  \var dxfConverter::GroupMode dxfConverter::GROUP_BY_ENTITY
+  Group by top level entity. This creates a dxfLayerData for each
+  entity, and should only be used for small models. Use entity IDs to
+  pick entities in large models.
+*/
+
+/*!
+  \fn void dxfConverter::setGroupMode(const GroupMode mode)
+  Sets how geometry is grouped. Must be set before doConvert() is
+  called.
+
+  \sa getGroups(), dxfGeometrySink::setGroupInfo()
+*/
+
+/*!
+  \fn GroupMode dxfConverter::getGroupMode() const
+  Returns how geometry is grouped.
+*/
+
+/*!
+  \fn void dxfConverter::setIncremental(const bool onoff)
+  Sets whether the converter should remember which geometry each
+  entity created, so that updateConvert() can convert only the
+  entities that have changed. Must be set before doConvert() is
+  called. Default is \c FALSE.
+
+  Lines are not stitched in incremental mode, and the layer data is
+  not freed by writeVrml().
+
+  \sa updateConvert(), DimeEntity::isDirty()
+*/
+
+/*!
+  \fn bool dxfConverter::getIncremental() const
+  Returns whether incremental conversion is enabled.
+*/
+
+/*!
+  \fn void dxfConverter::setEntityIds(const bool onoff)
+  Sets whether the geometry should be tagged with the ID of the entity
+  it was created from. The ID is an index into a table of the top
+  level entities (an exploded INSERT has one ID), see getEntity().
+  Default is \c FALSE.
+
+  \sa dxfLayerData::faceentities, dxfGeometrySink::setEntityRanges()
+*/
+
+/*!
+  \fn bool dxfConverter::getEntityIds() const
+  Returns whether geometry is tagged with entity IDs.
+*/
+
 /*!
   \fn bool dxfConverter::getLayercol() const
   Returns whether only layers should be used (and not color index) when
@@ -104,6 +375,25 @@
   entity is current, the color index 7 (white) will be returned.
 */
 
+/*!
+  \fn dxfTessellationCache* dxfConverter::getTessellationCache() const
+  Returns the cache of unit circle tables used by the circle, arc and
+  ellipse converters. For internal use.
+*/
+
+/*!
+  \fn void dxfConverter::setStats(DimeStats* stats)
+  Sets the statistics object that counts the vertices produced per
+  entity type and the BSP tree operations used to merge them. Must be
+  set before converting. Set to \e nullptr (the default) to disable
+  counting.
+*/
+
+/*!
+  \fn DimeStats* dxfConverter::getStats() const
+  Returns the statistics object, or \e nullptr if none is set.
+*/
+
 
 /*!
   Constructor
@@ -113,9 +403,26 @@ dxfConverter::dxfConverter()
 	this->maxerr = 0.1f;
 	this->numsub = -1;
 	this->fillmode = true;
+	this->fillpolygons = false;
+	this->stitchlines = false;
 	this->layercol = false;
+	this->entityids = false;
+	this->incremental = false;
+	this->trackentities = false;
+	this->groupmode = GROUP_BY_COLOR;
+	this->groups = new dxfGroupTable;
+	this->currentEntityId = -1;
+	this->currentSource = nullptr;
+	this->currentLayer = nullptr;
+	this->originmode = ORIGIN_NONE;
+	this->origin.setValue(0.0, 0.0, 0.0);
+	this->hasextents = false;
+	this->extmin.setValue(0.0, 0.0, 0.0);
+	this->extmax.setValue(0.0, 0.0, 0.0);
 	this->currentInsertColorIndex = 7;
 	this->currentPolyline = nullptr;
+	this->tessCache = new dxfTessellationCache;
+	this->stats = nullptr;
 	for (int i = 0; i < 255; i++) layerData[i] = nullptr;
 }
 
@@ -124,23 +431,157 @@ dxfConverter::dxfConverter()
 */
 dxfConverter::~dxfConverter()
 {
+	this->clearGroups();
+	delete this->groups;
+	delete this->tessCache;
+}
+
+/*!
+  Returns the number of entities in the entity ID table.
+*/
+int
+dxfConverter::getNumEntities() const
+{
+	return static_cast<int>(this->groups->entities.size());
+}
+
+/*!
+  Returns the entity with ID \a id. This is an entity in the ENTITIES
+  section, e.g. the INSERT for geometry from a block. Returns \c NULL
+  if the entity has been removed by updateConvert().
+*/
+const DimeEntity*
+dxfConverter::getEntity(const int id) const
+{
+	assert(id >= 0 && id < this->getNumEntities());
+	return this->groups->entities[id];
+}
+
+/*!
+  Returns all dxfLayerData instances with geometry in \a groups. With
+  GROUP_BY_COLOR they are sorted by color index, otherwise they are in
+  the order they were created.
+*/
+void
+dxfConverter::getGroups(dimeArray<dxfLayerData*>& groups) const
+{
+	groups.makeEmpty();
 	for (int i = 0; i < 255; i++)
 	{
-		delete layerData[i];
+		if (this->layerData[i]) groups.append(this->layerData[i]);
+	}
+	for (dxfLayerData* ld : this->groups->list)
+	{
+		groups.append(ld);
 	}
 }
 
+//
+// deletes all dxfLayerData instances and the entity table
+//
+void
+dxfConverter::clearGroups()
+{
+	for (int i = 0; i < 255; i++)
+	{
+		delete this->layerData[i];
+		this->layerData[i] = nullptr;
+	}
+	for (dxfLayerData* ld : this->groups->list)
+	{
+		delete ld;
+	}
+	this->groups->list.clear();
+	this->groups->map.clear();
+	this->groups->entities.clear();
+	this->groups->ids.clear();
+	this->groups->entitylayer.clear();
+	this->groups->entitymulti.clear();
+	this->groups->converted = false;
+}
+
+//
+// returns the ID for a new source entity. In incremental mode, the
+// ID of a known entity is reused.
+//
+int
+dxfConverter::findEntityId(const DimeEntity* source)
+{
+	const int id = static_cast<int>(this->groups->entities.size());
+	if (this->incremental)
+	{
+		auto res = this->groups->ids.emplace(source, id);
+		if (!res.second) return res.first->second;
+		this->groups->entitylayer.push_back(nullptr);
+		this->groups->entitymulti.push_back(false);
+	}
+	this->groups->entities.push_back(source);
+	return id;
+}
+
 /*!
   Returns a dxfLayerData instance for the color with color index \a colidx.
+  If geometry is grouped by something else than color, the instance
+  for the current group is returned.
 */
 dxfLayerData*
 dxfConverter::getLayerData(const int colidx)
 {
 	assert(colidx >= 1 && colidx <= 255);
+	if (this->groupmode != GROUP_BY_COLOR)
+	{
+		const void* ptr = nullptr;
+		int entityid = -1;
+		const dimeLayer* layer = nullptr;
+		switch (this->groupmode)
+		{
+		case GROUP_BY_LAYER:
+			ptr = layer = this->currentLayer;
+			break;
+		case GROUP_BY_INSERT:
+			if (this->currentSource && this->currentSource->typeId() == DimeBase::dimeInsertType)
+			{
+				ptr = this->currentSource;
+				entityid = this->currentEntityId;
+				layer = this->currentLayer;
+			}
+			break;
+		default:
+			ptr = this->currentSource;
+			entityid = this->currentEntityId;
+			layer = this->currentLayer;
+			break;
+		}
+		dxfLayerData*& ld = this->groups->map[dxfGroupKey{ptr, colidx}];
+		if (ld == nullptr)
+		{
+			ld = new dxfLayerData(colidx);
+			ld->facebsp.setStats(this->stats);
+			ld->linebsp.setStats(this->stats);
+			ld->setGroup(layer, entityid);
+			if (this->originmode != ORIGIN_NONE) ld->setOrigin(this->origin);
+			this->groups->list.push_back(ld);
+		}
+		if (this->entityids || this->incremental) ld->setCurrentEntity(this->currentEntityId);
+		if (this->incremental) this->setEntityLayer(ld);
+		return ld;
+	}
+
 	if (layerData[colidx - 1] == nullptr)
 	{
 		layerData[colidx - 1] = new dxfLayerData(colidx);
+		layerData[colidx - 1]->facebsp.setStats(this->stats);
+		layerData[colidx - 1]->linebsp.setStats(this->stats);
+		if (this->originmode != ORIGIN_NONE)
+		{
+			layerData[colidx - 1]->setOrigin(this->origin);
+		}
+	}
+	if (this->entityids || this->incremental)
+	{
+		layerData[colidx - 1]->setCurrentEntity(this->currentEntityId);
 	}
+	if (this->incremental) this->setEntityLayer(layerData[colidx - 1]);
 	return layerData[colidx - 1];
 }
 
@@ -169,15 +610,18 @@ dxfConverter::getLayerData(const DimeEntity* entity)
 	if (colidx < 1 || colidx > 255)
 	{
 		// just in case
-		fprintf(stderr, "Illegal color number %d. Changed to 7 (white)\n",
-		        colidx);
+		dime_diagnostic("Illegal color number %d. Changed to 7 (white)\n",
+		                colidx);
 		colidx = 7;
 	}
 	return getLayerData(colidx);
 }
 
 /*!
-  Returns a pointer to the dxfLayerData array.
+  Returns a pointer to the dxfLayerData array. Only used with
+  GROUP_BY_COLOR.
+
+  \sa getGroups()
 */
 dxfLayerData**
 dxfConverter::getLayerData()
@@ -193,94 +637,327 @@ dxfConverter::getLayerData()
 bool
 dxfConverter::doConvert(DimeModel& model)
 {
+	dimeDiagnosticScope scope(&model);
+
 	//
 	// remove these 6 lines, and you may merge several dxf
 	// files into a single vrml file by calling doConvert() several
 	// times before calling writeVrml
 	//
-	for (int i = 0; i < 255; i++)
+	this->clearGroups();
+	this->findOrigin(model);
+	this->currentSource = nullptr;
+	this->currentLayer = nullptr;
+	this->currentEntityId = -1;
+	this->trackentities = this->entityids || this->incremental ||
+		this->groupmode == GROUP_BY_INSERT || this->groupmode == GROUP_BY_ENTITY;
+
+	dimeCallback cb = [this](DimeState const* state, DimeEntity* entity)
 	{
-		if (layerData[i])
+		return this->convertEntity(state, entity);
+	};
+
+	if (!model.traverseEntities(cb, false,
+	                            true, false)) return false;
+
+	if (this->incremental)
+	{
+		this->clearDirty(model);
+		this->groups->converted = true;
+	}
+	else if (this->stitchlines)
+	{
+		dimeArray<dxfLayerData*> groups;
+		this->getGroups(groups);
+		for (int i = 0; i < groups.count(); i++)
 		{
-			delete layerData[i];
-			layerData[i] = nullptr;
+			groups[i]->stitchLines();
 		}
 	}
+	return true;
+}
 
-	dimeCallback cb = [this](DimeState const* state, DimeEntity* entity)
+/*!
+  Converts the entities in \a model that have changed since the last
+  call to doConvert() or updateConvert(). Incremental mode must be
+  enabled with setIncremental(). The geometry from changed and removed
+  entities is removed, and changed and new entities are converted
+  again. An INSERT is converted again if its block, or any block
+  inserted in it, has changed. If nothing has been converted yet,
+  doConvert() is called.
+
+  Entities are changed when they are dirty, see DimeEntity::isDirty().
+  Changes to the HEADER and TABLES sections, e.g. layer colors, are
+  not detected. Call doConvert() after such changes.
+*/
+bool
+dxfConverter::updateConvert(DimeModel& model)
+{
+	dimeDiagnosticScope scope(&model);
+	if (!this->incremental || !this->groups->converted) return this->doConvert(model);
+
+	dxfGroupTable* table = this->groups;
+	auto es = static_cast<DimeEntitiesSection*>(model.findSection("ENTITIES"));
+	const int numentities = es ? es->getNumEntities() : 0;
+
+	//
+	// find the changed and new entities
+	//
+	std::unordered_map<const DimeBlock*, bool> blocks;
+	std::vector<bool> alive(table->entities.size(), false);
+	std::vector<DimeEntity*> changed;
+	std::vector<int> removed;
+	int i;
+	for (i = 0; i < numentities; i++)
 	{
-		if (entity->typeId() == DimeBase::dimePolylineType)
+		DimeEntity* entity = es->getEntity(i);
+		auto it = table->ids.find(entity);
+		if (it == table->ids.end())
 		{
-			this->currentPolyline = entity;
+			changed.push_back(entity);
+			continue;
 		}
+		alive[it->second] = true;
+		if (entity_changed(entity) ||
+			(entity->typeId() == DimeBase::dimeInsertType &&
+				block_changed(static_cast<DimeInsert*>(entity)->getBlock(), blocks)))
+		{
+			changed.push_back(entity);
+			removed.push_back(it->second);
+		}
+	}
+	const int numids = static_cast<int>(alive.size());
+	for (i = 0; i < numids; i++)
+	{
+		if (!alive[i] && table->entities[i])
+		{
+			table->ids.erase(table->entities[i]);
+			table->entities[i] = nullptr;
+			removed.push_back(i);
+		}
+	}
 
-		if (state->getCurrentInsert())
+	//
+	// remove the old geometry, one pass for each layer
+	//
+	std::unordered_map<dxfLayerData*, std::vector<int>> layerids;
+	dimeArray<dxfLayerData*> groups;
+	this->getGroups(groups);
+	for (int id : removed)
+	{
+		if (table->entitymulti[id])
 		{
-			this->currentInsertColorIndex =
-				getColorIndex((DimeEntity*)state->getCurrentInsert());
+			for (i = 0; i < groups.count(); i++) layerids[groups[i]].push_back(id);
 		}
-		else
+		else if (table->entitylayer[id])
 		{
-			this->currentInsertColorIndex = 7;
+			layerids[table->entitylayer[id]].push_back(id);
 		}
+		table->entitylayer[id] = nullptr;
+		table->entitymulti[id] = false;
+	}
+	for (auto& it : layerids)
+	{
+		std::vector<int>& ids = it.second;
+		std::sort(ids.begin(), ids.end());
+		ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+		it.first->removeEntities(ids.data(), static_cast<int>(ids.size()));
+	}
 
-		dxfLayerData* ld = getLayerData(entity);
+	//
+	// convert the changed entities
+	//
+	this->currentSource = nullptr;
+	this->currentLayer = nullptr;
+	this->currentEntityId = -1;
+	this->trackentities = true;
+	dimeCallback cb = [this](DimeState const* state, DimeEntity* entity)
+	{
+		return this->convertEntity(state, entity);
+	};
+	for (DimeEntity* entity : changed)
+	{
+		if (!DimeModel::traverseEntity(entity, cb, true, false)) return false;
+	}
+	this->clearDirty(model);
+	return true;
+}
 
-		// fillmode on by default. entities which will not fill its polygons
-		// should turn it off (layerData::addQuad() will create polygons,
-		// not lines)
-		//
-		ld->setFillmode(true);
+//
+// clears the dirty flag of all entities and blocks in model
+//
+void
+dxfConverter::clearDirty(DimeModel& model)
+{
+	int i, j, n;
+	auto es = static_cast<DimeEntitiesSection*>(model.findSection("ENTITIES"));
+	n = es ? es->getNumEntities() : 0;
+	for (i = 0; i < n; i++) entity_clear_dirty(es->getEntity(i));
+	auto bs = static_cast<DimeBlocksSection*>(model.findSection("BLOCKS"));
+	n = bs ? bs->getNumBlocks() : 0;
+	for (i = 0; i < n; i++)
+	{
+		DimeBlock* block = bs->getBlock(i);
+		block->setDirty(false);
+		const int m = block->getNumEntities();
+		for (j = 0; j < m; j++) entity_clear_dirty(block->getEntity(j));
+	}
+}
+
+//
+// remembers that the current entity has geometry in ld
+//
+void
+dxfConverter::setEntityLayer(dxfLayerData* ld)
+{
+	const int id = this->currentEntityId;
+	if (id < 0) return;
+	dxfLayerData*& entitylayer = this->groups->entitylayer[id];
+	if (entitylayer == nullptr) entitylayer = ld;
+	else if (entitylayer != ld) this->groups->entitymulti[id] = true;
+}
+
+//
+// converts a single entity. Called for each entity during traversal.
+//
+bool
+dxfConverter::convertEntity(const DimeState* state, DimeEntity* entity)
+{
+	if (entity->typeId() == DimeBase::dimePolylineType)
+	{
+		this->currentPolyline = entity;
+	}
 
-		switch (entity->typeId())
+	const DimeEntity* source = state->getRootInsert();
+	if (source == nullptr) source = entity;
+	if (this->trackentities && source != this->currentSource)
+	{
+		this->currentEntityId = this->findEntityId(source);
+	}
+	this->currentSource = source;
+	if (this->groupmode == GROUP_BY_LAYER)
+	{
+		// entities on layer 0 in blocks inherit the layer of the INSERT
+		this->currentLayer = entity->getLayer();
+		const DimeInsert* insert = state->getCurrentInsert();
+		if (insert && this->currentLayer && insert->getLayer() &&
+			strcmp(this->currentLayer->getLayerName(), "0") == 0)
 		{
-		case DimeBase::dime3DFaceType:
-			convert_3dface(entity, state, ld, this);
-			break;
-		case DimeBase::dimeSolidType:
-			convert_solid(entity, state, ld, this);
-			break;
-		case DimeBase::dimeTraceType:
-			convert_solid(entity, state, ld, this);
-			break;
-		case DimeBase::dimeArcType:
-			convert_arc(entity, state, ld, this);
-			break;
-		case DimeBase::dimeCircleType:
-			convert_circle(entity, state, ld, this);
-			break;
-		case DimeBase::dimeEllipseType:
-			convert_ellipse(entity, state, ld, this);
-			break;
-		case DimeBase::dimeInsertType:
-			// handled in traverseEntities
-			break;
-		case DimeBase::dimeBlockType:
-			// handled in traverseEntities
-			break;
-		case DimeBase::dimeLineType:
-			convert_line(entity, state, ld, this);
-			break;
-		case DimeBase::dimeLWPolylineType:
-			convert_lwpolyline(entity, state, ld, this);
-			break;
-		case DimeBase::dimePointType:
-			convert_point(entity, state, ld, this);
-			break;
-		case DimeBase::dimePolylineType:
-			convert_polyline(entity, state, ld, this);
-			break;
-		case DimeBase::dimeSplineType:
-			// go for it Raphael! :-)
-			break;
-		default:
-			break;
+			this->currentLayer = insert->getLayer();
 		}
-		return true;
-	};
+	}
+	else
+	{
+		this->currentLayer = source->getLayer();
+	}
+
+	if (state->getCurrentInsert())
+	{
+		this->currentInsertColorIndex =
+			getColorIndex((DimeEntity*)state->getCurrentInsert());
+	}
+	else
+	{
+		this->currentInsertColorIndex = 7;
+	}
+
+	dxfLayerData* ld = getLayerData(entity);
 
-	return model.traverseEntities(cb, false,
-	                              true, false);
+	// fillmode on by default. entities which will not fill its polygons
+	// should turn it off (layerData::addQuad() will create polygons,
+	// not lines)
+	//
+	ld->setFillmode(true);
+
+	dimeStatsData* statsdata = dimeStatsData::get(this->stats);
+	const int numindices = statsdata ?
+		ld->faceindices.count() + ld->lineindices.count() + ld->points.count() : 0;
+
+	switch (entity->typeId())
+	{
+	case DimeBase::dime3DFaceType:
+		convert_3dface(entity, state, ld, this);
+		break;
+	case DimeBase::dimeSolidType:
+		convert_solid(entity, state, ld, this);
+		break;
+	case DimeBase::dimeTraceType:
+		convert_solid(entity, state, ld, this);
+		break;
+	case DimeBase::dimeArcType:
+		convert_arc(entity, state, ld, this);
+		break;
+	case DimeBase::dimeCircleType:
+		convert_circle(entity, state, ld, this);
+		break;
+	case DimeBase::dimeEllipseType:
+		convert_ellipse(entity, state, ld, this);
+		break;
+	case DimeBase::dimeInsertType:
+		// handled in traverseEntities
+		break;
+	case DimeBase::dimeBlockType:
+		// handled in traverseEntities
+		break;
+	case DimeBase::dimeLineType:
+		convert_line(entity, state, ld, this);
+		break;
+	case DimeBase::dimeLWPolylineType:
+		convert_lwpolyline(entity, state, ld, this);
+		break;
+	case DimeBase::dimePointType:
+		convert_point(entity, state, ld, this);
+		break;
+	case DimeBase::dimePolylineType:
+		convert_polyline(entity, state, ld, this);
+		break;
+	case DimeBase::dimeSplineType:
+		convert_spline(entity, state, ld, this);
+		break;
+	default:
+		break;
+	}
+	if (statsdata)
+	{
+		dimeStatsData::addType(statsdata->vertices, entity->typeId(),
+		                       ld->faceindices.count() + ld->lineindices.count() +
+		                       ld->points.count() - numindices);
+	}
+	return true;
+}
+
+/*!
+  Post-processes the polygons of all layers with \a optimizer. Call
+  this after doConvert(), before writing the geometry.
+*/
+void
+dxfConverter::optimizeMeshes(const dxfMeshOptimizer& optimizer)
+{
+	dimeArray<dxfLayerData*> groups;
+	this->getGroups(groups);
+	for (int i = 0; i < groups.count(); i++)
+	{
+		optimizer.optimize(groups[i]);
+	}
+}
+
+/*!
+  Sends the internal geometry structures to \a sink, one layer
+  at a time. Returns the value returned by dxfGeometrySink::end(), or
+  \c false if dxfGeometrySink::begin() fails.
+*/
+bool
+dxfConverter::writeGeometry(dxfGeometrySink* sink)
+{
+	if (!sink->begin()) return false;
+	if (this->originmode != ORIGIN_NONE) sink->setOrigin(this->origin);
+	dimeArray<dxfLayerData*> groups;
+	this->getGroups(groups);
+	for (int i = 0; i < groups.count(); i++)
+	{
+		groups[i]->writeGeometry(sink, this->entityids);
+	}
+	return sink->end();
 }
 
 /*!
@@ -309,35 +986,54 @@ dxfConverter::writeVrml(FILE* out, const bool vrml1,
                         const bool only2d)
 {
 #ifndef NOWRLEXPORT
-	//
-	// write header
-	//
+	dxfVrmlWriter writer(out, vrml1, only2d);
+	return this->writeVrmlLayers(&writer);
+#else // NOWRLEXPORT
+	return true;
+#endif // NOWRLEXPORT
+}
 
-	if (vrml1)
-	{
-		fprintf(out,
-		        "#VRML V1.0 ascii\n\n");
-	}
-	else
+/*!
+  Writes the internal geometry structures to the file descriptor
+  \a fd. This avoids the stdio layer completely, and is the fastest
+  way to write large files.
+*/
+bool
+dxfConverter::writeVrml(const int fd, const bool vrml1,
+                        const bool only2d)
+{
+#ifndef NOWRLEXPORT
+	dxfVrmlWriter writer(fd, vrml1, only2d);
+	return this->writeVrmlLayers(&writer);
+#else // NOWRLEXPORT
+	return true;
+#endif // NOWRLEXPORT
+}
+
+//
+// writes each used layer/color to writer, and frees the layer data
+// as soon as it has been written, unless it is needed by updateConvert()
+//
+bool
+dxfConverter::writeVrmlLayers(dxfVrmlWriter* writer)
+{
+	if (!writer->begin()) return false;
+	if (this->originmode != ORIGIN_NONE) writer->setOrigin(this->origin);
+	dimeArray<dxfLayerData*> groups;
+	this->getGroups(groups);
+	for (int i = 0; i < groups.count(); i++)
 	{
-		fprintf(out,
-		        "#VRML V2.0 utf8\n\n");
+		groups[i]->writeGeometry(writer, this->entityids);
+		// the layer data is needed by updateConvert()
+		if (!this->incremental) delete groups[i];
 	}
-
-	//
-	// write each used layer/color
-	//
-	for (int i = 0; i < 255; i++)
+	if (!this->incremental)
 	{
-		if (layerData[i] != nullptr)
-		{
-			layerData[i]->writeWrl(out, 0, vrml1, only2d);
-			delete layerData[i];
-			layerData[i] = nullptr;
-		}
+		for (int i = 0; i < 255; i++) this->layerData[i] = nullptr;
+		this->groups->list.clear();
+		this->groups->map.clear();
 	}
-#endif // NOWRLEXPORT
-	return true;
+	return writer->end();
 }
 
 /*!
@@ -375,5 +1071,58 @@ dxfConverter::findHeaderVariables(DimeModel& model)
 			if (groupcode == 70)
 				this->fillmode = static_cast<bool>(param.int16_data);
 		}
+
+		int groupcodes[3];
+		dimeParam params[3];
+		bool minok = false, maxok = false;
+		if (hs->getVariable("$EXTMIN", groupcodes, params, 3) == 3 &&
+			groupcodes[0] == 10 && groupcodes[1] == 20 && groupcodes[2] == 30)
+		{
+			for (int i = 0; i < 3; i++) this->extmin[i] = params[i].double_data;
+			minok = true;
+		}
+		if (hs->getVariable("$EXTMAX", groupcodes, params, 3) == 3 &&
+			groupcodes[0] == 10 && groupcodes[1] == 20 && groupcodes[2] == 30)
+		{
+			for (int i = 0; i < 3; i++) this->extmax[i] = params[i].double_data;
+			maxok = true;
+		}
+		// empty drawings have $EXTMIN > $EXTMAX
+		this->hasextents = minok && maxok &&
+			this->extmin[0] <= this->extmax[0] &&
+			this->extmin[1] <= this->extmax[1] &&
+			this->extmin[2] <= this->extmax[2];
+	}
+}
+
+//
+// finds the origin for the vertices, according to the origin mode
+//
+void
+dxfConverter::findOrigin(DimeModel& model)
+{
+	if (this->originmode == ORIGIN_NONE || this->originmode == ORIGIN_CUSTOM) return;
+
+	if (this->originmode == ORIGIN_EXTENTS && this->hasextents)
+	{
+		this->origin = (this->extmin + this->extmax) * 0.5;
+		return;
 	}
+
+	this->origin.setValue(0.0, 0.0, 0.0);
+	dimeCallback cb = [this](DimeState const* state, DimeEntity* entity)
+	{
+		dimeArray<dimeVec3> verts;
+		dimeArray<int> indices;
+		dimeVec3 extrusiondir;
+		dxfdouble thickness;
+		if (entity->extractGeometry(verts, indices, extrusiondir, thickness) !=
+			DimeEntity::NONE && verts.count())
+		{
+			state->getMatrix().multMatrixVec(verts[0], this->origin);
+			return false; // stop traversal
+		}
+		return true;
+	};
+	model.traverseEntities(cb, false, true, false);
 }
@@ -33,10 +33,14 @@
 #ifndef _DXF2VRML_CONVERT_FUNCS_H_
 #define _DXF2VRML_CONVERT_FUNCS_H_
 
+#include <dime/Basic.h>
+
 class DimeEntity;
 class DimeState;
 class dxfLayerData;
 class dxfConverter;
+class dimeVec3;
+class dimeMatrix;
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -62,5 +66,10 @@ void convert_polyline(const DimeEntity*, const DimeState*,
                       dxfLayerData*, dxfConverter*);
 void convert_lwpolyline(const DimeEntity*, const DimeState*,
                         dxfLayerData*, dxfConverter*);
+bool convert_fill_loop(const dimeVec3* pts, const dxfdouble* bulges, int num,
+                       const dimeMatrix* matrix,
+                       dxfLayerData*, dxfConverter*);
+void convert_spline(const DimeEntity*, const DimeState*,
+                    dxfLayerData*, dxfConverter*);
 
 #endif // _DXF2VRML_CONVERT_FUNCS_H_
@@ -31,42 +31,13 @@
 \**************************************************************************/
 
 #include "convert_funcs.h"
+#include "tessellation.h"
 #include <dime/convert/convert.h>
 #include <dime/convert/layerdata.h>
 #include <dime/entities/Ellipse.h>
 #include <dime/util/Linear.h>
 #include <dime/State.h>
 
-//
-// find intersection between ellipse and the line x=r-maxerr,
-// and return the number of subdivisions necessary
-// to respect the maxerr parameter.
-//
-static int
-calc_num_sub(dxfdouble maxerr, dxfdouble a, dxfdouble b)
-{
-	dxfdouble minrad = a < b ? a : b;
-
-	if (maxerr >= minrad) maxerr = minrad / 40.0f;
-
-	dxfdouble x, y;
-
-	if (a >= b)
-	{
-		x = a - maxerr;
-		y = sqrt((1.0 - (x * x) / (a * a)) * b * b);
-	}
-	else
-	{
-		x = b - maxerr;
-		y = sqrt((1.0 - (x * x) / (b * b)) * a * a);
-	}
-
-	dxfdouble rad = atan(y / x);
-	return static_cast<int>(M_PI / fabs(rad)) + 1;
-}
-
-
 void
 convert_ellipse(const DimeEntity* entity, const DimeState* state,
                 dxfLayerData* layerData, dxfConverter* converter)
@@ -114,12 +85,14 @@ convert_ellipse(const DimeEntity* entity, const DimeState* state,
 	yaxis *= ellipse->getMinorMajorRatio() * xlen;
 	xaxis *= xlen;
 
-	dxfdouble numpts = converter->getNumSub();
-	if (numpts <= 0.0)
+	dxfTessellationCache* cache = converter->getTessellationCache();
+
+	int numpts = converter->getNumSub();
+	if (numpts <= 0)
 	{
 		// use maxerr
-		numpts = calc_num_sub(converter->getMaxerr(),
-		                      xlen, xlen * ellipse->getMinorMajorRatio());
+		numpts = cache->getEllipseNumSub(converter->getMaxerr(),
+		                                 xlen, xlen * ellipse->getMinorMajorRatio());
 	}
 
 	dxfdouble rad = ellipse->getStartParam();
@@ -127,48 +100,49 @@ convert_ellipse(const DimeEntity* entity, const DimeState* state,
 
 	while (end <= rad) end += M_PI * 2.0;
 
-	// taendl 2012-07-21 substituted the line below
-	// by the following line 
-	//dxfdouble size = (2*M_PI) / (end-rad);
-	dxfdouble size = (end - rad) / (2 * M_PI);
-	dxfdouble inc = (end - rad) / (numpts * size);
-
-	dimeVec3 v;
-	dimeVec3 prev(center[0] + xaxis[0] * cos(rad) + yaxis[0] * sin(rad),
-	               center[1] + xaxis[1] * cos(rad) + yaxis[1] * sin(rad),
-	               center[2] + xaxis[2] * cos(rad) + yaxis[2] * sin(rad));
-	rad += inc;
-
-	for (; rad < end; rad += inc)
+	// the parameter step is 2PI / numpts regardless of the span, so the
+	// samples are taken from the cached full circle table, rotated to
+	// the start parameter by rotating the ellipse axes.
+	const dxfUnitArcTable* table = cache->getUnitCircle(numpts);
+	const dxfdouble* ct = table->cosv.constArrayPointer();
+	const dxfdouble* st = table->sinv.constArrayPointer();
+	dxfdouble inc = (2 * M_PI) / numpts;
+
+	// number of samples strictly inside the span
+	int numinside = static_cast<int>(ceil((end - rad) / inc));
+	if (numinside > numpts) numinside = numpts;
+	if (numinside < 1) numinside = 1;
+
+	dxfdouble c = cos(rad);
+	dxfdouble s = sin(rad);
+	dimeVec3 xa = xaxis * c + yaxis * s;
+	dimeVec3 ya = yaxis * c - xaxis * s;
+
+	dimeArray<dimeVec3>& pts = cache->getScratch();
+	int i;
+	for (i = 0; i < numinside; i++)
 	{
-		v = dimeVec3(center[0] + xaxis[0] * cos(rad) + yaxis[0] * sin(rad),
-		              center[1] + xaxis[1] * cos(rad) + yaxis[1] * sin(rad),
-		              center[2] + xaxis[2] * cos(rad) + yaxis[2] * sin(rad));
-
-		if (thickness == 0.0)
-		{
-			layerData->addLine(prev, v, &matrix);
-		}
-		else
-		{
-			layerData->addQuad(prev, v, v + e, prev + e,
-			                   &matrix);
-		}
-		prev = v;
-		rad += inc;
+		pts.append(dimeVec3(center[0] + xa[0] * ct[i] + ya[0] * st[i],
+		                    center[1] + xa[1] * ct[i] + ya[1] * st[i],
+		                    center[2] + xa[2] * ct[i] + ya[2] * st[i]));
 	}
 
 	rad = end;
-	v = dimeVec3(center[0] + xaxis[0] * cos(rad) + yaxis[0] * sin(rad),
-	              center[1] + xaxis[1] * cos(rad) + yaxis[1] * sin(rad),
-	              center[2] + xaxis[2] * cos(rad) + yaxis[2] * sin(rad));
+	pts.append(dimeVec3(center[0] + xaxis[0] * cos(rad) + yaxis[0] * sin(rad),
+	                    center[1] + xaxis[1] * cos(rad) + yaxis[1] * sin(rad),
+	                    center[2] + xaxis[2] * cos(rad) + yaxis[2] * sin(rad)));
+
+	const dimeVec3* v = pts.constArrayPointer();
 	if (thickness == 0.0)
 	{
-		layerData->addLine(prev, v, &matrix);
+		layerData->addLineStrip(v, numinside + 1, &matrix);
 	}
 	else
 	{
-		layerData->addQuad(prev, v, v + e, prev + e,
-		                   &matrix);
+		for (i = 0; i < numinside; i++)
+		{
+			layerData->addQuad(v[i], v[i + 1], v[i + 1] + e, v[i] + e,
+			                   &matrix);
+		}
 	}
 }
@@ -0,0 +1,80 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include "convert_funcs.h"
+#include "tessellation.h"
+#include <dime/convert/convert.h>
+#include <dime/convert/layerdata.h>
+#include <dime/util/Triangulator.h>
+#include <dime/util/Linear.h>
+
+//
+// Triangulates the closed loop pts and adds the triangles to
+// layerData. If bulges != NULL, bulge i is used for the segment from
+// point i to point i + 1, and is tessellated before triangulating.
+// Returns false if the loop could not be triangulated, and the
+// caller should convert the outline instead.
+//
+bool
+convert_fill_loop(const dimeVec3* pts, const dxfdouble* bulges, const int num,
+                  const dimeMatrix* matrix,
+                  dxfLayerData* layerData, dxfConverter* converter)
+{
+	if (num < 3) return false;
+
+	dimeArray<dimeVec3>& loop = converter->getTessellationCache()->getScratch();
+	for (int i = 0; i < num; i++)
+	{
+		loop.append(pts[i]);
+		if (bulges && bulges[i] != 0.0)
+		{
+			dimeTriangulator::tessellateBulge(pts[i], pts[(i + 1) % num], bulges[i],
+			                                  converter->getMaxerr(),
+			                                  converter->getNumSub(), loop);
+		}
+	}
+
+	dimeTriangulator triangulator;
+	triangulator.addContour(loop.constArrayPointer(), loop.count());
+
+	dimeArray<int> indices(loop.count() * 4);
+	if (!triangulator.triangulate(indices)) return false;
+
+	const dimeVec3* v = loop.constArrayPointer();
+	const int* idx = indices.constArrayPointer();
+	const int n = indices.count();
+	for (int i = 0; i + 3 < n; i += 4)
+	{
+		layerData->addTriangle(v[idx[i]], v[idx[i + 1]], v[idx[i + 2]], matrix);
+	}
+	return true;
+}
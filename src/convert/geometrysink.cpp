@@ -0,0 +1,162 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include <dime/convert/geometrysink.h>
+
+/*!
+  \class dxfGeometrySink geometrysink.h
+  \brief The dxfGeometrySink class is the interface for exporting the
+  geometry collected by dxfConverter.
+
+  dxfConverter::writeGeometry() calls begin() once, then beginLayer(),
+  the add methods and endLayer() for each dxfLayerData with geometry,
+  and finally end(). Subclasses write the geometry to some file format,
+  or hand it over to a renderer.
+
+  The vertex arrays passed to the add methods are only valid for the
+  duration of the call, and must be copied if they are needed later.
+*/
+
+/*!
+  \fn void dxfGeometrySink::beginLayer(int colidx, dxfdouble r, dxfdouble g, dxfdouble b)
+  Called before the geometry for the color index \a colidx is added.
+  \a r, \a g and \a b is the RGB color for the color index.
+*/
+
+/*!
+  \fn void dxfGeometrySink::addFaces(const dimeVec3* verts, int numverts, const int* indices, int numindices)
+  Adds polygons. \a indices contains indices into \a verts, and each
+  polygon is terminated by -1. The polygons are planar and convex
+  (normally triangles or quads).
+*/
+
+/*!
+  \fn void dxfGeometrySink::addLines(const dimeVec3* verts, int numverts, const int* indices, int numindices)
+  Adds line strips. \a indices contains indices into \a verts, and
+  the strips are separated by -1. The last strip might not be
+  terminated by -1.
+*/
+
+/*!
+  \fn void dxfGeometrySink::addPoints(const dimeVec3* pts, int numpts)
+  Adds \a numpts points.
+*/
+
+/*!
+  \fn void dxfGeometrySink::endLayer()
+  Called when all geometry for the current layer has been added.
+*/
+
+/*!
+  Destructor.
+*/
+dxfGeometrySink::~dxfGeometrySink()
+{
+}
+
+/*!
+  Called before any geometry is added. Returns \c false if the sink
+  can not accept geometry. The default method does nothing and returns
+  \c true.
+*/
+bool
+dxfGeometrySink::begin()
+{
+	return true;
+}
+
+/*!
+  Called after begin() when the vertices are stored relative to an
+  origin, to avoid precision problems with large coordinates. All
+  vertices passed to the add methods must be translated by \a origin
+  to get the original coordinates. The default method does nothing.
+
+  \sa dxfConverter::setOriginMode()
+*/
+void
+dxfGeometrySink::setOrigin(const dimeVec3& origin)
+{
+}
+
+/*!
+  Called when all geometry has been added. Returns \c false if the
+  geometry could not be written. The default method does nothing and
+  returns \c true.
+*/
+bool
+dxfGeometrySink::end()
+{
+	return true;
+}
+
+/*!
+  Called right before beginLayer() when dxfConverter groups the
+  geometry by DXF layer, block instance or entity. \a layername is the
+  name of the DXF layer, or \c NULL. \a entityid is the ID of the
+  entity or INSERT the geometry belongs to, or -1. The default method
+  does nothing.
+
+  \sa dxfConverter::setGroupMode(), dxfConverter::getEntity()
+*/
+void
+dxfGeometrySink::setGroupInfo(const char* layername, int entityid)
+{
+}
+
+/*!
+  Called right before addFaces() or addLines() when entity IDs are
+  enabled. \a ranges has \a numranges (start, id) pairs, sorted by
+  start, where start is a position in the index array of the following
+  add call. A polygon belongs to the range containing the position of
+  its first index, and a line segment to the range containing the
+  position of its last index. The default method does nothing.
+
+  \sa dxfConverter::setEntityIds(), dxfConverter::getEntity()
+*/
+void
+dxfGeometrySink::setEntityRanges(const int* ranges, int numranges)
+{
+}
+
+/*!
+  Called right before addFaces() when the polygons have vertex
+  normals. \a normalindices contains indices into \a normals, with
+  the same layout as the indices passed to addFaces(). The default
+  method does nothing, and the normals are ignored.
+
+  \sa dxfMeshOptimizer
+*/
+void
+dxfGeometrySink::setFaceNormals(const dimeVec3* normals, int numnormals,
+                                const int* normalindices)
+{
+}
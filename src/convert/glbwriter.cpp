@@ -0,0 +1,706 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*!
+  \class dxfGlbWriter glbwriter.h
+  \brief The dxfGlbWriter class writes the converted geometry as binary glTF 2.0 (GLB).
+
+  Each dxfLayerData becomes one mesh, with polygons written as
+  triangles and points as a point primitive. If the polygons have
+  normals (see dxfMeshOptimizer), vertices with more than one normal
+  are duplicated, since glTF only supports one index per vertex. Line strips are written
+  natively as LINE_STRIP primitives. Since glTF needs one primitive
+  for each strip, only the first setMaxLineStrips() strips of a layer
+  are written like this, and the rest are merged into a single LINES
+  primitive.
+
+  All positions and indices are stored in one binary buffer. The
+  positions are stored as 32-bit floats relative to the center of the
+  bounding box of the geometry, and the offset is stored as the
+  translation of the root node. This keeps full float precision even
+  for drawings in geographical coordinates. The root node also rotates
+  the Z-up DXF geometry into the Y-up glTF coordinate system. Indices
+  are stored as 16 bit values for primitives with less than 65535
+  vertices, and as 32 bit values otherwise.
+
+  When the converter groups geometry by layer, block instance or
+  entity, the group is used as the name of the mesh and node. Entity
+  ID ranges are stored in the \c extras of each primitive as
+  \c entityRanges, a flat array of (element, id) pairs, where element
+  is the index of the first triangle or segment of the range.
+  Segment k of a LINE_STRIP connects vertex k and k + 1.
+
+  Nothing is written until end() is called, since the buffer layout
+  depends on all the geometry.
+*/
+
+#include <dime/convert/glbwriter.h>
+#include <stdarg.h>
+#include <string.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define GLB_MAGIC 0x46546C67 // "glTF"
+#define GLB_CHUNK_JSON 0x4E4F534A
+#define GLB_CHUNK_BIN 0x004E4942
+
+#define GLTF_POINTS 0
+#define GLTF_LINES 1
+#define GLTF_LINE_STRIP 3
+#define GLTF_TRIANGLES 4
+
+#define GLTF_FLOAT 5126
+#define GLTF_UNSIGNED_SHORT 5123
+#define GLTF_UNSIGNED_INT 5125
+#define GLTF_ARRAY_BUFFER 34962
+#define GLTF_ELEMENT_ARRAY_BUFFER 34963
+
+namespace {
+
+struct glb_primitive
+{
+	int mode;
+	int vertexset;
+	std::vector<uint32_t> indices;
+	std::vector<int> ranges;
+};
+
+struct glb_layer
+{
+	int colidx;
+	dxfdouble rgb[3];
+	std::string name;
+	int entityid;
+	std::vector<glb_primitive> prims;
+};
+
+//
+// looks up entity IDs for increasing index positions
+//
+struct glb_range_cursor
+{
+	const int* ranges;
+	int numranges;
+	int current;
+
+	int
+	find(const int pos)
+	{
+		while (current + 1 < numranges && ranges[(current + 1) * 2] <= pos) current++;
+		return current >= 0 ? ranges[current * 2 + 1] : -1;
+	}
+};
+
+void
+glb_add_range(glb_primitive& prim, const int element, const int id)
+{
+	if (id < 0) return;
+	if (prim.ranges.empty() || prim.ranges.back() != id)
+	{
+		prim.ranges.push_back(element);
+		prim.ranges.push_back(id);
+	}
+}
+
+void
+glb_append_u32(std::vector<unsigned char>& buf, const uint32_t val)
+{
+	buf.push_back(static_cast<unsigned char>(val & 0xff));
+	buf.push_back(static_cast<unsigned char>((val >> 8) & 0xff));
+	buf.push_back(static_cast<unsigned char>((val >> 16) & 0xff));
+	buf.push_back(static_cast<unsigned char>((val >> 24) & 0xff));
+}
+
+void
+glb_append_u16(std::vector<unsigned char>& buf, const uint32_t val)
+{
+	buf.push_back(static_cast<unsigned char>(val & 0xff));
+	buf.push_back(static_cast<unsigned char>((val >> 8) & 0xff));
+}
+
+void
+glb_append_f32(std::vector<unsigned char>& buf, const float val)
+{
+	uint32_t bits;
+	memcpy(&bits, &val, sizeof(bits));
+	glb_append_u32(buf, bits);
+}
+
+void
+glb_printf(std::string& str, const char* fmt, ...)
+{
+	char tmp[256];
+	va_list args;
+	va_start(args, fmt);
+	int len = vsnprintf(tmp, sizeof(tmp), fmt, args);
+	va_end(args);
+	if (len > 0) str.append(tmp, len < static_cast<int>(sizeof(tmp)) ? len : sizeof(tmp) - 1);
+}
+
+void
+glb_append_json_string(std::string& str, const char* val)
+{
+	str += '"';
+	for (const char* p = val; *p; p++)
+	{
+		const unsigned char c = static_cast<unsigned char>(*p);
+		if (c == '"' || c == '\\')
+		{
+			str += '\\';
+			str += static_cast<char>(c);
+		}
+		else if (c < 0x20) glb_printf(str, "\\u%04x", c);
+		else str += static_cast<char>(c);
+	}
+	str += '"';
+}
+
+} // namespace
+
+struct dxfGlbData
+{
+	std::vector<std::vector<dimeVec3>> vertexsets;
+	std::vector<std::vector<dimeVec3>> normalsets;
+	std::vector<glb_layer> layers;
+	dimeVec3 origin = dimeVec3(0.0, 0.0, 0.0);
+	const dimeVec3* normals = nullptr;
+	int numnormals = 0;
+	const int* normalindices = nullptr;
+	std::string groupname;
+	int groupentity = -1;
+	glb_range_cursor ranges = {nullptr, 0, -1};
+};
+
+/*!
+  Constructor. The GLB file will be written to \a fp, which must be
+  opened in binary mode.
+*/
+dxfGlbWriter::dxfGlbWriter(FILE* fp)
+	: fp(fp), maxLineStrips(1024), data(new dxfGlbData)
+{
+}
+
+/*!
+  Destructor.
+*/
+dxfGlbWriter::~dxfGlbWriter()
+{
+	delete this->data;
+}
+
+/*!
+  Sets the maximum number of LINE_STRIP primitives for each layer.
+  Additional strips are written as a LINES primitive. The default
+  is 1024.
+*/
+void
+dxfGlbWriter::setMaxLineStrips(const int num)
+{
+	this->maxLineStrips = num;
+}
+
+//!
+
+bool
+dxfGlbWriter::begin()
+{
+	this->data->vertexsets.clear();
+	this->data->normalsets.clear();
+	this->data->layers.clear();
+	this->data->origin.setValue(0.0, 0.0, 0.0);
+	return this->fp != nullptr;
+}
+
+/*!
+  Stores the origin, which is added to the translation of the root
+  node.
+*/
+void
+dxfGlbWriter::setOrigin(const dimeVec3& origin)
+{
+	this->data->origin = origin;
+}
+
+/*!
+  Stores the group, which is used to name the next layer.
+*/
+void
+dxfGlbWriter::setGroupInfo(const char* layername, const int entityid)
+{
+	this->data->groupname = layername ? layername : "";
+	this->data->groupentity = entityid;
+}
+
+/*!
+  Stores the entity ID ranges for the next addFaces() or addLines()
+  call.
+*/
+void
+dxfGlbWriter::setEntityRanges(const int* ranges, const int numranges)
+{
+	this->data->ranges.ranges = ranges;
+	this->data->ranges.numranges = numranges;
+	this->data->ranges.current = -1;
+}
+
+//!
+
+void
+dxfGlbWriter::beginLayer(const int colidx,
+                         const dxfdouble r, const dxfdouble g, const dxfdouble b)
+{
+	glb_layer layer;
+	layer.colidx = colidx;
+	layer.rgb[0] = r;
+	layer.rgb[1] = g;
+	layer.rgb[2] = b;
+	layer.name.swap(this->data->groupname);
+	layer.entityid = this->data->groupentity;
+	this->data->groupentity = -1;
+	this->data->layers.push_back(layer);
+}
+
+/*!
+  Stores the normals for the next addFaces() call.
+*/
+void
+dxfGlbWriter::setFaceNormals(const dimeVec3* normals, const int numnormals,
+                             const int* normalindices)
+{
+	this->data->normals = normals;
+	this->data->numnormals = numnormals;
+	this->data->normalindices = normalindices;
+}
+
+//!
+
+void
+dxfGlbWriter::addFaces(const dimeVec3* verts, const int numverts,
+                       const int* indices, const int numindices)
+{
+	glb_primitive prim;
+	prim.mode = GLTF_TRIANGLES;
+	prim.vertexset = static_cast<int>(this->data->vertexsets.size());
+
+	std::vector<dimeVec3> splitverts, splitnormals;
+	std::vector<int> splitindices;
+	const dimeVec3* normals = this->data->normals;
+	if (normals)
+	{
+		//
+		// one vertex for each unique (vertex, normal) pair
+		//
+		const int* normalindices = this->data->normalindices;
+		std::unordered_map<uint64_t, int> pairs;
+		splitindices.resize(numindices);
+		for (int i = 0; i < numindices; i++)
+		{
+			if (indices[i] < 0)
+			{
+				splitindices[i] = -1;
+				continue;
+			}
+			const uint64_t key = static_cast<uint64_t>(indices[i]) *
+				static_cast<uint64_t>(this->data->numnormals) +
+				static_cast<uint64_t>(normalindices[i]);
+			auto res = pairs.emplace(key, static_cast<int>(splitverts.size()));
+			if (res.second)
+			{
+				splitverts.push_back(verts[indices[i]]);
+				splitnormals.push_back(normals[normalindices[i]]);
+			}
+			splitindices[i] = res.first->second;
+		}
+		indices = splitindices.data();
+		this->data->normals = nullptr;
+		this->data->normalindices = nullptr;
+		this->data->numnormals = 0;
+	}
+
+	// the polygons are convex, so a triangle fan will do
+	glb_range_cursor& ranges = this->data->ranges;
+	int start = 0;
+	for (int i = 0; i <= numindices; i++)
+	{
+		if (i == numindices || indices[i] < 0)
+		{
+			if (ranges.numranges && i - start > 2)
+			{
+				glb_add_range(prim, static_cast<int>(prim.indices.size() / 3),
+				              ranges.find(start));
+			}
+			for (int j = start + 1; j < i - 1; j++)
+			{
+				prim.indices.push_back(indices[start]);
+				prim.indices.push_back(indices[j]);
+				prim.indices.push_back(indices[j + 1]);
+			}
+			start = i + 1;
+		}
+	}
+	ranges.numranges = 0;
+	if (prim.indices.empty()) return;
+
+	if (normals)
+	{
+		this->data->vertexsets.push_back(std::move(splitverts));
+		this->data->normalsets.push_back(std::move(splitnormals));
+	}
+	else
+	{
+		this->data->vertexsets.emplace_back(verts, verts + numverts);
+		this->data->normalsets.emplace_back();
+	}
+	this->data->layers.back().prims.push_back(std::move(prim));
+}
+
+//!
+
+void
+dxfGlbWriter::addLines(const dimeVec3* verts, const int numverts,
+                       const int* indices, const int numindices)
+{
+	const int vertexset = static_cast<int>(this->data->vertexsets.size());
+	std::vector<glb_primitive>& prims = this->data->layers.back().prims;
+
+	glb_primitive segments;
+	segments.mode = GLTF_LINES;
+	segments.vertexset = vertexset;
+
+	glb_range_cursor& ranges = this->data->ranges;
+	const size_t numprims = prims.size();
+	int numstrips = 0;
+	int start = 0;
+	for (int i = 0; i <= numindices; i++)
+	{
+		if (i < numindices && indices[i] >= 0) continue;
+
+		const int len = i - start;
+		if (len > 2 && numstrips < this->maxLineStrips)
+		{
+			glb_primitive strip;
+			strip.mode = GLTF_LINE_STRIP;
+			strip.vertexset = vertexset;
+			strip.indices.assign(indices + start, indices + i);
+			if (ranges.numranges)
+			{
+				for (int j = start; j < i - 1; j++)
+				{
+					glb_add_range(strip, j - start, ranges.find(j + 1));
+				}
+			}
+			prims.push_back(std::move(strip));
+			numstrips++;
+		}
+		else
+		{
+			for (int j = start; j < i - 1; j++)
+			{
+				if (ranges.numranges)
+				{
+					glb_add_range(segments, static_cast<int>(segments.indices.size() / 2),
+					              ranges.find(j + 1));
+				}
+				segments.indices.push_back(indices[j]);
+				segments.indices.push_back(indices[j + 1]);
+			}
+		}
+		start = i + 1;
+	}
+	if (!segments.indices.empty()) prims.push_back(std::move(segments));
+	ranges.numranges = 0;
+
+	if (prims.size() > numprims)
+	{
+		this->data->vertexsets.emplace_back(verts, verts + numverts);
+		this->data->normalsets.emplace_back();
+	}
+}
+
+//!
+
+void
+dxfGlbWriter::addPoints(const dimeVec3* pts, const int numpts)
+{
+	if (numpts <= 0) return;
+	glb_primitive prim;
+	prim.mode = GLTF_POINTS;
+	prim.vertexset = static_cast<int>(this->data->vertexsets.size());
+	this->data->vertexsets.emplace_back(pts, pts + numpts);
+	this->data->normalsets.emplace_back();
+	this->data->layers.back().prims.push_back(std::move(prim));
+}
+
+//!
+
+void
+dxfGlbWriter::endLayer()
+{
+	if (this->data->layers.back().prims.empty())
+	{
+		this->data->layers.pop_back();
+	}
+}
+
+/*!
+  Writes the GLB file. Returns \c false if the file could not be
+  written.
+*/
+bool
+dxfGlbWriter::end()
+{
+	std::vector<std::vector<dimeVec3>>& vertexsets = this->data->vertexsets;
+	std::vector<std::vector<dimeVec3>>& normalsets = this->data->normalsets;
+	std::vector<glb_layer>& layers = this->data->layers;
+	size_t i, j;
+
+	// find the origin in the center of the bounding box
+	dimeVec3 minv(0, 0, 0), maxv(0, 0, 0);
+	bool first = true;
+	for (i = 0; i < vertexsets.size(); i++)
+	{
+		for (const dimeVec3& v : vertexsets[i])
+		{
+			if (first)
+			{
+				minv = maxv = v;
+				first = false;
+			}
+			for (int k = 0; k < 3; k++)
+			{
+				if (v[k] < minv[k]) minv[k] = v[k];
+				if (v[k] > maxv[k]) maxv[k] = v[k];
+			}
+		}
+	}
+	dimeVec3 origin = (minv + maxv) * 0.5;
+
+	std::vector<unsigned char> bin;
+	std::string accessors;
+	std::vector<int> posaccessor(vertexsets.size());
+	std::vector<int> normalaccessor(vertexsets.size(), -1);
+	int numaccessors = 0;
+
+	for (i = 0; i < vertexsets.size(); i++)
+	{
+		float fmin[3] = { 0.0f, 0.0f, 0.0f };
+		float fmax[3] = { 0.0f, 0.0f, 0.0f };
+		const size_t offset = bin.size();
+		for (j = 0; j < vertexsets[i].size(); j++)
+		{
+			const dimeVec3& v = vertexsets[i][j];
+			for (int k = 0; k < 3; k++)
+			{
+				float f = static_cast<float>(v[k] - origin[k]);
+				if (j == 0 || f < fmin[k]) fmin[k] = f;
+				if (j == 0 || f > fmax[k]) fmax[k] = f;
+				glb_append_f32(bin, f);
+			}
+		}
+		if (numaccessors) accessors += ",";
+		glb_printf(accessors,
+		           "{\"bufferView\":0,\"byteOffset\":%u,\"componentType\":%d,"
+		           "\"count\":%u,\"type\":\"VEC3\",",
+		           static_cast<unsigned int>(offset), GLTF_FLOAT,
+		           static_cast<unsigned int>(vertexsets[i].size()));
+		glb_printf(accessors, "\"min\":[%.9g,%.9g,%.9g],\"max\":[%.9g,%.9g,%.9g]}",
+		           fmin[0], fmin[1], fmin[2], fmax[0], fmax[1], fmax[2]);
+		posaccessor[i] = numaccessors++;
+
+		if (!normalsets[i].empty())
+		{
+			const size_t noffset = bin.size();
+			for (const dimeVec3& n : normalsets[i])
+			{
+				for (int k = 0; k < 3; k++) glb_append_f32(bin, static_cast<float>(n[k]));
+			}
+			glb_printf(accessors,
+			           ",{\"bufferView\":0,\"byteOffset\":%u,\"componentType\":%d,"
+			           "\"count\":%u,\"type\":\"VEC3\"}",
+			           static_cast<unsigned int>(noffset), GLTF_FLOAT,
+			           static_cast<unsigned int>(normalsets[i].size()));
+			normalaccessor[i] = numaccessors++;
+		}
+	}
+	const size_t poslength = bin.size();
+
+	std::string meshes, materials, nodes;
+	for (i = 0; i < layers.size(); i++)
+	{
+		const glb_layer& layer = layers[i];
+		if (i)
+		{
+			meshes += ",";
+			materials += ",";
+			nodes += ",";
+		}
+		glb_printf(materials,
+		           "{\"name\":\"color %d\",\"pbrMetallicRoughness\":{"
+		           "\"baseColorFactor\":[%.6g,%.6g,%.6g,1],"
+		           "\"metallicFactor\":0,\"roughnessFactor\":1},"
+		           "\"doubleSided\":true}",
+		           layer.colidx, layer.rgb[0], layer.rgb[1], layer.rgb[2]);
+		std::string name;
+		if (layer.entityid >= 0) glb_printf(name, "entity %d", layer.entityid);
+		else if (!layer.name.empty()) name = layer.name;
+		else glb_printf(name, "color %d", layer.colidx);
+		nodes += "{\"name\":";
+		glb_append_json_string(nodes, name.c_str());
+		glb_printf(nodes, ",\"mesh\":%u", static_cast<unsigned int>(i));
+		if (layer.entityid >= 0)
+		{
+			glb_printf(nodes, ",\"extras\":{\"entityId\":%d}", layer.entityid);
+		}
+		nodes += "}";
+		meshes += "{\"name\":";
+		glb_append_json_string(meshes, name.c_str());
+		meshes += ",\"primitives\":[";
+		for (j = 0; j < layer.prims.size(); j++)
+		{
+			const glb_primitive& prim = layer.prims[j];
+			if (j) meshes += ",";
+			glb_printf(meshes, "{\"attributes\":{\"POSITION\":%d",
+			           posaccessor[prim.vertexset]);
+			if (normalaccessor[prim.vertexset] >= 0)
+			{
+				glb_printf(meshes, ",\"NORMAL\":%d", normalaccessor[prim.vertexset]);
+			}
+			meshes += "},";
+			if (!prim.indices.empty())
+			{
+				// the largest value is reserved for primitive restart
+				const bool shortindices = vertexsets[prim.vertexset].size() < 0xffff;
+				while ((bin.size() - poslength) & 3) bin.push_back(0);
+				const size_t offset = bin.size() - poslength;
+				for (uint32_t idx : prim.indices)
+				{
+					if (shortindices) glb_append_u16(bin, idx);
+					else glb_append_u32(bin, idx);
+				}
+				accessors += ",";
+				glb_printf(accessors,
+				           "{\"bufferView\":1,\"byteOffset\":%u,\"componentType\":%d,"
+				           "\"count\":%u,\"type\":\"SCALAR\"}",
+				           static_cast<unsigned int>(offset),
+				           shortindices ? GLTF_UNSIGNED_SHORT : GLTF_UNSIGNED_INT,
+				           static_cast<unsigned int>(prim.indices.size()));
+				glb_printf(meshes, "\"indices\":%d,", numaccessors++);
+			}
+			glb_printf(meshes, "\"mode\":%d,\"material\":%u",
+			           prim.mode, static_cast<unsigned int>(i));
+			if (!prim.ranges.empty())
+			{
+				meshes += ",\"extras\":{\"entityRanges\":[";
+				for (size_t k = 0; k < prim.ranges.size(); k++)
+				{
+					glb_printf(meshes, k ? ",%d" : "%d", prim.ranges[k]);
+				}
+				meshes += "]}";
+			}
+			meshes += "}";
+		}
+		meshes += "]}";
+	}
+	const size_t indexlength = bin.size() - poslength;
+
+	//
+	// the root node rotates from Z-up to Y-up, (x, y, z) -> (x, z, -y),
+	// and translates by the (rotated) origin.
+	//
+	std::string json;
+	json += "{\"asset\":{\"version\":\"2.0\",\"generator\":\"dime\"},"
+		"\"scene\":0,\"scenes\":[{\"nodes\":[0]}],\"nodes\":[";
+	const dimeVec3 translation = origin + this->data->origin;
+	glb_printf(json, "{\"name\":\"dxf\",\"rotation\":[-0.70710678118654752,0,0,0.70710678118654752],"
+	           "\"translation\":[%.17g,%.17g,%.17g]",
+	           translation[0], translation[2], -translation[1]);
+	if (!layers.empty())
+	{
+		json += ",\"children\":[";
+		for (i = 0; i < layers.size(); i++)
+		{
+			glb_printf(json, i ? ",%u" : "%u", static_cast<unsigned int>(i + 1));
+		}
+		json += "]},";
+		json += nodes;
+		json += "],\"meshes\":[";
+		json += meshes;
+		json += "],\"materials\":[";
+		json += materials;
+		json += "],\"accessors\":[";
+		json += accessors;
+		json += "],\"bufferViews\":[";
+		glb_printf(json, "{\"buffer\":0,\"byteOffset\":0,\"byteLength\":%u,\"target\":%d}",
+		           static_cast<unsigned int>(poslength), GLTF_ARRAY_BUFFER);
+		if (indexlength)
+		{
+			glb_printf(json, ",{\"buffer\":0,\"byteOffset\":%u,\"byteLength\":%u,\"target\":%d}",
+			           static_cast<unsigned int>(poslength),
+			           static_cast<unsigned int>(indexlength), GLTF_ELEMENT_ARRAY_BUFFER);
+		}
+		glb_printf(json, "],\"buffers\":[{\"byteLength\":%u}]}",
+		           static_cast<unsigned int>(bin.size()));
+	}
+	else
+	{
+		json += "}]}";
+	}
+
+	// chunks must be 4 byte aligned, JSON is padded with spaces
+	while (json.size() & 3) json += ' ';
+	while (bin.size() & 3) bin.push_back(0);
+
+	std::vector<unsigned char> header;
+	const size_t total = 12 + 8 + json.size() + (bin.empty() ? 0 : 8 + bin.size());
+	glb_append_u32(header, GLB_MAGIC);
+	glb_append_u32(header, 2);
+	glb_append_u32(header, static_cast<uint32_t>(total));
+	glb_append_u32(header, static_cast<uint32_t>(json.size()));
+	glb_append_u32(header, GLB_CHUNK_JSON);
+
+	bool ok = fwrite(header.data(), 1, header.size(), this->fp) == header.size() &&
+		fwrite(json.data(), 1, json.size(), this->fp) == json.size();
+	if (ok && !bin.empty())
+	{
+		header.clear();
+		glb_append_u32(header, static_cast<uint32_t>(bin.size()));
+		glb_append_u32(header, GLB_CHUNK_BIN);
+		ok = fwrite(header.data(), 1, header.size(), this->fp) == header.size() &&
+			fwrite(bin.data(), 1, bin.size(), this->fp) == bin.size();
+	}
+
+	vertexsets.clear();
+	normalsets.clear();
+	layers.clear();
+	return ok;
+}
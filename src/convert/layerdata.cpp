@@ -31,7 +31,11 @@
 \**************************************************************************/
 
 #include <dime/convert/layerdata.h>
+#include <dime/convert/geometrysink.h>
+#include <dime/convert/vrmlwriter.h>
 #include <dime/Layer.h>
+#include <algorithm>
+#include <vector>
 
 /*!
   \class dxfLayerData layerdata.h
@@ -40,15 +44,49 @@
   to group geometry data, and especially VRML data.
 
   The geometry can be either points, lines or polygons.
+
+  If entity IDs are enabled in dxfConverter, faceentities and
+  lineentities map ranges of faceindices and lineindices back to the
+  entities they were created from. Both are lists of (start, id) pairs,
+  sorted by start. A polygon belongs to the range containing the
+  position of its first index, and a line segment to the range
+  containing the position of its last index. pointentities does the
+  same for points, and is only used by removeEntities().
+
+  Polygons may have vertex normals in facenormals and normalindices,
+  set by dxfMeshOptimizer. The normals are only used as long as
+  normalindices has the same size as faceindices.
+*/
+
+/*!
+  \fn const dimeVec3& dxfLayerData::getOrigin() const
+  Returns the origin the vertices are stored relative to.
+  \sa setOrigin()
+*/
+
+/*!
+  \fn bool dxfLayerData::isEmpty() const
+  Returns \c TRUE if this layer has no geometry.
+*/
+
+/*!
+  \fn bool dxfLayerData::usesFloatPoints() const
+  Returns whether vertices are stored as single precision coordinates.
+  \sa setOrigin()
 */
 
 /*!
   Constructor
 */
 dxfLayerData::dxfLayerData(const int colidx)
+	: origin(0.0, 0.0, 0.0)
 {
 	this->fillmode = true;
+	this->floatpoints = false;
 	this->colidx = colidx;
+	this->grouplayer = nullptr;
+	this->groupentity = -1;
+	this->currententity = -1;
 }
 
 /*!
@@ -69,6 +107,411 @@ dxfLayerData::setFillmode(const bool fillmode)
 	this->fillmode = fillmode;
 }
 
+/*!
+  Sets the DXF layer and the entity this instance holds the geometry
+  for, when dxfConverter groups geometry by something else than the
+  color. \a layer may be \c NULL, and \a entityid may be -1.
+*/
+void
+dxfLayerData::setGroup(const dimeLayer* layer, const int entityid)
+{
+	this->grouplayer = layer;
+	this->groupentity = entityid;
+}
+
+/*!
+  Sets the ID of the entity being converted. Geometry added after
+  this call is tagged with \a entityid in faceentities and
+  lineentities. An \a entityid of -1 (the default) disables tagging.
+*/
+void
+dxfLayerData::setCurrentEntity(const int entityid)
+{
+	this->currententity = entityid;
+}
+
+/*!
+  Stores all vertices added after this call as single precision
+  coordinates relative to \a origin, in dimePointSet instances instead
+  of the BSP trees. This halves the memory used for vertices, and
+  avoids losing precision when the coordinates are large but the
+  drawing is small, e.g. drawings in geographical coordinates. Should
+  be called before any geometry is added.
+
+  The vertices passed to dxfGeometrySink are relative to the origin.
+
+  \sa dxfConverter::setOriginMode()
+*/
+void
+dxfLayerData::setOrigin(const dimeVec3& origin)
+{
+	this->origin = origin;
+	this->floatpoints = true;
+}
+
+/*!
+  Returns the number of polygon vertices.
+*/
+int
+dxfLayerData::getNumFaceVertices() const
+{
+	return this->floatpoints ? this->facepoints.numPoints() : this->facebsp.numPoints();
+}
+
+/*!
+  Returns the number of line vertices.
+*/
+int
+dxfLayerData::getNumLineVertices() const
+{
+	return this->floatpoints ? this->linepoints.numPoints() : this->linebsp.numPoints();
+}
+
+/*!
+  Returns a pointer to the polygon vertices, relative to the origin.
+  If the vertices are stored as floats, they are converted into \a tmp,
+  and a pointer to its contents is returned.
+*/
+const dimeVec3*
+dxfLayerData::getFaceVertices(dimeArray<dimeVec3>& tmp) const
+{
+	if (!this->floatpoints) return this->facebsp.getPoints();
+	return dxfLayerData::toDouble(this->facepoints, tmp);
+}
+
+/*!
+  Returns a pointer to the line vertices, relative to the origin.
+  \sa getFaceVertices()
+*/
+const dimeVec3*
+dxfLayerData::getLineVertices(dimeArray<dimeVec3>& tmp) const
+{
+	if (!this->floatpoints) return this->linebsp.getPoints();
+	return dxfLayerData::toDouble(this->linepoints, tmp);
+}
+
+/*!
+  Removes all geometry created from the \a numids entities in \a ids,
+  using the entity ranges. Geometry without an entity ID is kept. When
+  more than half of the vertices are no longer used, the unused
+  vertices are removed too.
+
+  \sa dxfConverter::updateConvert()
+*/
+void
+dxfLayerData::removeEntities(const int* ids, const int numids)
+{
+	if (numids <= 0) return;
+	std::vector<int> sorted(ids, ids + numids);
+	std::sort(sorted.begin(), sorted.end());
+	auto isremoved = [&sorted](const int id)
+	{
+		return id >= 0 && std::binary_search(sorted.begin(), sorted.end(), id);
+	};
+
+	//
+	// keep the polygons (and normal indices) not owned by the entities
+	//
+	int numranges = faceentities.count() / 2;
+	if (numranges)
+	{
+		const int n = faceindices.count();
+		const bool hasnormals = normalindices.count() == n;
+		std::vector<int> newindices, newnormals, newranges;
+		newindices.reserve(n);
+		if (hasnormals) newnormals.reserve(n);
+		int range = -1;
+		int start = 0;
+		for (int i = 0; i < n; i++)
+		{
+			if (faceindices[i] >= 0) continue;
+			while (range + 1 < numranges && faceentities[(range + 1) * 2] <= start) range++;
+			const int id = range >= 0 ? faceentities[range * 2 + 1] : -1;
+			if (!isremoved(id))
+			{
+				if (id >= 0 && (newranges.empty() || newranges.back() != id))
+				{
+					newranges.push_back(static_cast<int>(newindices.size()));
+					newranges.push_back(id);
+				}
+				for (int j = start; j <= i; j++)
+				{
+					newindices.push_back(faceindices[j]);
+					if (hasnormals) newnormals.push_back(normalindices[j]);
+				}
+			}
+			start = i + 1;
+		}
+		if (static_cast<int>(newindices.size()) < n)
+		{
+			faceindices.makeEmpty(static_cast<int>(newindices.size()) + 1);
+			for (int idx : newindices) faceindices.append(idx);
+			normalindices.makeEmpty(static_cast<int>(newnormals.size()) + 1);
+			for (int idx : newnormals) normalindices.append(idx);
+			if (!hasnormals) facenormals.makeEmpty();
+			faceentities.makeEmpty(static_cast<int>(newranges.size()) + 1);
+			for (int val : newranges) faceentities.append(val);
+			this->compactFaceVertices();
+		}
+	}
+
+	//
+	// keep the line segments not owned by the entities, and join them
+	// into strips again
+	//
+	numranges = lineentities.count() / 2;
+	if (numranges)
+	{
+		const int n = lineindices.count();
+		std::vector<int> newindices, newranges;
+		newindices.reserve(n);
+		int range = -1;
+		bool joined = false;
+		for (int i = 1; i < n; i++)
+		{
+			const int i0 = lineindices[i - 1];
+			const int i1 = lineindices[i];
+			if (i1 < 0) joined = false;
+			if (i0 < 0 || i1 < 0) continue;
+			while (range + 1 < numranges && lineentities[(range + 1) * 2] <= i) range++;
+			const int id = range >= 0 ? lineentities[range * 2 + 1] : -1;
+			if (isremoved(id))
+			{
+				joined = false;
+				continue;
+			}
+			if (id >= 0 && (newranges.empty() || newranges.back() != id))
+			{
+				newranges.push_back(static_cast<int>(newindices.size()));
+				newranges.push_back(id);
+			}
+			if (!joined || newindices.empty() || newindices.back() != i0)
+			{
+				if (!newindices.empty()) newindices.push_back(-1);
+				newindices.push_back(i0);
+			}
+			newindices.push_back(i1);
+			joined = true;
+		}
+		if (static_cast<int>(newindices.size()) < n)
+		{
+			lineindices.makeEmpty(static_cast<int>(newindices.size()) + 1);
+			for (int idx : newindices) lineindices.append(idx);
+			lineentities.makeEmpty(static_cast<int>(newranges.size()) + 1);
+			for (int val : newranges) lineentities.append(val);
+			this->compactLineVertices();
+		}
+	}
+
+	numranges = pointentities.count() / 2;
+	if (numranges)
+	{
+		const int n = points.count();
+		int cnt = 0;
+		int range = -1;
+		std::vector<int> newranges;
+		for (int i = 0; i < n; i++)
+		{
+			while (range + 1 < numranges && pointentities[(range + 1) * 2] <= i) range++;
+			const int id = range >= 0 ? pointentities[range * 2 + 1] : -1;
+			if (isremoved(id)) continue;
+			if (id >= 0 && (newranges.empty() || newranges.back() != id))
+			{
+				newranges.push_back(cnt);
+				newranges.push_back(id);
+			}
+			points[cnt++] = points[i];
+		}
+		points.setCount(cnt);
+		pointentities.makeEmpty(static_cast<int>(newranges.size()) + 1);
+		for (int val : newranges) pointentities.append(val);
+	}
+}
+
+//
+// removes the polygon vertices no longer used by faceindices, if
+// they are more than half of the vertices
+//
+void
+dxfLayerData::compactFaceVertices()
+{
+	const int numverts = this->getNumFaceVertices();
+	std::vector<int> remap(numverts, -1);
+	const int n = faceindices.count();
+	int used = 0;
+	for (int i = 0; i < n; i++)
+	{
+		const int idx = faceindices[i];
+		if (idx >= 0 && remap[idx] < 0) remap[idx] = used++;
+	}
+	if (used * 2 >= numverts) return;
+
+	dimeArray<dimeVec3> tmp(1);
+	const dimeVec3* verts = this->getFaceVertices(tmp);
+	std::vector<dimeVec3> newverts(used);
+	for (int i = 0; i < numverts; i++)
+	{
+		if (remap[i] >= 0) newverts[remap[i]] = verts[i];
+	}
+	for (int i = 0; i < n; i++)
+	{
+		if (faceindices[i] >= 0) faceindices[i] = remap[faceindices[i]];
+	}
+	this->setFaceVertices(newverts.data(), used);
+}
+
+//
+// removes the line vertices no longer used by lineindices, if they
+// are more than half of the vertices
+//
+void
+dxfLayerData::compactLineVertices()
+{
+	const int numverts = this->getNumLineVertices();
+	std::vector<int> remap(numverts, -1);
+	const int n = lineindices.count();
+	int used = 0;
+	for (int i = 0; i < n; i++)
+	{
+		const int idx = lineindices[i];
+		if (idx >= 0 && remap[idx] < 0) remap[idx] = used++;
+	}
+	if (used * 2 >= numverts) return;
+
+	dimeArray<dimeVec3> tmp(1);
+	const dimeVec3* verts = this->getLineVertices(tmp);
+	std::vector<dimeVec3> newverts(used);
+	for (int i = 0; i < numverts; i++)
+	{
+		if (remap[i] >= 0) newverts[remap[i]] = verts[i];
+	}
+	for (int i = 0; i < n; i++)
+	{
+		if (lineindices[i] >= 0) lineindices[i] = remap[lineindices[i]];
+	}
+	this->setLineVertices(newverts.data(), used);
+}
+
+/*!
+  Replaces the polygon vertices with \a verts, which are relative to
+  the origin. The vertices must be unique. Used by dxfMeshOptimizer
+  to reorder the vertices.
+*/
+void
+dxfLayerData::setFaceVertices(const dimeVec3* verts, const int numverts)
+{
+	if (this->floatpoints)
+	{
+		this->facepoints.clear(numverts + 1);
+		for (int i = 0; i < numverts; i++) this->facepoints.addPoint(verts[i]);
+	}
+	else
+	{
+		this->facebsp.clear(numverts + 1);
+		for (int i = 0; i < numverts; i++) this->facebsp.addPoint(verts[i]);
+	}
+}
+
+/*!
+  Replaces the line vertices with \a verts, which are relative to
+  the origin. The vertices must be unique.
+*/
+void
+dxfLayerData::setLineVertices(const dimeVec3* verts, const int numverts)
+{
+	if (this->floatpoints)
+	{
+		this->linepoints.clear(numverts + 1);
+		for (int i = 0; i < numverts; i++) this->linepoints.addPoint(verts[i]);
+	}
+	else
+	{
+		this->linebsp.clear(numverts + 1);
+		for (int i = 0; i < numverts; i++) this->linebsp.addPoint(verts[i]);
+	}
+}
+
+//
+// adds a polygon vertex, and returns its index
+//
+int
+dxfLayerData::addFaceVertex(const dimeVec3& v)
+{
+	if (this->floatpoints) return this->facepoints.addPoint(v - this->origin);
+	return this->facebsp.addPoint(v);
+}
+
+//
+// adds a line vertex, and returns its index
+//
+int
+dxfLayerData::addLineVertex(const dimeVec3& v)
+{
+	if (this->floatpoints) return this->linepoints.addPoint(v - this->origin);
+	return this->linebsp.addPoint(v);
+}
+
+//
+// starts a new entity range in faceentities if the entity has changed
+//
+void
+dxfLayerData::markFaceEntity()
+{
+	const int n = this->faceentities.count();
+	if (this->currententity >= 0 &&
+		(n == 0 || this->faceentities[n - 1] != this->currententity))
+	{
+		this->faceentities.append(this->faceindices.count());
+		this->faceentities.append(this->currententity);
+	}
+}
+
+//
+// starts a new entity range in lineentities if the entity has changed
+//
+void
+dxfLayerData::markLineEntity()
+{
+	const int n = this->lineentities.count();
+	if (this->currententity >= 0 &&
+		(n == 0 || this->lineentities[n - 1] != this->currententity))
+	{
+		this->lineentities.append(this->lineindices.count());
+		this->lineentities.append(this->currententity);
+	}
+}
+
+//
+// starts a new entity range in pointentities if the entity has changed
+//
+void
+dxfLayerData::markPointEntity()
+{
+	const int n = this->pointentities.count();
+	if (this->currententity >= 0 &&
+		(n == 0 || this->pointentities[n - 1] != this->currententity))
+	{
+		this->pointentities.append(this->points.count());
+		this->pointentities.append(this->currententity);
+	}
+}
+
+//
+// converts the float coordinates in points to doubles in tmp
+//
+const dimeVec3*
+dxfLayerData::toDouble(const dimePointSet& points, dimeArray<dimeVec3>& tmp)
+{
+	const int n = points.numPoints();
+	const float* p = points.getPoints();
+	tmp.makeEmpty(n + 1);
+	for (int i = 0; i < n; i++, p += 3)
+	{
+		tmp.append(dimeVec3(p[0], p[1], p[2]));
+	}
+	return tmp.constArrayPointer();
+}
+
 /*!
   Adds a line to this layer's geometry. If \a matrix != NULL, the
   points will be transformed by this matrix before they are added.
@@ -81,18 +524,19 @@ dxfLayerData::addLine(const dimeVec3& v0, const dimeVec3& v1,
 
 	if (matrix)
 	{
-		dimeVec3 t0, t1;
-		matrix->multMatrixVec(v0, t0);
-		matrix->multMatrixVec(v1, t1);
-		i0 = linebsp.addPoint(t0);
-		i1 = linebsp.addPoint(t1);
+		dimeVec3 t[2] = { v0, v1 };
+		matrix->transformPoints(t, t, 2);
+		i0 = this->addLineVertex(t[0]);
+		i1 = this->addLineVertex(t[1]);
 	}
 	else
 	{
-		i0 = linebsp.addPoint(v0);
-		i1 = linebsp.addPoint(v1);
+		i0 = this->addLineVertex(v0);
+		i1 = this->addLineVertex(v1);
 	}
 
+	this->markLineEntity();
+
 	//
 	// take care of line strips (more effective than single lines)
 	//
@@ -108,6 +552,47 @@ dxfLayerData::addLine(const dimeVec3& v0, const dimeVec3& v1,
 	}
 }
 
+/*!
+  Adds a connected line strip with \a numpts points to this layer's
+  geometry. This is equivalent to calling addLine() for each pair of
+  consecutive points, but each point is transformed and inserted into
+  the BSP tree only once. If \a matrix != NULL, the points will be
+  transformed by this matrix before they are added.
+*/
+void
+dxfLayerData::addLineStrip(const dimeVec3* pts, const int numpts,
+                           const dimeMatrix* const matrix)
+{
+	if (numpts < 2) return;
+
+	// transform the points in batches
+	const int batchsize = 64;
+	dimeVec3 t[batchsize];
+
+	this->markLineEntity();
+	for (int i = 0; i < numpts; i += batchsize)
+	{
+		const int n = numpts - i < batchsize ? numpts - i : batchsize;
+		const dimeVec3* v = pts + i;
+		if (matrix)
+		{
+			matrix->transformPoints(v, t, n);
+			v = t;
+		}
+		for (int j = 0; j < n; j++)
+		{
+			const int idx = this->addLineVertex(v[j]);
+			if (i + j == 0)
+			{
+				// continue the previous strip if it ends at this point
+				if (lineindices.count() && lineindices[lineindices.count() - 1] == idx) continue;
+				if (lineindices.count()) lineindices.append(-1);
+			}
+			lineindices.append(idx);
+		}
+	}
+}
+
 /*!
   Adds a point to this layer's geometry. If \a matrix != NULL, the
   point will be transformed by this matrix before it is added.
@@ -116,15 +601,16 @@ void
 dxfLayerData::addPoint(const dimeVec3& v,
                        const dimeMatrix* const matrix)
 {
+	this->markPointEntity();
 	if (matrix)
 	{
 		dimeVec3 t;
-		matrix->multMatrixVec(v, t);
-		points.append(t);
+		matrix->transformPoints(&v, &t, 1);
+		points.append(t - this->origin);
 	}
 	else
 	{
-		points.append(v);
+		points.append(v - this->origin);
 	}
 }
 
@@ -140,22 +626,21 @@ dxfLayerData::addTriangle(const dimeVec3& v0,
 {
 	if (this->fillmode)
 	{
+		this->markFaceEntity();
 		if (matrix)
 		{
-			dimeVec3 t0, t1, t2;
-			matrix->multMatrixVec(v0, t0);
-			matrix->multMatrixVec(v1, t1);
-			matrix->multMatrixVec(v2, t2);
-			faceindices.append(facebsp.addPoint(t0));
-			faceindices.append(facebsp.addPoint(t1));
-			faceindices.append(facebsp.addPoint(t2));
+			dimeVec3 t[3] = { v0, v1, v2 };
+			matrix->transformPoints(t, t, 3);
+			faceindices.append(this->addFaceVertex(t[0]));
+			faceindices.append(this->addFaceVertex(t[1]));
+			faceindices.append(this->addFaceVertex(t[2]));
 			faceindices.append(-1);
 		}
 		else
 		{
-			faceindices.append(facebsp.addPoint(v0));
-			faceindices.append(facebsp.addPoint(v1));
-			faceindices.append(facebsp.addPoint(v2));
+			faceindices.append(this->addFaceVertex(v0));
+			faceindices.append(this->addFaceVertex(v1));
+			faceindices.append(this->addFaceVertex(v2));
 			faceindices.append(-1);
 		}
 	}
@@ -180,25 +665,23 @@ dxfLayerData::addQuad(const dimeVec3& v0,
 {
 	if (this->fillmode)
 	{
+		this->markFaceEntity();
 		if (matrix)
 		{
-			dimeVec3 t0, t1, t2, t3;
-			matrix->multMatrixVec(v0, t0);
-			matrix->multMatrixVec(v1, t1);
-			matrix->multMatrixVec(v2, t2);
-			matrix->multMatrixVec(v3, t3);
-			faceindices.append(facebsp.addPoint(t0));
-			faceindices.append(facebsp.addPoint(t1));
-			faceindices.append(facebsp.addPoint(t2));
-			faceindices.append(facebsp.addPoint(t3));
+			dimeVec3 t[4] = { v0, v1, v2, v3 };
+			matrix->transformPoints(t, t, 4);
+			faceindices.append(this->addFaceVertex(t[0]));
+			faceindices.append(this->addFaceVertex(t[1]));
+			faceindices.append(this->addFaceVertex(t[2]));
+			faceindices.append(this->addFaceVertex(t[3]));
 			faceindices.append(-1);
 		}
 		else
 		{
-			faceindices.append(facebsp.addPoint(v0));
-			faceindices.append(facebsp.addPoint(v1));
-			faceindices.append(facebsp.addPoint(v2));
-			faceindices.append(facebsp.addPoint(v3));
+			faceindices.append(this->addFaceVertex(v0));
+			faceindices.append(this->addFaceVertex(v1));
+			faceindices.append(this->addFaceVertex(v2));
+			faceindices.append(this->addFaceVertex(v3));
 			faceindices.append(-1);
 		}
 	}
@@ -212,247 +695,278 @@ dxfLayerData::addQuad(const dimeVec3& v0,
 }
 
 /*!
-  Exports this layer's geometry as VRML nodes.
+  Joins the line segments of this layer into as few line strips as
+  possible. addLine() only extends a strip when the new segment starts
+  where the previous one ended, so drawings made of unordered LINE
+  entities otherwise end up as lots of two-point strips.
+
+  An endpoint adjacency graph is built for all segments, and the
+  segments are chained greedily, starting at vertices with an odd
+  number of segments, since those have to be the end of some strip.
+  The chains that are left are closed loops. If \a mergeloops is
+  \c TRUE, each closed loop is spliced into a strip which passes
+  through one of its vertices, instead of being written as a
+  separate strip.
+
+  Only the order and grouping of the segments is changed. Entity
+  ranges in lineentities are updated to match.
 */
 void
-dxfLayerData::writeWrl(FILE* fp, int indent, const bool vrml1,
-                       const bool only2d)
+dxfLayerData::stitchLines(const bool mergeloops)
 {
-#ifndef NOWRLEXPORT
-	if (!faceindices.count() && !lineindices.count() && !points.count()) return;
-
-	int i, n;
-
-	dxfdouble r, g, b;
+	const int numindices = lineindices.count();
+	if (numindices < 3) return;
 
-	dimeLayer::colorToRGB(this->colidx, r, g, b);
+	const int* idx = lineindices.constArrayPointer();
+	const int numverts = this->getNumLineVertices();
 
-	if (vrml1)
+	//
+	// collect the segments, and count the segments at each vertex
+	//
+	std::vector<int> edges;
+	std::vector<int> edgeentity;
+	edges.reserve(2 * numindices);
+	std::vector<int> start(numverts + 1, 0);
+	const int numranges = lineentities.count() / 2;
+	int range = -1;
+	for (int i = 1; i < numindices; i++)
 	{
-		fprintf(fp,
-		        "Separator {\n");
+		while (range + 1 < numranges && lineentities[2 * (range + 1)] <= i) range++;
+		const int a = idx[i - 1];
+		const int b = idx[i];
+		if (a < 0 || b < 0 || a == b) continue;
+		edges.push_back(a);
+		edges.push_back(b);
+		if (numranges) edgeentity.push_back(range >= 0 ? lineentities[2 * range + 1] : -1);
+		start[a + 1]++;
+		start[b + 1]++;
 	}
-	else
+	const int numedges = static_cast<int>(edges.size()) / 2;
+	if (numedges == 0) return;
+
+	//
+	// vertex -> segments table, in compressed row storage
+	//
+	for (int i = 0; i < numverts; i++) start[i + 1] += start[i];
+	std::vector<int> adj(2 * numedges);
+	std::vector<int> cursor(start.begin(), start.end() - 1);
+	for (int e = 0; e < numedges; e++)
 	{
-		fprintf(fp,
-		        "Group {\n"
-		        "  children [\n");
+		adj[cursor[edges[2 * e]]++] = e;
+		adj[cursor[edges[2 * e + 1]]++] = e;
 	}
-	if (faceindices.count())
+	for (int i = 0; i < numverts; i++) cursor[i] = start[i];
+
+	//
+	// chains are stored as linked lists of nodes, so that closed loops
+	// can be spliced into other chains without moving any data
+	//
+	std::vector<int> nodevert;
+	std::vector<int> nodeedge; // the segment leading to the node
+	std::vector<int> nodenext;
+	std::vector<int> heads;
+	std::vector<char> closed;
+	std::vector<char> used(numedges, 0);
+	nodevert.reserve(2 * numedges);
+	nodeedge.reserve(2 * numedges);
+	nodenext.reserve(2 * numedges);
+
+	auto nextedge = [&](const int v) -> int
 	{
-		if (vrml1)
-		{
-			fprintf(fp,
-			        "  Separator {\n"
-			        "    Material {\n"
-			        "      diffuseColor %g %g %g\n"
-			        "    }\n"
-			        "    ShapeHints {\n"
-			        "      creaseAngle 0.5\n"
-			        "      vertexOrdering COUNTERCLOCKWISE\n"
-			        "      shapeType UNKNOWN_SHAPE_TYPE\n"
-			        "      faceType UNKNOWN_FACE_TYPE\n"
-			        "    }\n"
-			        "    Coordinate3 {\n"
-			        "      point [\n", r, g, b);
-		}
-		else
-		{
-			fprintf(fp,
-			        "    Shape {\n"
-			        "      appearance Appearance {\n"
-			        "        material Material {\n"
-			        "          diffuseColor %g %g %g\n"
-			        "        }\n"
-			        "      }\n"
-			        "      geometry IndexedFaceSet {\n"
-			        "        convex FALSE\n"
-			        "        solid FALSE\n"
-			        "        creaseAngle 0.5\n" // a good value for most cases
-			        "        coord Coordinate {\n"
-			        "          point [\n", r, g, b);
-		}
-		dimeVec3 v;
-		n = facebsp.numPoints();
-		for (i = 0; i < n; i++)
-		{
-			facebsp.getPoint(i, v);
-			if (only2d) v[2] = 0.0f;
-			if (i < n - 1)
-				fprintf(fp, "            %.8g %.8g %.8g,\n", v[0], v[1], v[2]);
-			else
-				fprintf(fp, "            %.8g %.8g %.8g\n", v[0], v[1], v[2]);
-		}
-		fprintf(fp,
-		        "          ]\n"
-		        "        }\n");
-		if (vrml1)
-		{
-			fprintf(fp,
-			        "    IndexedFaceSet {\n"
-			        "      coordIndex [\n          ");
-		}
-		else
+		int& c = cursor[v];
+		while (c < start[v + 1] && used[adj[c]]) c++;
+		return c < start[v + 1] ? adj[c++] : -1;
+	};
+
+	auto walk = [&](int v, int e)
+	{
+		int node = static_cast<int>(nodevert.size());
+		const int first = v;
+		heads.push_back(node);
+		nodevert.push_back(v);
+		nodeedge.push_back(-1);
+		nodenext.push_back(-1);
+		while (e >= 0)
 		{
-			fprintf(fp,
-			        "        coordIndex [\n          ");
+			used[e] = 1;
+			v = edges[2 * e] == v ? edges[2 * e + 1] : edges[2 * e];
+			nodenext[node] = static_cast<int>(nodevert.size());
+			node = nodenext[node];
+			nodevert.push_back(v);
+			nodeedge.push_back(e);
+			nodenext.push_back(-1);
+			e = nextedge(v);
 		}
-		n = faceindices.count();
-		int cnt = 1;
-		for (i = 0; i < n; i++)
+		closed.push_back(v == first);
+	};
+
+	int e;
+	for (int i = 0; i < numverts; i++)
+	{
+		if ((start[i + 1] - start[i]) & 1)
 		{
-			if ((cnt & 7) && i < n - 1) // typical case
-				fprintf(fp, "%d,", faceindices[i]);
-			else if (!(cnt & 7) && i < n - 1)
-				fprintf(fp, "%d,\n          ", faceindices[i]);
-			else
-				fprintf(fp, "%d\n", faceindices[i]);
-			cnt++;
+			while ((e = nextedge(i)) >= 0) walk(i, e);
 		}
-		fprintf(fp,
-		        "        ]\n"
-		        "      }\n"
-		        "    }\n");
 	}
-	if (lineindices.count())
+	for (int i = 0; i < numverts; i++)
 	{
-		// make sure line indices has a -1 at the end
-		if (lineindices[lineindices.count() - 1] != -1)
-		{
-			lineindices.append(-1);
-		}
-		if (vrml1)
-		{
-			fprintf(fp,
-			        "  Separator {\n"
-			        "    Material {\n"
-			        "      diffuseColor %g %g %g\n"
-			        "    }\n"
-			        "    Coordinate3 {\n"
-			        "      point [\n", r, g, b);
-		}
-		else
+		while ((e = nextedge(i)) >= 0) walk(i, e);
+	}
+
+	const int numchains = static_cast<int>(heads.size());
+	std::vector<char> removed(numchains, 0);
+
+	if (mergeloops)
+	{
+		//
+		// vertex -> a node in an open chain passing through it
+		//
+		std::vector<int> owner(numverts, -1);
+		for (int c = 0; c < numchains; c++)
 		{
-			fprintf(fp,
-			        "    Shape {\n"
-			        "      appearance Appearance {\n"
-			        "        material Material {\n"
-			        "          emissiveColor %g %g %g\n"
-			        "        }\n"
-			        "      }\n"
-			        "      geometry IndexedLineSet {\n"
-			        "        coord Coordinate {\n"
-			        "          point [\n", r, g, b);
+			if (closed[c]) continue;
+			for (int n = heads[c]; n >= 0; n = nodenext[n])
+			{
+				if (owner[nodevert[n]] < 0) owner[nodevert[n]] = n;
+			}
 		}
-		dimeVec3 v;
-		n = linebsp.numPoints();
-		for (i = 0; i < n; i++)
+		for (int c = 0; c < numchains; c++)
 		{
-			linebsp.getPoint(i, v);
-			if (only2d) v[2] = 0.0f;
-			if (i < n - 1)
-				fprintf(fp, "            %.8g %.8g %.8g,\n", v[0], v[1], v[2]);
+			if (!closed[c]) continue;
+			//
+			// the loop is n0 -> n1 -> ... -> nk, and n0 and nk share
+			// the same vertex. Find the first node (nh) with a vertex
+			// which is already used by some other chain.
+			//
+			const int n0 = heads[c];
+			int nh = -1;
+			int nk = n0;
+			for (int n = n0; n >= 0; n = nodenext[n])
+			{
+				if (nh < 0 && nodenext[n] >= 0 && owner[nodevert[n]] >= 0) nh = n;
+				nk = n;
+			}
+			// nodes in this loop may be used by later loops
+			for (int n = nodenext[n0]; n >= 0; n = nodenext[n])
+			{
+				if (owner[nodevert[n]] < 0) owner[nodevert[n]] = n;
+			}
+			if (nh < 0) continue;
+
+			//
+			// insert the loop, rotated to start and end at the
+			// shared vertex, after the other chain's node
+			//
+			const int target = owner[nodevert[nh]];
+			if (nh == n0)
+			{
+				nodenext[nk] = nodenext[target];
+				nodenext[target] = nodenext[n0];
+			}
 			else
-				fprintf(fp, "            %.8g %.8g %.8g\n", v[0], v[1], v[2]);
-		}
-		fprintf(fp,
-		        "          ]\n"
-		        "        }\n");
-		if (vrml1)
-		{
-			fprintf(fp,
-			        "    IndexedLineSet {\n"
-			        "      coordIndex [\n          ");
-		}
-		else
-		{
-			fprintf(fp, "        coordIndex [\n          ");
+			{
+				// n0 duplicates nk, and is dropped
+				const int after = nodenext[nh];
+				nodenext[nk] = nodenext[n0];
+				nodenext[nh] = nodenext[target];
+				nodenext[target] = after;
+			}
+			removed[c] = 1;
 		}
+	}
 
-		n = lineindices.count();
-		int cnt = 1;
-		for (i = 0; i < n; i++)
+	//
+	// write the chains back, separated by -1. Since the spliced loops
+	// are rotated, every node except the first in a chain is still
+	// reached by the segment in nodeedge.
+	//
+	lineindices.makeEmpty(numedges + 2 * numchains);
+	if (numranges) lineentities.makeEmpty();
+	for (int c = 0; c < numchains; c++)
+	{
+		if (removed[c]) continue;
+		if (lineindices.count()) lineindices.append(-1);
+		for (int n = heads[c]; n >= 0; n = nodenext[n])
 		{
-			if ((cnt & 7) && i < n - 1) // typical case
-				fprintf(fp, "%d,", lineindices[i]);
-			else if (!(cnt & 7) && i < n - 1)
-				fprintf(fp, "%d,\n          ", lineindices[i]);
-			else
-				fprintf(fp, "%d\n", lineindices[i]);
-			cnt++;
+			if (numranges && nodeedge[n] >= 0)
+			{
+				const int id = edgeentity[nodeedge[n]];
+				const int cnt = lineentities.count();
+				if (id >= 0 && (cnt == 0 || lineentities[cnt - 1] != id))
+				{
+					lineentities.append(lineindices.count());
+					lineentities.append(id);
+				}
+			}
+			lineindices.append(nodevert[n]);
 		}
-		fprintf(fp,
-		        "        ]\n"
-		        "      }\n"
-		        "    }\n");
 	}
+}
+
+/*!
+  Sends the geometry for this layer to \a sink. The entity ranges are
+  only sent if \a entityranges is \c TRUE.
+  \sa dxfConverter::writeGeometry()
+*/
+void
+dxfLayerData::writeGeometry(dxfGeometrySink* sink, const bool entityranges)
+{
+	if (!faceindices.count() && !lineindices.count() && !points.count()) return;
 
+	dxfdouble r, g, b;
+	dimeLayer::colorToRGB(this->colidx, r, g, b);
+	dimeArray<dimeVec3> tmp(1);
 
-	if (points.count() && false)
+	if (this->grouplayer || this->groupentity >= 0)
 	{
-		// FIXME disabled, suspect bug. pederb, 2001-12-11 
-		if (vrml1)
-		{
-			fprintf(fp,
-			        "  Separator {\n"
-			        "    Material {\n"
-			        "      diffuseColor %g %g %g\n"
-			        "    }\n"
-			        "    Coordinate3 {\n"
-			        "      point [\n", r, g, b);
-		}
-		else
-		{
-			fprintf(fp,
-			        "    Shape {\n"
-			        "      appearance Appearance {\n"
-			        "        material Material {\n"
-			        "          emissiveColor %g %g %g\n"
-			        "        }\n"
-			        "      \n"
-			        "      geometry PointSet {\n"
-			        "        coord Coordinate {\n"
-			        "          point [\n", r, g, b);
-		}
-		dimeVec3 v;
-		n = points.count();
-		for (i = 0; i < n; i++)
+		sink->setGroupInfo(this->grouplayer ? this->grouplayer->getLayerName() : nullptr,
+		                   this->groupentity);
+	}
+	sink->beginLayer(this->colidx, r, g, b);
+	if (faceindices.count())
+	{
+		if (entityranges && faceentities.count())
 		{
-			v = points[i];
-			if (only2d) v[2] = 0.0f;
-			if (i < n - 1)
-				fprintf(fp, "            %g %g %g,\n", v[0], v[1], v[2]);
-			else
-				fprintf(fp, "            %g %g %g\n", v[0], v[1], v[2]);
+			sink->setEntityRanges(faceentities.constArrayPointer(), faceentities.count() / 2);
 		}
-		fprintf(fp,
-		        "          ]\n"
-		        "        }\n");
-		if (vrml1)
+		if (normalindices.count() == faceindices.count())
 		{
-			fprintf(fp,
-			        "    PointSet {\n"
-			        "      numPoints %d\n"
-			        "    }\n"
-			        "  }\n", points.count());
-		}
-		else
-		{
-			fprintf(fp,
-			        "      }\n"
-			        "    }\n");
+			sink->setFaceNormals(facenormals.constArrayPointer(), facenormals.count(),
+			                     normalindices.constArrayPointer());
 		}
+		sink->addFaces(this->getFaceVertices(tmp), this->getNumFaceVertices(),
+		               faceindices.constArrayPointer(), faceindices.count());
 	}
-
-	if (vrml1)
+	if (lineindices.count())
 	{
-		fprintf(fp, "}\n");
+		if (entityranges && lineentities.count())
+		{
+			sink->setEntityRanges(lineentities.constArrayPointer(), lineentities.count() / 2);
+		}
+		sink->addLines(this->getLineVertices(tmp), this->getNumLineVertices(),
+		               lineindices.constArrayPointer(), lineindices.count());
 	}
-	else
+	if (points.count())
 	{
-		fprintf(fp,
-		        "  ]\n"
-		        "}\n");
+		sink->addPoints(points.constArrayPointer(), points.count());
 	}
+	sink->endLayer();
+}
+
+/*!
+  Exports this layer's geometry as VRML nodes. No VRML header is
+  written.
+
+  \sa dxfVrmlWriter
+*/
+void
+dxfLayerData::writeWrl(FILE* fp, int indent, const bool vrml1,
+                       const bool only2d)
+{
+#ifndef NOWRLEXPORT
+	dxfVrmlWriter writer(fp, vrml1, only2d);
+	if (this->floatpoints) writer.setOrigin(this->origin);
+	this->writeGeometry(&writer);
+	writer.end();
 #endif // NOWRLEXPORT
 }
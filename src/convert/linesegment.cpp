@@ -32,6 +32,7 @@
 
 #include "linesegment.h"
 #include <dime/convert/layerdata.h>
+#include "../Diagnostic.h"
 
 #define FLAG_V_CALCULATED 0x1
 #define FLAG_CONNECT_CALCULATED 0x2
@@ -86,8 +87,8 @@ intersect_line(const dimeVec3& v0, // first line
 	dxfdouble eeps = 1.0e-7;
 	if (fabs(f) < eeps)
 	{
-		fprintf(stderr, "linesegment.cpp: intersect_line: taendl: almost parallel lines (determinant < eeps = %g)!\n",
-		        eeps);
+		dime_diagnostic("linesegment.cpp: intersect_line: taendl: almost parallel lines (determinant < eeps = %g)!\n",
+		                eeps);
 		isect = v1; // just set some value
 		return false;
 	}
@@ -31,6 +31,7 @@
 \**************************************************************************/
 
 #include "convert_funcs.h"
+#include <dime/convert/convert.h>
 #include <dime/convert/layerdata.h>
 #include "linesegment.h"
 #include <dime/entities/LWPolyline.h>
@@ -39,7 +40,7 @@
 
 void
 convert_lwpolyline(const DimeEntity* entity, const DimeState* state,
-                   dxfLayerData* layerData, dxfConverter*)
+                   dxfLayerData* layerData, dxfConverter* converter)
 {
 	auto pline = (DimeLWPolyline*)entity;
 
@@ -78,9 +79,31 @@ convert_lwpolyline(const DimeEntity* entity, const DimeState* state,
 	        thickness);
 	};
 
+	bool closed = pline->getFlags() & 1;
+
+	bool haswidth = constantWidth != 0.0;
+	for (int i = 0; i < n && !haswidth; i++)
+	{
+		if ((sw && sw[i] != 0.0) || (ew && ew[i] != 0.0)) haswidth = true;
+	}
+
+	if (closed && n >= 3 && thickness == 0.0 && !haswidth &&
+		converter->getFillPolygons() && converter->getFillmode())
+	{
+		dimeArray<dimeVec3> pts(n);
+		for (int i = 0; i < n; i++)
+		{
+			pts.append(dimeVec3(x[i], y[i], elev));
+		}
+		if (convert_fill_loop(pts.constArrayPointer(), pline->getBulges(), n,
+		                      &matrix, layerData, converter))
+		{
+			return;
+		}
+	}
+
 	dxfLineSegment segment, nextseg, prevseg;
 
-	bool closed = pline->getFlags() & 1;
 	int stop = closed ? n : n - 1;
 	int next, next2;
 
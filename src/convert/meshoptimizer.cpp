@@ -0,0 +1,523 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*!
+  \class dxfMeshOptimizer meshoptimizer.h
+  \brief The dxfMeshOptimizer class makes the polygons of a dxfLayerData render-ready.
+
+  The converters add polygons in the order the entities are read, as
+  a mix of triangles and quads. optimize() post-processes the polygons
+  of a layer:
+
+  - quads and larger polygons are split into triangles, and triangles
+    without area are removed.
+  - the triangles are reordered for the post-transform vertex cache
+    of the GPU, using the Tipsify algorithm (Sander, Nehab and Barczak,
+    "Fast Triangle Reordering for Vertex Locality and Reduced
+    Overdraw", 2007).
+  - the vertices are renumbered in the order they are first used,
+    and unused vertices are removed. This improves memory locality and
+    lets more meshes use 16 bit indices.
+  - optionally, vertex normals are calculated. Faces meeting at an
+    angle larger than the crease angle do not share normals. Normals
+    are calculated in parallel for large meshes.
+
+  After optimization, dxfLayerData::faceindices contains only
+  triangles, and the normals are stored in dxfLayerData::facenormals
+  and dxfLayerData::normalindices. Entity ranges in
+  dxfLayerData::faceentities are updated to match the new order.
+
+  \sa dxfConverter::optimizeMeshes()
+*/
+
+/*!
+  \fn int dxfMeshOptimizer::getCacheSize() const
+  Returns the vertex cache size used when reordering triangles.
+*/
+
+/*!
+  \fn dxfdouble dxfMeshOptimizer::getCreaseAngle() const
+  Returns the crease angle used when calculating normals.
+*/
+
+/*!
+  \fn bool dxfMeshOptimizer::getNormals() const
+  Returns whether normals are calculated.
+*/
+
+/*!
+  \fn int dxfMeshOptimizer::getNumThreads() const
+  Returns the number of threads used for calculating normals.
+*/
+
+#include <dime/convert/meshoptimizer.h>
+#include <dime/convert/layerdata.h>
+#include <math.h>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+// meshes with fewer triangles than this are handled by one thread
+#define MIN_PARALLEL_TRIANGLES 16384
+
+namespace {
+
+//
+// calls func(begin, end) for numthreads ranges in [0, n)
+//
+template <class F>
+void
+parallel_for(const int n, int numthreads, const F& func)
+{
+	if (numthreads > n / 1024) numthreads = n / 1024;
+	if (numthreads <= 1)
+	{
+		func(0, n);
+		return;
+	}
+	std::vector<std::thread> threads;
+	threads.reserve(numthreads - 1);
+	const int chunk = (n + numthreads - 1) / numthreads;
+	for (int i = 1; i < numthreads; i++)
+	{
+		const int begin = i * chunk;
+		const int end = std::min(n, begin + chunk);
+		if (begin >= end) break;
+		threads.emplace_back([&func, begin, end]() { func(begin, end); });
+	}
+	func(0, std::min(n, chunk));
+	for (std::thread& t : threads) t.join();
+}
+
+bool
+is_degenerate(const dimeVec3& v0, const dimeVec3& v1, const dimeVec3& v2)
+{
+	const dimeVec3 e0 = v1 - v0;
+	const dimeVec3 e1 = v2 - v0;
+	const dxfdouble len = e0.cross(e1).sqrLength();
+	return len <= 1.0e-24 * e0.sqrLength() * e1.sqrLength();
+}
+
+void
+add_triangle(std::vector<int>& tris, const dimeVec3* verts,
+             const int i0, const int i1, const int i2)
+{
+	if (i0 == i1 || i1 == i2 || i2 == i0) return;
+	if (is_degenerate(verts[i0], verts[i1], verts[i2])) return;
+	tris.push_back(i0);
+	tris.push_back(i1);
+	tris.push_back(i2);
+}
+
+//
+// splits a quad along the diagonal which gives two triangles facing
+// the same way, preferring the shorter diagonal
+//
+void
+add_quad(std::vector<int>& tris, const dimeVec3* verts, const int* idx)
+{
+	const dimeVec3& v0 = verts[idx[0]];
+	const dimeVec3& v1 = verts[idx[1]];
+	const dimeVec3& v2 = verts[idx[2]];
+	const dimeVec3& v3 = verts[idx[3]];
+
+	const bool ok02 = (v1 - v0).cross(v2 - v0).dot((v2 - v0).cross(v3 - v0)) >= 0.0;
+	const bool ok13 = (v1 - v0).cross(v3 - v0).dot((v2 - v1).cross(v3 - v1)) >= 0.0;
+	bool use02 = (v2 - v0).sqrLength() <= (v3 - v1).sqrLength();
+	if (use02 && !ok02 && ok13) use02 = false;
+	else if (!use02 && !ok13 && ok02) use02 = true;
+
+	if (use02)
+	{
+		add_triangle(tris, verts, idx[0], idx[1], idx[2]);
+		add_triangle(tris, verts, idx[0], idx[2], idx[3]);
+	}
+	else
+	{
+		add_triangle(tris, verts, idx[0], idx[1], idx[3]);
+		add_triangle(tris, verts, idx[1], idx[2], idx[3]);
+	}
+}
+
+//
+// Tipsify. Returns the new order of the triangles in tris.
+//
+std::vector<int>
+tipsify(const std::vector<int>& tris, const int numverts, const int cachesize)
+{
+	const int numtris = static_cast<int>(tris.size()) / 3;
+
+	// vertex -> triangles
+	std::vector<int> start(numverts + 1, 0);
+	for (int idx : tris) start[idx + 1]++;
+	for (int i = 0; i < numverts; i++) start[i + 1] += start[i];
+	std::vector<int> adj(tris.size());
+	{
+		std::vector<int> pos(start.begin(), start.end() - 1);
+		for (int t = 0; t < numtris; t++)
+		{
+			for (int k = 0; k < 3; k++) adj[pos[tris[3 * t + k]]++] = t;
+		}
+	}
+
+	std::vector<int> live(numverts);
+	for (int i = 0; i < numverts; i++) live[i] = start[i + 1] - start[i];
+	std::vector<int> cachetime(numverts, 0);
+	std::vector<char> emitted(numtris, 0);
+	std::vector<int> deadend;
+	std::vector<int> candidates;
+	std::vector<int> out;
+	out.reserve(numtris);
+
+	int timestamp = cachesize + 1;
+	int cursor = 0;
+	int fan = 0;
+	while (fan < numverts && live[fan] == 0) fan++;
+
+	while (fan >= 0 && fan < numverts)
+	{
+		candidates.clear();
+		for (int i = start[fan]; i < start[fan + 1]; i++)
+		{
+			const int t = adj[i];
+			if (emitted[t]) continue;
+			emitted[t] = 1;
+			out.push_back(t);
+			for (int k = 0; k < 3; k++)
+			{
+				const int v = tris[3 * t + k];
+				deadend.push_back(v);
+				candidates.push_back(v);
+				live[v]--;
+				if (timestamp - cachetime[v] > cachesize)
+				{
+					cachetime[v] = timestamp++;
+				}
+			}
+		}
+
+		//
+		// next fanning vertex: the candidate still in the cache which
+		// entered it first, if all its triangles fit in the cache
+		//
+		int best = -1;
+		int bestpriority = -1;
+		for (int v : candidates)
+		{
+			if (live[v] <= 0) continue;
+			int priority = 0;
+			if (timestamp - cachetime[v] + 2 * live[v] <= cachesize)
+			{
+				priority = timestamp - cachetime[v];
+			}
+			if (priority > bestpriority)
+			{
+				bestpriority = priority;
+				best = v;
+			}
+		}
+		if (best < 0)
+		{
+			// dead end, use a recently used vertex, or the next in order
+			while (!deadend.empty() && best < 0)
+			{
+				const int v = deadend.back();
+				deadend.pop_back();
+				if (live[v] > 0) best = v;
+			}
+			while (best < 0 && cursor < numverts)
+			{
+				if (live[cursor] > 0) best = cursor;
+				cursor++;
+			}
+		}
+		fan = best;
+	}
+	return out;
+}
+
+} // namespace
+
+/*!
+  Constructor.
+*/
+dxfMeshOptimizer::dxfMeshOptimizer()
+{
+	this->cacheSize = 16;
+	this->creaseAngle = 0.5;
+	this->normals = true;
+	this->numThreads = 0;
+}
+
+/*!
+  Sets the size of the vertex cache to optimize for. The default is 16,
+  which works well for most GPUs.
+*/
+void
+dxfMeshOptimizer::setCacheSize(const int size)
+{
+	this->cacheSize = size < 3 ? 3 : size;
+}
+
+/*!
+  Sets the crease angle, in radians. Faces meeting at a larger angle
+  get separate normals. The default is 0.5, the same crease angle as
+  the VRML files are written with.
+*/
+void
+dxfMeshOptimizer::setCreaseAngle(const dxfdouble angle)
+{
+	this->creaseAngle = angle;
+}
+
+/*!
+  Sets whether normals should be calculated. Default is \c TRUE.
+*/
+void
+dxfMeshOptimizer::setNormals(const bool onoff)
+{
+	this->normals = onoff;
+}
+
+/*!
+  Sets the number of threads used to calculate normals. If \a num is
+  0 (the default), one thread is used for each hardware thread.
+*/
+void
+dxfMeshOptimizer::setNumThreads(const int num)
+{
+	this->numThreads = num < 0 ? 0 : num;
+}
+
+/*!
+  Optimizes the polygons in \a layer. Lines and points are not
+  changed.
+*/
+void
+dxfMeshOptimizer::optimize(dxfLayerData* layer) const
+{
+	layer->facenormals.makeEmpty();
+	layer->normalindices.makeEmpty();
+
+	const int numindices = layer->faceindices.count();
+	if (numindices == 0) return;
+
+	const int* idx = layer->faceindices.constArrayPointer();
+	dimeArray<dimeVec3> tmp(1);
+	const dimeVec3* verts = layer->getFaceVertices(tmp);
+	const int numverts = layer->getNumFaceVertices();
+
+	//
+	// triangulate, and remove degenerate triangles
+	//
+	std::vector<int> tris;
+	std::vector<int> triid; // entity id for each triangle
+	tris.reserve(numindices);
+	const int numranges = layer->faceentities.count() / 2;
+	const int* ranges = layer->faceentities.constArrayPointer();
+	int range = -1;
+	int start = 0;
+	for (int i = 0; i <= numindices; i++)
+	{
+		if (i < numindices && idx[i] >= 0) continue;
+		const int n = i - start;
+		if (n == 4)
+		{
+			add_quad(tris, verts, idx + start);
+		}
+		else
+		{
+			// the polygons are convex, so a triangle fan will do
+			for (int j = start + 1; j < i - 1; j++)
+			{
+				add_triangle(tris, verts, idx[start], idx[j], idx[j + 1]);
+			}
+		}
+		if (numranges)
+		{
+			while (range + 1 < numranges && ranges[2 * (range + 1)] <= start) range++;
+			const int id = range >= 0 ? ranges[2 * range + 1] : -1;
+			triid.resize(tris.size() / 3, id);
+		}
+		start = i + 1;
+	}
+
+	const std::vector<int> order = tipsify(tris, numverts, this->cacheSize);
+	{
+		std::vector<int> sorted;
+		sorted.reserve(tris.size());
+		for (int t : order)
+		{
+			sorted.push_back(tris[3 * t]);
+			sorted.push_back(tris[3 * t + 1]);
+			sorted.push_back(tris[3 * t + 2]);
+		}
+		tris.swap(sorted);
+	}
+
+	//
+	// renumber the vertices in the order they are used
+	//
+	std::vector<int> remap(numverts, -1);
+	std::vector<dimeVec3> used;
+	used.reserve(numverts);
+	for (int& v : tris)
+	{
+		if (remap[v] < 0)
+		{
+			remap[v] = static_cast<int>(used.size());
+			used.push_back(verts[v]);
+		}
+		v = remap[v];
+	}
+	layer->setFaceVertices(used.data(), static_cast<int>(used.size()));
+
+	const int numtris = static_cast<int>(tris.size()) / 3;
+	layer->faceindices.makeEmpty(4 * numtris + 1);
+	if (numranges) layer->faceentities.makeEmpty();
+	for (int t = 0; t < numtris; t++)
+	{
+		if (numranges)
+		{
+			const int id = triid[order[t]];
+			const int cnt = layer->faceentities.count();
+			if (id >= 0 && (cnt == 0 || layer->faceentities[cnt - 1] != id))
+			{
+				layer->faceentities.append(layer->faceindices.count());
+				layer->faceentities.append(id);
+			}
+		}
+		layer->faceindices.append(tris[3 * t]);
+		layer->faceindices.append(tris[3 * t + 1]);
+		layer->faceindices.append(tris[3 * t + 2]);
+		layer->faceindices.append(-1);
+	}
+	if (!this->normals || numtris == 0) return;
+
+	//
+	// area weighted and unit face normals
+	//
+	const int numused = static_cast<int>(used.size());
+	int numthreads = this->numThreads;
+	if (numthreads == 0) numthreads = static_cast<int>(std::thread::hardware_concurrency());
+	if (numtris < MIN_PARALLEL_TRIANGLES || numthreads < 1) numthreads = 1;
+
+	std::vector<dimeVec3> facen(numtris);
+	std::vector<dimeVec3> unitn(numtris);
+	parallel_for(numtris, numthreads, [&](const int begin, const int end)
+	{
+		for (int t = begin; t < end; t++)
+		{
+			const dimeVec3& v0 = used[tris[3 * t]];
+			facen[t] = (used[tris[3 * t + 1]] - v0).cross(used[tris[3 * t + 2]] - v0);
+			unitn[t] = facen[t];
+			unitn[t].normalize();
+		}
+	});
+
+	// vertex -> triangle corners
+	std::vector<int> cstart(numused + 1, 0);
+	for (int v : tris) cstart[v + 1]++;
+	for (int i = 0; i < numused; i++) cstart[i + 1] += cstart[i];
+	std::vector<int> corners(tris.size());
+	{
+		std::vector<int> pos(cstart.begin(), cstart.end() - 1);
+		for (int c = 0; c < static_cast<int>(tris.size()); c++)
+		{
+			corners[pos[tris[c]]++] = c;
+		}
+	}
+
+	//
+	// For each corner, the normal is the sum of the normals of the faces
+	// around the vertex which are within the crease angle of the corner's
+	// face. Equal normals at a vertex are shared. The unique normals of
+	// vertex v are stored in uniq[cstart[v]...].
+	//
+	const dxfdouble mincos = cos(this->creaseAngle);
+	std::vector<dimeVec3> uniq(tris.size());
+	std::vector<int> numuniq(numused, 0);
+	std::vector<int> cornerid(tris.size());
+
+	parallel_for(numused, numthreads, [&](const int begin, const int end)
+	{
+		for (int v = begin; v < end; v++)
+		{
+			const int first = cstart[v];
+			const int last = cstart[v + 1];
+			int cnt = 0;
+			for (int i = first; i < last; i++)
+			{
+				const int t = corners[i] / 3;
+				dimeVec3 n(0.0, 0.0, 0.0);
+				for (int j = first; j < last; j++)
+				{
+					const int t2 = corners[j] / 3;
+					if (t2 == t || unitn[t].dot(unitn[t2]) >= mincos) n += facen[t2];
+				}
+				if (n.sqrLength() > 0.0) n.normalize();
+				else n = unitn[t];
+
+				int k;
+				for (k = 0; k < cnt; k++)
+				{
+					if (uniq[first + k].equals(n, 1.0e-9)) break;
+				}
+				if (k == cnt) uniq[first + cnt++] = n;
+				cornerid[corners[i]] = k;
+			}
+			numuniq[v] = cnt;
+		}
+	});
+
+	std::vector<int> offset(numused + 1, 0);
+	for (int v = 0; v < numused; v++) offset[v + 1] = offset[v] + numuniq[v];
+
+	layer->facenormals.makeEmpty(offset[numused] + 1);
+	for (int v = 0; v < numused; v++)
+	{
+		for (int k = 0; k < numuniq[v]; k++)
+		{
+			layer->facenormals.append(uniq[cstart[v] + k]);
+		}
+	}
+	layer->normalindices.makeEmpty(4 * numtris + 1);
+	for (int t = 0; t < numtris; t++)
+	{
+		for (int k = 0; k < 3; k++)
+		{
+			const int c = 3 * t + k;
+			layer->normalindices.append(offset[tris[c]] + cornerid[c]);
+		}
+		layer->normalindices.append(-1);
+	}
+}
@@ -39,6 +39,7 @@
 #include <dime/entities/Vertex.h>
 #include <dime/entities/Arc.h>
 #include <dime/State.h>
+#include "../Diagnostic.h"
 
 
 static void convert_line_3d(DimePolyline* pline, const DimeState* state,
@@ -96,6 +97,26 @@ set_segment_data(dxfLineSegment* segment,
 }
 
 
+//
+// returns true if any of the polyline segments have a width
+//
+static bool
+has_width(DimePolyline* pline)
+{
+	dimeParam param;
+	if (pline->getRecord(40, param) && param.double_data != 0.0) return true;
+	if (pline->getRecord(41, param) && param.double_data != 0.0) return true;
+
+	const int n = pline->getNumCoordVertices();
+	for (int i = 0; i < n; i++)
+	{
+		DimeVertex* v = pline->getCoordVertex(i);
+		if (v->getRecord(40, param) && param.double_data != 0.0) return true;
+		if (v->getRecord(41, param) && param.double_data != 0.0) return true;
+	}
+	return false;
+}
+
 static void
 convert_line(DimePolyline* pline, const DimeState* state,
              dxfLayerData* layerData, dxfConverter* converter)
@@ -122,6 +143,28 @@ convert_line(DimePolyline* pline, const DimeState* state,
 
 	dxfdouble elev = pline->getElevation()[2];
 
+	if ((pline->getFlags() & 1) && n >= 3 && thickness == 0.0 &&
+		converter->getFillPolygons() && converter->getFillmode() &&
+		!has_width(pline))
+	{
+		dimeArray<dimeVec3> pts(n);
+		dimeArray<dxfdouble> bulges(n);
+		dimeParam param;
+		for (i = 0; i < n; i++)
+		{
+			DimeVertex* cv = pline->getCoordVertex(i);
+			dimeVec3 p = cv->getCoords();
+			p[2] = elev;
+			pts.append(p);
+			bulges.append(cv->getRecord(42, param) ? param.double_data : 0.0);
+		}
+		if (convert_fill_loop(pts.constArrayPointer(), bulges.constArrayPointer(),
+		                      n, &matrix, layerData, converter))
+		{
+			return;
+		}
+	}
+
 	dxfLineSegment prevseg, nextseg, segment;
 
 	DimeVertex* v = nullptr;
@@ -322,7 +365,7 @@ convert_mesh(DimePolyline* pline, const DimeState* state,
 			else
 			{
 				// give up... can't find the dimensions
-				fprintf(stderr, "Error: Unable to find polymesh dimensions.\n");
+				dime_diagnostic("Error: Unable to find polymesh dimensions.\n");
 				return;
 			}
 		}
@@ -36,6 +36,7 @@
 #include <dime/entities/Solid.h>
 #include <dime/util/Linear.h>
 #include <dime/State.h>
+#include "../Diagnostic.h"
 
 
 void
@@ -116,7 +117,7 @@ convert_solid_data(dimeVec3* v, dimeVec3& e, dxfdouble thickness,
 		}
 		break;
 	default:
-		fprintf(stderr, "Unexpected error converting SOLID\n");
+		dime_diagnostic("Unexpected error converting SOLID\n");
 		break;
 	}
 }
@@ -0,0 +1,262 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#include "tessellation.h"
+#include "convert_funcs.h"
+#include <string.h>
+
+/*!
+  \class dxfTessellationCache tessellation.h
+  \brief The dxfTessellationCache class caches subdivision counts and
+  unit circle sample tables used when tessellating circles, arcs and
+  ellipses.
+
+  Most drawings reuse a small set of radii and arc spans, so instead of
+  evaluating cos() and sin() for every vertex of every curve, the
+  converters fetch a precomputed table here and only scale, rotate
+  and translate it.
+*/
+
+// upper bounds before the cache is flushed, to keep memory usage
+// bounded for drawings with lots of unique radii or spans.
+#define MAX_NUMSUB_ENTRIES 4096
+#define MAX_TABLE_SAMPLES (1 << 20)
+
+static size_t
+hash_double(double d)
+{
+	if (d == 0.0) d = 0.0; // -0.0 and 0.0 compare equal
+	uint64_t bits;
+	memcpy(&bits, &d, sizeof(bits));
+	return (size_t)(bits ^ (bits >> 29));
+}
+
+size_t
+dxfTessellationCache::KeyHash::operator()(const Key& k) const
+{
+	size_t h = (size_t)k.kind * 31 + (size_t)k.numseg;
+	h = h * 1000003 ^ hash_double(k.a);
+	h = h * 1000003 ^ hash_double(k.b);
+	h = h * 1000003 ^ hash_double(k.c);
+	return h;
+}
+
+//
+// find intersection between circle and the line x=r-maxerr,
+// and return the number of circle subdivisions necessary
+// to respect the maxerr parameter.
+//
+static int
+calc_num_sub(dxfdouble maxerr, dxfdouble radius)
+{
+	radius = fabs(radius);
+
+	if (maxerr >= radius || maxerr <= 0.0) maxerr = radius / 40.0f;
+
+	dxfdouble x = radius - maxerr;
+	dxfdouble y = sqrt(radius * radius - x * x);
+
+	dxfdouble rad = atan(y / x);
+
+	return static_cast<int>(M_PI / fabs(rad)) + 1;
+}
+
+//
+// find intersection between ellipse and the line x=r-maxerr,
+// and return the number of subdivisions necessary
+// to respect the maxerr parameter.
+//
+static int
+calc_num_sub(dxfdouble maxerr, dxfdouble a, dxfdouble b)
+{
+	dxfdouble minrad = a < b ? a : b;
+
+	if (maxerr >= minrad) maxerr = minrad / 40.0f;
+
+	dxfdouble x, y;
+
+	if (a >= b)
+	{
+		x = a - maxerr;
+		y = sqrt((1.0 - (x * x) / (a * a)) * b * b);
+	}
+	else
+	{
+		x = b - maxerr;
+		y = sqrt((1.0 - (x * x) / (b * b)) * a * a);
+	}
+
+	dxfdouble rad = atan(y / x);
+	return static_cast<int>(M_PI / fabs(rad)) + 1;
+}
+
+/*!
+  Constructor.
+*/
+dxfTessellationCache::dxfTessellationCache()
+	: numsamples(0)
+{
+}
+
+/*!
+  Destructor.
+*/
+dxfTessellationCache::~dxfTessellationCache()
+{
+	this->clear();
+}
+
+/*!
+  Returns the number of subdivisions needed for a full circle with
+  radius \a radius to respect \a maxerr.
+*/
+int
+dxfTessellationCache::getCircleNumSub(const dxfdouble maxerr,
+                                      const dxfdouble radius)
+{
+	Key key = {CIRCLE_NUMSUB, 0, maxerr, fabs(radius), 0.0};
+	auto it = this->numsubs.find(key);
+	if (it != this->numsubs.end()) return it->second;
+
+	this->checkLimits();
+	int num = calc_num_sub(maxerr, radius);
+	this->numsubs.emplace(key, num);
+	return num;
+}
+
+/*!
+  Returns the number of subdivisions needed for a full ellipse with
+  semi axes \a a and \a b to respect \a maxerr.
+*/
+int
+dxfTessellationCache::getEllipseNumSub(const dxfdouble maxerr,
+                                       const dxfdouble a, const dxfdouble b)
+{
+	Key key = {ELLIPSE_NUMSUB, 0, maxerr, a, b};
+	auto it = this->numsubs.find(key);
+	if (it != this->numsubs.end()) return it->second;
+
+	this->checkLimits();
+	int num = calc_num_sub(maxerr, a, b);
+	this->numsubs.emplace(key, num);
+	return num;
+}
+
+/*!
+  Returns a table with \a numseg + 1 samples on the unit circle, from
+  angle 0 to angle 2PI. The returned table is owned by the cache, and
+  is valid until the next call to this method or to clear().
+
+  Only full circles are cached, since the number of segments repeats
+  across a drawing while the sweep of arcs rarely does.
+*/
+const dxfUnitArcTable*
+dxfTessellationCache::getUnitCircle(int numseg)
+{
+	if (numseg < 1) numseg = 1;
+
+	Key key = {UNIT_CIRCLE, numseg, 0.0, 0.0, 0.0};
+	auto it = this->tables.find(key);
+	if (it != this->tables.end()) return it->second;
+
+	this->checkLimits();
+
+	auto table = new dxfUnitArcTable;
+	table->numseg = numseg;
+	table->cosv.makeEmpty(numseg + 1);
+	table->sinv.makeEmpty(numseg + 1);
+
+	dxfdouble inc = (2 * M_PI) / numseg;
+	table->cosv.append(1.0);
+	table->sinv.append(0.0);
+	for (int i = 1; i < numseg; i++)
+	{
+		table->cosv.append(cos(inc * i));
+		table->sinv.append(sin(inc * i));
+	}
+	// make sure closed curves end exactly where they started
+	table->cosv.append(1.0);
+	table->sinv.append(0.0);
+
+	this->numsamples += numseg + 1;
+	this->tables.emplace(key, table);
+	return table;
+}
+
+/*!
+  Returns a scratch array the converters can use to build vertex
+  lists without allocating memory for every entity.
+*/
+dimeArray<dimeVec3>&
+dxfTessellationCache::getScratch()
+{
+	this->scratch.setCount(0);
+	return this->scratch;
+}
+
+/*!
+  Frees all cached data.
+*/
+void
+dxfTessellationCache::clear()
+{
+	for (auto& entry : this->tables)
+	{
+		delete entry.second;
+	}
+	this->tables.clear();
+	this->numsubs.clear();
+	this->numsamples = 0;
+}
+
+//
+// flushes the cache when it has grown too large. Tables returned
+// earlier are invalidated, so this is only called before a new
+// entry is inserted.
+//
+void
+dxfTessellationCache::checkLimits()
+{
+	if (this->numsubs.size() >= MAX_NUMSUB_ENTRIES)
+	{
+		this->numsubs.clear();
+	}
+	if (this->numsamples >= MAX_TABLE_SAMPLES)
+	{
+		for (auto& entry : this->tables)
+		{
+			delete entry.second;
+		}
+		this->tables.clear();
+		this->numsamples = 0;
+	}
+}
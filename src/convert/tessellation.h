@@ -0,0 +1,102 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+#ifndef _DXF2VRML_TESSELLATION_H_
+#define _DXF2VRML_TESSELLATION_H_
+
+#include <dime/Basic.h>
+#include <dime/util/Array.h>
+#include <dime/util/Linear.h>
+#include <unordered_map>
+
+//
+// A table of unit circle samples, cos(k*2PI/numseg) and
+// sin(k*2PI/numseg) for k = 0..numseg. The first and last entries
+// are exact, so that closed curves weld in the BSP trees.
+//
+struct dxfUnitArcTable
+{
+	int numseg;
+	dimeArray<dxfdouble> cosv;
+	dimeArray<dxfdouble> sinv;
+};
+
+class dxfTessellationCache
+{
+public:
+	dxfTessellationCache();
+	~dxfTessellationCache();
+
+	int getCircleNumSub(dxfdouble maxerr, dxfdouble radius);
+	int getEllipseNumSub(dxfdouble maxerr, dxfdouble a, dxfdouble b);
+	const dxfUnitArcTable* getUnitCircle(int numseg);
+
+	dimeArray<dimeVec3>& getScratch();
+	void clear();
+
+private:
+	enum Kind
+	{
+		CIRCLE_NUMSUB,
+		ELLIPSE_NUMSUB,
+		UNIT_CIRCLE
+	};
+
+	struct Key
+	{
+		int kind;
+		int numseg;
+		dxfdouble a;
+		dxfdouble b;
+		dxfdouble c;
+
+		bool operator ==(const Key& k) const
+		{
+			return kind == k.kind && numseg == k.numseg &&
+				a == k.a && b == k.b && c == k.c;
+		}
+	};
+
+	struct KeyHash
+	{
+		size_t operator()(const Key& k) const;
+	};
+
+	void checkLimits();
+
+	std::unordered_map<Key, int, KeyHash> numsubs;
+	std::unordered_map<Key, dxfUnitArcTable*, KeyHash> tables;
+	dimeArray<dimeVec3> scratch;
+	int numsamples;
+};
+
+#endif // _DXF2VRML_TESSELLATION_H_
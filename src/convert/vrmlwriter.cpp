@@ -0,0 +1,606 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*!
+  \class dxfVrmlWriter vrmlwriter.h
+  \brief The dxfVrmlWriter class writes the converted geometry as VRML 1.0 or VRML 2.0.
+
+  All output is formatted into a large memory buffer, which is written
+  to the FILE pointer or file descriptor when it is full. Numbers are
+  formatted with std::to_chars when the C++ library supports it, which
+  is a lot faster than one printf call per coordinate.
+
+  Coordinates are written with 8 significant digits by default, which
+  gives output identical to earlier versions of dime. Use
+  setPrecision() to trade precision for smaller files.
+*/
+
+#include <dime/convert/vrmlwriter.h>
+#include <string.h>
+#include <stdlib.h>
+
+#if defined(__has_include)
+#if __has_include(<charconv>) && __cplusplus >= 201703L
+#include <charconv>
+#endif
+#endif
+
+#ifdef _WIN32
+#include <io.h>
+#define DXF_WRITE _write
+#else
+#include <unistd.h>
+#define DXF_WRITE ::write
+#endif
+
+#define VRML_BUFFER_SIZE (1024 * 1024)
+
+/*!
+  Constructor. The VRML file will be written to \a fp.
+*/
+dxfVrmlWriter::dxfVrmlWriter(FILE* fp, const bool vrml1, const bool only2d)
+	: fp(fp), fd(-1)
+{
+	this->init(vrml1, only2d);
+}
+
+/*!
+  Constructor. The VRML file will be written to the file
+  descriptor \a fd.
+*/
+dxfVrmlWriter::dxfVrmlWriter(const int fd, const bool vrml1, const bool only2d)
+	: fp(nullptr), fd(fd)
+{
+	this->init(vrml1, only2d);
+}
+
+/*!
+  Destructor. Flushes any buffered output.
+*/
+dxfVrmlWriter::~dxfVrmlWriter()
+{
+	this->flush();
+	free(this->buffer);
+}
+
+//
+// common constructor code
+//
+void
+dxfVrmlWriter::init(const bool vrml1, const bool only2d)
+{
+	this->vrml1 = vrml1;
+	this->only2d = only2d;
+	this->error = false;
+	this->translated = false;
+	this->precision = 8;
+	this->indicesPerLine = 8;
+	this->r = this->g = this->b = 1.0;
+	this->normals = nullptr;
+	this->numNormals = 0;
+	this->normalIndices = nullptr;
+	this->groupName[0] = 0;
+	this->bufferSize = VRML_BUFFER_SIZE;
+	this->buffer = static_cast<char*>(malloc(this->bufferSize));
+	this->used = 0;
+	if (!this->buffer) this->error = true;
+}
+
+/*!
+  Sets the number of significant digits for coordinates. The
+  default is 8.
+*/
+void
+dxfVrmlWriter::setPrecision(const int digits)
+{
+	this->precision = digits < 1 ? 1 : (digits > 17 ? 17 : digits);
+}
+
+/*!
+  Sets the number of indices written on each line. The default is 8.
+*/
+void
+dxfVrmlWriter::setIndicesPerLine(const int num)
+{
+	this->indicesPerLine = num < 1 ? 1 : num;
+}
+
+/*!
+  Writes the VRML header.
+*/
+bool
+dxfVrmlWriter::begin()
+{
+	if (this->vrml1) this->put("#VRML V1.0 ascii\n\n");
+	else this->put("#VRML V2.0 utf8\n\n");
+	return !this->error;
+}
+
+/*!
+  Puts the following layers in a Transform (VRML 2.0) or a Separator
+  with a Translation (VRML 1.0) node, to move the vertices back to
+  their original position. The node is closed in end().
+*/
+void
+dxfVrmlWriter::setOrigin(const dimeVec3& origin)
+{
+	if (this->translated || origin == dimeVec3(0.0, 0.0, 0.0)) return;
+	this->translated = true;
+	if (this->vrml1)
+	{
+		this->put("Separator {\n"
+			"Translation {\n"
+			"  translation ");
+	}
+	else
+	{
+		this->put("Transform {\n"
+			"  translation ");
+	}
+	this->putDouble(origin[0], 17);
+	this->put(" ", 1);
+	this->putDouble(origin[1], 17);
+	this->put(" ", 1);
+	this->putDouble(this->only2d ? 0.0 : origin[2], 17);
+	if (this->vrml1)
+	{
+		this->put("\n}\n");
+	}
+	else
+	{
+		this->put("\n"
+			"  children [\n");
+	}
+}
+
+/*!
+  Names the node written by the next beginLayer() call. The name is
+  \c entity_<id> when \a entityid is valid, otherwise the layer name
+  with characters that are illegal in VRML names replaced by '_'.
+*/
+void
+dxfVrmlWriter::setGroupInfo(const char* layername, const int entityid)
+{
+	if (entityid >= 0)
+	{
+		snprintf(this->groupName, sizeof(this->groupName), "entity_%d", entityid);
+		return;
+	}
+	if (layername == nullptr || layername[0] == 0)
+	{
+		this->groupName[0] = 0;
+		return;
+	}
+	size_t n = 0;
+	// names can not start with a digit, '+' or '-'
+	if ((layername[0] >= '0' && layername[0] <= '9') ||
+		layername[0] == '+' || layername[0] == '-')
+	{
+		this->groupName[n++] = '_';
+	}
+	for (const char* p = layername; *p && n < sizeof(this->groupName) - 1; p++)
+	{
+		const unsigned char c = static_cast<unsigned char>(*p);
+		const bool illegal = c <= 0x20 || c == 0x7f || strchr("\"#',.[\\]{}", c) != nullptr;
+		this->groupName[n++] = illegal ? '_' : static_cast<char>(c);
+	}
+	this->groupName[n] = 0;
+}
+
+//!
+
+void
+dxfVrmlWriter::beginLayer(const int,
+                          const dxfdouble r, const dxfdouble g, const dxfdouble b)
+{
+	this->r = r;
+	this->g = g;
+	this->b = b;
+
+	if (this->groupName[0])
+	{
+		this->put("DEF ");
+		this->put(this->groupName);
+		this->put(" ", 1);
+		this->groupName[0] = 0;
+	}
+	if (this->vrml1)
+	{
+		this->put("Separator {\n");
+	}
+	else
+	{
+		this->put("Group {\n"
+			"  children [\n");
+	}
+}
+
+/*!
+  Stores the normals for the next addFaces() call.
+*/
+void
+dxfVrmlWriter::setFaceNormals(const dimeVec3* normals, const int numnormals,
+                              const int* normalindices)
+{
+	this->normals = normals;
+	this->numNormals = numnormals;
+	this->normalIndices = normalindices;
+}
+
+//!
+
+void
+dxfVrmlWriter::addFaces(const dimeVec3* verts, const int numverts,
+                        const int* indices, const int numindices)
+{
+	if (this->vrml1)
+	{
+		this->put("  Separator {\n"
+			"    Material {\n"
+			"      diffuseColor ");
+		this->putColor(this->r, this->g, this->b);
+		this->put("\n"
+			"    }\n"
+			"    ShapeHints {\n"
+			"      creaseAngle 0.5\n"
+			"      vertexOrdering COUNTERCLOCKWISE\n"
+			"      shapeType UNKNOWN_SHAPE_TYPE\n"
+			"      faceType UNKNOWN_FACE_TYPE\n"
+			"    }\n"
+			"    Coordinate3 {\n"
+			"      point [\n");
+	}
+	else
+	{
+		this->put("    Shape {\n"
+			"      appearance Appearance {\n"
+			"        material Material {\n"
+			"          diffuseColor ");
+		this->putColor(this->r, this->g, this->b);
+		this->put("\n"
+			"        }\n"
+			"      }\n"
+			"      geometry IndexedFaceSet {\n"
+			"        convex FALSE\n"
+			"        solid FALSE\n"
+			"        creaseAngle 0.5\n" // a good value for most cases
+			"        coord Coordinate {\n"
+			"          point [\n");
+	}
+	this->putCoords(verts, numverts, this->only2d);
+	this->put("          ]\n"
+		"        }\n");
+	const bool hasnormals = this->normals != nullptr;
+	if (this->vrml1)
+	{
+		if (hasnormals)
+		{
+			this->put("    Normal {\n"
+				"      vector [\n");
+			this->putCoords(this->normals, this->numNormals, false);
+			this->put("      ]\n"
+				"    }\n"
+				"    NormalBinding {\n"
+				"      value PER_VERTEX_INDEXED\n"
+				"    }\n");
+		}
+		this->put("    IndexedFaceSet {\n"
+			"      coordIndex [\n          ");
+	}
+	else
+	{
+		this->put("        coordIndex [\n          ");
+	}
+	this->putIndices(indices, numindices, false);
+	this->put("        ]\n");
+	if (hasnormals)
+	{
+		if (!this->vrml1)
+		{
+			this->put("        normal Normal {\n"
+				"          vector [\n");
+			this->putCoords(this->normals, this->numNormals, false);
+			this->put("          ]\n"
+				"        }\n");
+		}
+		this->put("        normalIndex [\n          ");
+		this->putIndices(this->normalIndices, numindices, false);
+		this->put("        ]\n");
+		this->normals = nullptr;
+		this->normalIndices = nullptr;
+		this->numNormals = 0;
+	}
+	this->put("      }\n"
+		"    }\n");
+}
+
+//!
+
+void
+dxfVrmlWriter::addLines(const dimeVec3* verts, const int numverts,
+                        const int* indices, const int numindices)
+{
+	if (this->vrml1)
+	{
+		this->put("  Separator {\n"
+			"    Material {\n"
+			"      diffuseColor ");
+		this->putColor(this->r, this->g, this->b);
+		this->put("\n"
+			"    }\n"
+			"    Coordinate3 {\n"
+			"      point [\n");
+	}
+	else
+	{
+		this->put("    Shape {\n"
+			"      appearance Appearance {\n"
+			"        material Material {\n"
+			"          emissiveColor ");
+		this->putColor(this->r, this->g, this->b);
+		this->put("\n"
+			"        }\n"
+			"      }\n"
+			"      geometry IndexedLineSet {\n"
+			"        coord Coordinate {\n"
+			"          point [\n");
+	}
+	this->putCoords(verts, numverts, this->only2d);
+	this->put("          ]\n"
+		"        }\n");
+	if (this->vrml1)
+	{
+		this->put("    IndexedLineSet {\n"
+			"      coordIndex [\n          ");
+	}
+	else
+	{
+		this->put("        coordIndex [\n          ");
+	}
+	// make sure line indices has a -1 at the end
+	this->putIndices(indices, numindices,
+	                 numindices && indices[numindices - 1] != -1);
+	this->put("        ]\n"
+		"      }\n"
+		"    }\n");
+}
+
+/*!
+  Points are not written. FIXME: the point export was disabled due to
+  a suspected bug. pederb, 2001-12-11
+*/
+void
+dxfVrmlWriter::addPoints(const dimeVec3*, const int)
+{
+}
+
+//!
+
+void
+dxfVrmlWriter::endLayer()
+{
+	if (this->vrml1)
+	{
+		this->put("}\n");
+	}
+	else
+	{
+		this->put("  ]\n"
+			"}\n");
+	}
+}
+
+/*!
+  Closes the node opened by setOrigin(), and flushes the output.
+  Returns \c false if any write failed.
+*/
+bool
+dxfVrmlWriter::end()
+{
+	if (this->translated)
+	{
+		if (this->vrml1) this->put("}\n");
+		else this->put("  ]\n"
+			"}\n");
+		this->translated = false;
+	}
+	return this->flush();
+}
+
+/*!
+  Writes the buffered output to the file. Returns \c false if this or
+  any earlier write failed.
+*/
+bool
+dxfVrmlWriter::flush()
+{
+	if (this->used && !this->error)
+	{
+		if (this->fp)
+		{
+			if (fwrite(this->buffer, 1, this->used, this->fp) != this->used)
+				this->error = true;
+			else if (fflush(this->fp) != 0)
+				this->error = true;
+		}
+		else
+		{
+			size_t done = 0;
+			while (done < this->used)
+			{
+				auto n = DXF_WRITE(this->fd, this->buffer + done,
+				                   static_cast<unsigned int>(this->used - done));
+				if (n <= 0)
+				{
+					this->error = true;
+					break;
+				}
+				done += static_cast<size_t>(n);
+			}
+		}
+	}
+	this->used = 0;
+	return !this->error;
+}
+
+//
+// makes sure there is room for at least len more characters in the buffer
+//
+void
+dxfVrmlWriter::reserve(const size_t len)
+{
+	if (this->used + len > this->bufferSize) this->flush();
+}
+
+void
+dxfVrmlWriter::put(const char* str)
+{
+	this->put(str, strlen(str));
+}
+
+void
+dxfVrmlWriter::put(const char* str, const size_t len)
+{
+	if (this->error) return;
+	if (len > this->bufferSize)
+	{
+		this->flush();
+		if (this->fp)
+		{
+			if (fwrite(str, 1, len, this->fp) != len) this->error = true;
+			return;
+		}
+	}
+	size_t done = 0;
+	while (done < len)
+	{
+		this->reserve(1);
+		if (this->error) return;
+		size_t n = this->bufferSize - this->used;
+		if (n > len - done) n = len - done;
+		memcpy(this->buffer + this->used, str + done, n);
+		this->used += n;
+		done += n;
+	}
+}
+
+//
+// formats val like printf("%.*g", precision, val)
+//
+void
+dxfVrmlWriter::putDouble(const dxfdouble val, const int precision)
+{
+	this->reserve(32);
+	if (this->error) return;
+	char* ptr = this->buffer + this->used;
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+	auto res = std::to_chars(ptr, ptr + 32, static_cast<double>(val),
+	                         std::chars_format::general, precision);
+	this->used += res.ptr - ptr;
+#else
+	this->used += snprintf(ptr, 32, "%.*g", precision, static_cast<double>(val));
+#endif
+}
+
+void
+dxfVrmlWriter::putInt(int val)
+{
+	this->reserve(12);
+	if (this->error) return;
+	char tmp[12];
+	char* end = tmp + sizeof(tmp);
+	char* ptr = end;
+	unsigned int u = val < 0 ? 0u - static_cast<unsigned int>(val) :
+		static_cast<unsigned int>(val);
+	do
+	{
+		*--ptr = static_cast<char>('0' + u % 10);
+		u /= 10;
+	} while (u);
+	if (val < 0) *--ptr = '-';
+	memcpy(this->buffer + this->used, ptr, end - ptr);
+	this->used += end - ptr;
+}
+
+void
+dxfVrmlWriter::putColor(const dxfdouble r, const dxfdouble g, const dxfdouble b)
+{
+	this->putDouble(r, 6);
+	this->put(" ", 1);
+	this->putDouble(g, 6);
+	this->put(" ", 1);
+	this->putDouble(b, 6);
+}
+
+//
+// writes a list of vectors. If flatten is true, z is written as 0
+//
+void
+dxfVrmlWriter::putCoords(const dimeVec3* verts, const int numverts,
+                         const bool flatten)
+{
+	for (int i = 0; i < numverts; i++)
+	{
+		const dimeVec3& v = verts[i];
+		this->put("            ", 12);
+		this->putDouble(v[0], this->precision);
+		this->put(" ", 1);
+		this->putDouble(v[1], this->precision);
+		this->put(" ", 1);
+		this->putDouble(flatten ? 0.0 : v[2], this->precision);
+		if (i < numverts - 1) this->put(",\n", 2);
+		else this->put("\n", 1);
+	}
+}
+
+//
+// writes indices, indicesPerLine on each line. If terminate is true,
+// an extra -1 is written at the end.
+//
+void
+dxfVrmlWriter::putIndices(const int* indices, const int numindices,
+                          const bool terminate)
+{
+	const int n = numindices + (terminate ? 1 : 0);
+	int cnt = 1;
+	for (int i = 0; i < n; i++)
+	{
+		this->putInt(i < numindices ? indices[i] : -1);
+		if (i == n - 1)
+			this->put("\n", 1);
+		else if (cnt % this->indicesPerLine)
+			this->put(",", 1);
+		else
+			this->put(",\n          ", 12);
+		cnt++;
+	}
+}
@@ -154,10 +154,19 @@ dime3DFace::countRecords() const
 	return cnt;
 }
 
+//!
+
+size_t
+dime3DFace::countMemory(dimeMemoryUsage& usage) const
+{
+	return sizeof(dime3DFace) + dimeFaceEntity::countMemory(usage);
+}
+
 void
 dime3DFace::setFlags(const int16_t flags)
 {
 	this->flags = flags;
+	this->setDirty();
 }
 
 int16_t
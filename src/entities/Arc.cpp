@@ -41,6 +41,7 @@
 #include <dime/Output.h>
 
 #include <dime/Model.h>
+#include "../Diagnostic.h"
 #include <math.h>
 
 #ifndef M_PI
@@ -217,7 +218,7 @@ DimeArc::extractGeometry(dimeArray<dimeVec3>& verts,
 	if (delta == 0.0)
 	{
 #ifndef NDEBUG
-		fprintf(stderr, "ARC with startAngle == endAngle!\n");
+		dime_diagnostic("ARC with startAngle == endAngle!\n");
 #endif
 		end += 2 * M_PI;
 		//return dimeEntity::NONE;
@@ -259,3 +260,11 @@ DimeArc::countRecords() const
 
 	return cnt + DimeExtrusionEntity::countRecords();
 }
+
+//!
+
+size_t
+DimeArc::countMemory(dimeMemoryUsage& usage) const
+{
+	return sizeof(DimeArc) + DimeExtrusionEntity::countMemory(usage);
+}
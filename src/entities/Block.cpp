@@ -46,6 +46,7 @@
 #include <dime/Output.h>
 
 #include <dime/Model.h>
+#include "../Diagnostic.h"
 
 static char entityName[] = "BLOCK";
 
@@ -152,6 +153,7 @@ DimeBlock::copy(DimeModel* const model) const
 bool
 DimeBlock::read(DimeInput* const file)
 {
+	const long start = file->getGroupCodeOffset();
 	this->name = nullptr;
 	bool ret = DimeEntity::read(file);
 	if (ret && this->name)
@@ -175,13 +177,14 @@ DimeBlock::read(DimeInput* const file)
 		}
 		this->entities.shrinkToFit(); // don't waste too much memory
 	}
+	if (ret) this->sourceIndex = file->addSourceRange(this, start, file->getGroupCodeOffset());
 
 #ifndef NDEBUG
 	dimeParam param;
 	if (getRecord(67, param) && param.int16_data == 1)
 	{
-		fprintf(stderr, "paperspace block name: %s\n",
-		        this->getName());
+		dime_diagnostic("paperspace block name: %s\n",
+		                this->getName());
 	}
 #endif
 	return ret;
@@ -213,12 +216,7 @@ DimeBlock::write(DimeOutput* const file)
 
 	if (ret)
 	{
-		int i, n = this->entities.count();
-		for (i = 0; i < n; i++)
-		{
-			if (!this->entities[i]->write(file)) break;
-		}
-		if (i == n)
+		if (file->writeEntities(this->entities.constArrayPointer(), this->entities.count()))
 		{
 			if (this->endblock)
 			{
@@ -339,13 +337,30 @@ DimeBlock::countRecords() const
 	return cnt + DimeEntity::countRecords();
 }
 
+//!
+
+size_t
+DimeBlock::countMemory(dimeMemoryUsage& usage) const
+{
+	size_t size = sizeof(DimeBlock);
+	size += this->entities.allocSize() * sizeof(DimeEntity*);
+	const int n = this->entities.count();
+	for (int i = 0; i < n; i++)
+		DimeEntity::countEntityMemory(this->entities[i], usage);
+	if (this->endblock) DimeEntity::countEntityMemory(this->endblock, usage);
+	return size + DimeEntity::countMemory(usage);
+}
+
 /*!
-  Inserts an entity in this block at position \a idx.
+  Inserts an entity in this block at position \a idx. The entity and
+  the block are marked as dirty.
 */
 
 void
 DimeBlock::insertEntity(DimeEntity* const entity, const int idx)
 {
+	entity->setDirty();
+	this->setDirty();
 	if (idx < 0) this->entities.append(entity);
 	else
 	{
@@ -357,7 +372,7 @@ DimeBlock::insertEntity(DimeEntity* const entity, const int idx)
 /*!
   Removes the entity at position \a idx. If \a deleteIt is \e true, and 
   no memory handler is used, the entity will be deleted before 
-  returning from this method.
+  returning from this method. The block is marked as dirty.
 */
 
 void
@@ -366,6 +381,7 @@ DimeBlock::removeEntity(const int idx, const bool deleteIt)
 	assert(idx >= 0 && idx < this->entities.count());
 	if (deleteIt) delete this->entities[idx];
 	this->entities.removeElem(idx);
+	this->setDirty();
 }
 
 //!
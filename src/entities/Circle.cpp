@@ -205,3 +205,11 @@ DimeCircle::countRecords() const
 	// header + center point + radius
 	return 5 + DimeExtrusionEntity::countRecords();
 }
+
+//!
+
+size_t
+DimeCircle::countMemory(dimeMemoryUsage& usage) const
+{
+	return sizeof(DimeCircle) + DimeExtrusionEntity::countMemory(usage);
+}
@@ -268,3 +268,11 @@ DimeEllipse::countRecords() const
 	// header + center point + major endpoint + ratio + start + end
 	return 10 + DimeExtrusionEntity::countRecords();
 }
+
+//!
+
+size_t
+DimeEllipse::countMemory(dimeMemoryUsage& usage) const
+{
+	return sizeof(DimeEllipse) + DimeExtrusionEntity::countMemory(usage);
+}
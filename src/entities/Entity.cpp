@@ -87,6 +87,10 @@
   It can be used to create a progress bar while writing a DXF
   file. It is really only useful for _very_ large DXF files. But you
   should implement it since it's not too much work.
+
+  The countMemory() method should return the size of your entity
+  class plus the memory it allocates, and call the parent's method to
+  count the records. It is used by DimeModel::getMemoryUsage().
   
   Implement the extractGeometry() method if you feel like it. This
   is just a convenience method so you don't have to do this. 
@@ -129,6 +133,8 @@
 #include <dime/Output.h>
 
 #include <dime/Model.h>
+#include "../StatsData.h"
+#include "../Diagnostic.h"
 
 #include <string.h>
 #include <ctype.h>
@@ -173,7 +179,7 @@
 */
 
 DimeEntity::DimeEntity()
-	: DimeRecordHolder(0), entityFlags(0), colorNumber(256)
+	: DimeRecordHolder(0), entityFlags(0), colorNumber(256), sourceIndex(-1)
 {
 	this->layer = dimeLayer::getDefaultLayer();
 }
@@ -234,6 +240,43 @@ DimeEntity::setDeleted(const bool onOff)
 	}
 }
 
+/*!
+  \fn bool DimeEntity::isDirty() const
+  Returns \c TRUE if this entity has been changed since the dirty flag
+  was last cleared. The flag is set by the set methods, setRecord(),
+  and when the entity is inserted in a section or block, and is used
+  by dxfConverter::updateConvert() to find entities that must be
+  converted again.
+
+  \sa setDirty()
+*/
+
+/*!
+  \fn void DimeEntity::setDirty(bool onOff)
+  Sets the dirty state of this entity to \a onOff. Setting the entity
+  dirty also marks it as modified, but clearing the dirty flag leaves
+  the modified flag alone.
+
+  \sa isDirty(), isModified()
+*/
+
+/*!
+  \fn bool DimeEntity::isModified() const
+  Returns \c TRUE if this entity has been changed since it was read.
+  Unlike isDirty(), this flag is not cleared by dxfConverter, and is
+  used by DimeModel::write() to decide whether the entity can be copied
+  from the source file (see DimeModel::setPassthrough()).
+
+  \sa setModified(), setDirty()
+*/
+
+/*!
+  \fn void DimeEntity::setModified(bool onOff)
+  Sets the modified state of this entity to \a onOff.
+
+  \sa isModified()
+*/
+
 /*!
   Useful for developers (at least for me :-).
   \sa dimeEntity::setTagged()
@@ -346,27 +389,34 @@ DimeEntity::readEntities(DimeInput* const file,
 
 	while (true)
 	{
+		if (file->checkAborted())
+		{
+			ok = false;
+			break;
+		}
 		if (!file->readGroupCode(groupcode) || groupcode != 0)
 		{
-			fprintf(stderr, "Error reading groupcode: %d\n", groupcode);
+			dime_diagnostic("Error reading groupcode: %d\n", groupcode);
 			ok = false;
 			break;
 		}
+		const long start = file->getGroupCodeOffset();
 		string = file->readString();
 		if (!strcmp(string, stopat)) break;
 		entity = DimeEntity::createEntity(string);
 		if (entity == nullptr)
 		{
-			fprintf(stderr, "error creating entity: %s\n", string);
+			dime_diagnostic("error creating entity: %s\n", string);
 			ok = false;
 			break;
 		}
 		if (!entity->read(file))
 		{
-			fprintf(stderr, "error reading entity: %s.\n", string);
+			dime_diagnostic("error reading entity: %s.\n", string);
 			ok = false;
 			break;
 		}
+		entity->sourceIndex = file->addSourceRange(entity, start, file->getGroupCodeOffset());
 		array.append(entity);
 	}
 	return ok;
@@ -541,6 +591,25 @@ DimeEntity::countRecords() const
 	return cnt + DimeRecordHolder::countRecords();
 }
 
+/*!
+  Static function that counts the memory of \a entity with
+  countMemory(), and adds it to the total and to the entity type in
+  \a usage. Returns the number of bytes counted. Entities owning other
+  entities call this for each owned entity.
+
+  \sa DimeModel::getMemoryUsage()
+*/
+
+size_t
+DimeEntity::countEntityMemory(const DimeEntity* const entity, dimeMemoryUsage& usage)
+{
+	const size_t size = entity->countMemory(usage);
+	const int type = entity->typeId();
+	if (type >= 0 && type < DimeBase::dimeLastTypeTag) usage.entities[type] += size;
+	usage.total += size;
+	return size;
+}
+
 /*!
   The traversal function used when dimeModel::traverseEntities()
   is called. Most entities use this default method, but some
@@ -645,6 +714,8 @@ DimeEntity::read(DimeInput* const file)
 			this->layer = file->getModel()->addLayer(tmpbuffer);
 		}
 		else this->layer = dimeLayer::getDefaultLayer();
+		if (dimeStatsData* s = dimeStatsData::get(file->getStats()))
+			dimeStatsData::addType(s->entities, this->typeId(), 1);
 	}
 	return ok;
 }
@@ -662,6 +733,7 @@ DimeEntity::setLayer(const dimeLayer* const layer)
 		this->layer = dimeLayer::getDefaultLayer();
 	else
 		this->layer = layer;
+	this->setDirty();
 }
 
 //!
@@ -853,6 +925,15 @@ DimeEntity::preWrite(DimeOutput* const file)
 	return ret;
 }
 
+/*!
+  Marks the entity as dirty.
+*/
+void
+DimeEntity::recordsChanged()
+{
+	this->setDirty();
+}
+
 //!
 bool
 DimeEntity::shouldWriteRecord(const int groupcode) const
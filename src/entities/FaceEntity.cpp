@@ -55,6 +55,7 @@ dimeFaceEntity::setTriangle(const dimeVec3& v0, const dimeVec3& v1,
 	this->coords[0] = v0;
 	this->coords[1] = v1;
 	this->coords[2] = coords[3] = v2;
+	this->setDirty();
 }
 
 /*!
@@ -69,6 +70,7 @@ dimeFaceEntity::setQuad(const dimeVec3& v0, const dimeVec3& v1,
 	this->coords[1] = v1;
 	this->coords[2] = v2;
 	this->coords[3] = v3;
+	this->setDirty();
 }
 
 /*!
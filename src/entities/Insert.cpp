@@ -43,6 +43,7 @@
 
 #include <dime/Model.h>
 #include <dime/State.h>
+#include "../Diagnostic.h"
 
 static char entityName[] = "INSERT";
 
@@ -430,22 +431,57 @@ DimeInsert::traverse(const DimeState* const state,
 {
 	DimeState newstate = *state;
 	newstate.currentInsert = this;
+	if (!state->rootInsert) newstate.rootInsert = this;
+
+	const dimeMatrix& statematrix = state->getMatrix();
+	dimeMatrix base = statematrix;
+	this->makeMatrix(base);
 
 	if (this->block && (state->getFlags() & DimeState::EXPLODE_INSERTS))
 	{
-		for (int i = 0; i < this->rowCount; i++)
+		if (statematrix.isAffine())
+		{
+			// The cell offset is applied before the insert transformation,
+			// so a cell only moves the translation of the base matrix by the
+			// offset transformed by the state matrix. Saves two full matrix
+			// products per MINSERT cell.
+			dxfmath colstep[3], rowstep[3];
+			for (int k = 0; k < 3; k++)
+			{
+				colstep[k] = statematrix[k][0] * this->columnSpacing;
+				rowstep[k] = statematrix[k][1] * this->rowSpacing;
+			}
+			dimeMatrix m = base;
+			for (int i = 0; i < this->rowCount; i++)
+			{
+				for (int j = 0; j < this->columnCount; j++)
+				{
+					if (i || j)
+					{
+						for (int k = 0; k < 3; k++)
+							m[k][3] = base[k][3] + rowstep[k] * i + colstep[k] * j;
+					}
+					newstate.setMatrix(m);
+					if (!block->traverse(&newstate, callback)) return false;
+				}
+			}
+		}
+		else
 		{
-			for (int j = 0; j < this->columnCount; j++)
+			for (int i = 0; i < this->rowCount; i++)
 			{
-				dimeMatrix m = state->getMatrix();
-				dimeMatrix m2 = dimeMatrix::identity();
-				m2.setTranslate(dimeVec3(j * this->columnSpacing,
-				                          i * this->rowSpacing,
-				                          0));
-				m.multRight(m2);
-				this->makeMatrix(m);
-				newstate.setMatrix(m);
-				if (!block->traverse(&newstate, callback)) return false;
+				for (int j = 0; j < this->columnCount; j++)
+				{
+					dimeMatrix m = statematrix;
+					dimeMatrix m2 = dimeMatrix::identity();
+					m2.setTranslate(dimeVec3(j * this->columnSpacing,
+					                          i * this->rowSpacing,
+					                          0));
+					m.multRight(m2);
+					this->makeMatrix(m);
+					newstate.setMatrix(m);
+					if (!block->traverse(&newstate, callback)) return false;
+				}
 			}
 		}
 	}
@@ -454,9 +490,7 @@ DimeInsert::traverse(const DimeState* const state,
 		if (!callback(state, this)) return false;
 	}
 
-	dimeMatrix m = state->getMatrix();
-	this->makeMatrix(m);
-	newstate.setMatrix(m);
+	newstate.setMatrix(base);
 
 	// extract internal INSERT entities
 	for (int i = 0; i < this->numEntities; i++)
@@ -476,7 +510,7 @@ DimeInsert::fixReferences(DimeModel* const model)
 		this->block = static_cast<DimeBlock*>(model->findReference(this->blockName));
 		if (this->block == nullptr)
 		{
-			fprintf(stderr, "BLOCK %s not found!\n", blockName);
+			dime_diagnostic("BLOCK %s not found!\n", blockName);
 		}
 	}
 	for (int i = 0; i < this->numEntities; i++)
@@ -551,6 +585,19 @@ DimeInsert::countRecords() const
 	return cnt + DimeEntity::countRecords();
 }
 
+//!
+
+size_t
+DimeInsert::countMemory(dimeMemoryUsage& usage) const
+{
+	size_t size = sizeof(DimeInsert);
+	size += this->numEntities * sizeof(DimeEntity*);
+	for (int i = 0; i < this->numEntities; i++)
+		DimeEntity::countEntityMemory(this->entities[i], usage);
+	if (this->seqend) DimeEntity::countEntityMemory(this->seqend, usage);
+	return size + DimeEntity::countMemory(usage);
+}
+
 /*!
   Sets the block for this INSERT entity. This will change the record
   with group code 2.
@@ -561,4 +608,5 @@ DimeInsert::setBlock(DimeBlock* const block)
 {
 	this->block = block;
 	this->blockName = block->getName();
+	this->setDirty();
 }
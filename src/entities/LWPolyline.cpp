@@ -37,9 +37,11 @@
 
 #include <dime/entities/LWPolyline.h>
 #include <dime/records/Record.h>
+#include <dime/util/Triangulator.h>
 #include <dime/Output.h>
 
 #include <dime/Model.h>
+#include "../Diagnostic.h"
 
 static char entityName[] = "LWPOLYLINE";
 
@@ -221,7 +223,7 @@ DimeLWPolyline::handleRecord(const int groupcode,
 				const int num = this->numVertices;
 				if (num <= 0)
 				{
-					fprintf(stderr, "LWPOLYLINE shouldn't have any vertices, but still found one!\n");
+					dime_diagnostic("LWPOLYLINE shouldn't have any vertices, but still found one!\n");
 					return true; // data is "handled" so... 
 				}
 				this->xcoord = ARRAY_NEW(dxfdouble, num);
@@ -282,12 +284,12 @@ DimeLWPolyline::handleRecord(const int groupcode,
 			}
 			if (this->tmpCounter >= this->numVertices)
 			{
-				fprintf(stderr, "too many vertices in LWPOLYLINE!\n");
+				dime_diagnostic("too many vertices in LWPOLYLINE!\n");
 				return true;
 			}
 			if (arrayptr == nullptr)
 			{
-				fprintf(stderr, "illegal data found in LWPOLYLINE.\n");
+				dime_diagnostic("illegal data found in LWPOLYLINE.\n");
 				return true;
 			}
 			this->tmpFlags |= flagmask;
@@ -378,17 +380,50 @@ DimeLWPolyline::getRecord(const int groupcode,
 	return DimeExtrusionEntity::getRecord(groupcode, param, index);
 }
 
+/*!
+  Closed polylines are returned as triangulated POLYGONS, with the
+  bulge arcs tessellated. If the polyline is self-intersecting, or
+  if it is open, it is returned as LINES.
+*/
+
 DimeEntity::GeometryType
 DimeLWPolyline::extractGeometry(dimeArray<dimeVec3>& verts,
-                                dimeArray<int>&/*indices*/,
+                                dimeArray<int>& indices,
                                 dimeVec3& extrusionDir,
                                 dxfdouble& thickness)
 {
+	verts.setCount(0);
+	indices.setCount(0);
+
 	thickness = this->thickness;
 	extrusionDir = this->extrusionDir;
 
 	const int num = this->numVertices;
-	for (int i = 0; i < num; i++)
+	int i;
+
+	if ((this->flags & 1) && num >= 3)
+	{
+		for (i = 0; i < num; i++)
+		{
+			dimeVec3 p(this->xcoord[i], this->ycoord[i], this->elevation);
+			verts.append(p);
+			if (this->bulge && this->bulge[i] != 0.0)
+			{
+				int next = (i + 1) % num;
+				dimeTriangulator::tessellateBulge(p, dimeVec3(this->xcoord[next],
+				                                              this->ycoord[next],
+				                                              this->elevation),
+				                                  this->bulge[i], 0.0,
+				                                  dimeTriangulator::BULGE_NUMSUB, verts);
+			}
+		}
+		dimeTriangulator triangulator;
+		triangulator.addContour(verts.constArrayPointer(), verts.count());
+		if (triangulator.triangulate(indices)) return DimeEntity::POLYGONS;
+		verts.setCount(0);
+	}
+
+	for (i = 0; i < num; i++)
 	{
 		verts.append(dimeVec3(this->xcoord[i],
 		                       this->ycoord[i],
@@ -427,6 +462,22 @@ DimeLWPolyline::countRecords() const
 	return cnt + DimeExtrusionEntity::countRecords();
 }
 
+//!
+
+size_t
+DimeLWPolyline::countMemory(dimeMemoryUsage& usage) const
+{
+	size_t size = sizeof(DimeLWPolyline);
+	int arrays = 0;
+	if (this->xcoord) arrays++;
+	if (this->ycoord) arrays++;
+	if (this->bulge) arrays++;
+	if (this->startingWidth) arrays++;
+	if (this->endWidth) arrays++;
+	size += arrays * this->numVertices * sizeof(dxfdouble);
+	return size + DimeExtrusionEntity::countMemory(usage);
+}
+
 int
 DimeLWPolyline::getNumVertices() const
 {
@@ -180,3 +180,11 @@ DimeLine::countRecords() const
 	cnt += 6; // coordinates
 	return cnt + DimeExtrusionEntity::countRecords();
 }
+
+//!
+
+size_t
+DimeLine::countMemory(dimeMemoryUsage& usage) const
+{
+	return sizeof(DimeLine) + DimeExtrusionEntity::countMemory(usage);
+}
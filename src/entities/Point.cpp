@@ -168,3 +168,11 @@ DimePoint::countRecords() const
 	cnt += 4; // header + coordinates
 	return cnt + DimeExtrusionEntity::countRecords();
 }
+
+//!
+
+size_t
+DimePoint::countMemory(dimeMemoryUsage& usage) const
+{
+	return sizeof(DimePoint) + DimeExtrusionEntity::countMemory(usage);
+}
@@ -38,11 +38,13 @@
 #include <dime/entities/Polyline.h>
 #include <dime/entities/Vertex.h>
 #include <dime/records/Record.h>
+#include <dime/util/Triangulator.h>
 #include <dime/Input.h>
 #include <dime/Output.h>
 
 #include <dime/Model.h>
 #include <dime/State.h>
+#include "../Diagnostic.h"
 #include <string.h>
 
 static char entityName[] = "POLYLINE";
@@ -198,7 +200,7 @@ DimePolyline::read(DimeInput* const file)
 		{
 			if (!file->readGroupCode(groupcode) || groupcode != 0)
 			{
-				fprintf(stderr, "Error reading groupcode: %d\n", groupcode);
+				dime_diagnostic("Error reading groupcode: %d\n", groupcode);
 				//	sim_warning("Error reading groupcode: %d\n", groupcode);
 				ret = false;
 				break;
@@ -219,14 +221,14 @@ DimePolyline::read(DimeInput* const file)
 
 			if (vertex == nullptr)
 			{
-				fprintf(stderr, "error creating vertex\n");
+				dime_diagnostic("error creating vertex\n");
 				//	sim_warning("error creating vertex\n");
 				ret = false;
 				break;
 			}
 			if (!vertex->read(file))
 			{
-				fprintf(stderr, "error reading vertex.\n");
+				dime_diagnostic("error reading vertex.\n");
 				//	sim_warning("error reading vertex.\n");
 				ret = false;
 				break;
@@ -542,7 +544,11 @@ DimePolyline::getType() const
 	return this->POLYLINE; // no type flags set => (2D?) POLYLINE
 }
 
-//!
+/*!
+  Closed 2D polylines are returned as triangulated POLYGONS, with the
+  bulge arcs tessellated. If the polyline is self-intersecting, it is
+  returned as LINES, like open and 3D polylines.
+*/
 
 DimeEntity::GeometryType
 DimePolyline::extractGeometry(dimeArray<dimeVec3>& verts,
@@ -558,6 +564,30 @@ DimePolyline::extractGeometry(dimeArray<dimeVec3>& verts,
 	thickness = this->thickness;
 	extrusionDir = this->extrusionDir;
 
+	if ((this->flags & 0x59) == 0x1 && this->coordCnt >= 3)
+	{
+		// closed 2D polyline
+		dimeParam param;
+		for (i = 0; i < this->coordCnt; i++)
+		{
+			dimeVec3 p = this->coordVertices[i]->coords;
+			p[2] = this->elevation[2];
+			verts.append(p);
+			if (this->coordVertices[i]->getRecord(42, param) &&
+				param.double_data != 0.0)
+			{
+				dimeVec3 next = this->coordVertices[(i + 1) % this->coordCnt]->coords;
+				next[2] = this->elevation[2];
+				dimeTriangulator::tessellateBulge(p, next, param.double_data,
+				                                  0.0, dimeTriangulator::BULGE_NUMSUB, verts);
+			}
+		}
+		dimeTriangulator triangulator;
+		triangulator.addContour(verts.constArrayPointer(), verts.count());
+		if (triangulator.triangulate(indices)) return DimeEntity::POLYGONS;
+		verts.setCount(0);
+	}
+
 	if ((((this->flags & 0x58) == 0) || (this->flags & 0x8)) &&
 		this->coordCnt > 1)
 	{
@@ -613,10 +643,10 @@ DimePolyline::extractGeometry(dimeArray<dimeVec3>& verts,
 				else
 				{
 					// give up
-					fprintf(stderr, "vertices and faces do no add up: %d * %d + %d * %d != %d.\n",
-					        m, n, m2, n2, this->coordCnt);
+					dime_diagnostic("vertices and faces do no add up: %d * %d + %d * %d != %d.\n",
+					                m, n, m2, n2, this->coordCnt);
 
-					fprintf(stderr, "polyline: %d %d\n", flags, surfaceType);
+					dime_diagnostic("polyline: %d %d\n", flags, surfaceType);
 
 					verts.setCount(0);
 					return DimeEntity::NONE;
@@ -792,6 +822,24 @@ DimePolyline::countRecords() const
 	return cnt;
 }
 
+//!
+
+size_t
+DimePolyline::countMemory(dimeMemoryUsage& usage) const
+{
+	size_t size = sizeof(DimePolyline);
+	size += (this->coordCnt + this->indexCnt + this->frameCnt) * sizeof(DimeVertex*);
+	int i;
+	for (i = 0; i < this->coordCnt; i++)
+		DimeEntity::countEntityMemory(this->coordVertices[i], usage);
+	for (i = 0; i < this->indexCnt; i++)
+		DimeEntity::countEntityMemory(this->indexVertices[i], usage);
+	for (i = 0; i < this->frameCnt; i++)
+		DimeEntity::countEntityMemory(this->frameVertices[i], usage);
+	if (this->seqend) DimeEntity::countEntityMemory(this->seqend, usage);
+	return size + DimeExtrusionEntity::countMemory(usage);
+}
+
 /*!
   Sets the coordinate vertices for this polyline. Old vertices will
   be deleted.
@@ -828,6 +876,7 @@ DimePolyline::setCoordVertices(DimeVertex** vertices, const int num)
 		this->coordVertices = nullptr;
 		this->coordCnt = 0;
 	}
+	this->setDirty();
 }
 
 /*!
@@ -867,6 +916,7 @@ DimePolyline::setSplineFrameControlPoints(DimeVertex** vertices, const int num)
 		this->frameVertices = nullptr;
 		this->frameCnt = 0;
 	}
+	this->setDirty();
 }
 
 /*!
@@ -906,6 +956,7 @@ DimePolyline::setIndexVertices(DimeVertex** vertices, const int num)
 		this->indexVertices = nullptr;
 		this->indexCnt = 0;
 	}
+	this->setDirty();
 }
 
 // KRF, 02-16-2006, added to enable ::copy of new polyline
@@ -920,6 +971,7 @@ DimePolyline::setSeqend(const DimeEntity* ent)
 		delete this->seqend;
 	}
 	this->seqend = (DimeEntity*)ent;
+	this->setDirty();
 }
 
 /*!
@@ -978,6 +1030,7 @@ DimePolyline::setLayer(const dimeLayer* const layer)
 	{
 		this->indexVertices[i]->setLayer(layer);
 	}
+	this->setDirty();
 }
 
 void
@@ -193,6 +193,7 @@ void
 DimeSolid::setThickness(const dxfdouble& thickness)
 {
 	this->thickness = thickness;
+	this->setDirty();
 }
 
 //!
@@ -201,6 +202,7 @@ void
 DimeSolid::setExtrusionDir(const dimeVec3& ed)
 {
 	this->extrusionDir = ed;
+	this->setDirty();
 }
 
 //!
@@ -218,3 +220,11 @@ DimeSolid::countRecords() const
 	}
 	return cnt;
 }
+
+//!
+
+size_t
+DimeSolid::countMemory(dimeMemoryUsage& usage) const
+{
+	return sizeof(DimeSolid) + dimeFaceEntity::countMemory(usage);
+}
@@ -459,6 +459,19 @@ DimeSpline::countRecords() const
 	return cnt + DimeEntity::countRecords();
 }
 
+//!
+
+size_t
+DimeSpline::countMemory(dimeMemoryUsage& usage) const
+{
+	size_t size = sizeof(DimeSpline);
+	if (this->knots) size += this->numKnots * sizeof(dxfdouble);
+	if (this->weights) size += this->numControlPoints * sizeof(dxfdouble);
+	if (this->controlPoints) size += this->numControlPoints * sizeof(dimeVec3);
+	if (this->fitPoints) size += this->numFitPoints * sizeof(dimeVec3);
+	return size + DimeEntity::countMemory(usage);
+}
+
 void
 DimeSpline::setKnotValues(const dxfdouble* const values, const int numvalues)
 {
@@ -473,6 +486,7 @@ DimeSpline::setKnotValues(const dxfdouble* const values, const int numvalues)
 	}
 	memcpy(this->knots, values, numvalues * sizeof(dxfdouble));
 	this->numKnots = numvalues;
+	this->setDirty();
 }
 
 /*!
@@ -523,6 +537,7 @@ DimeSpline::setControlPoints(const dimeVec3* const pts, const int numpts)
 	}
 	memcpy(this->controlPoints, pts, sizeof(dimeVec3) * numpts);
 	this->numControlPoints = numpts;
+	this->setDirty();
 }
 
 /*!
@@ -546,6 +561,7 @@ DimeSpline::setWeight(const int idx, const dxfdouble w)
 	{
 		this->weights[idx] = w;
 	}
+	this->setDirty();
 }
 
 void
@@ -562,4 +578,305 @@ DimeSpline::setFitPoints(const dimeVec3* const pts, const int numpts)
 	}
 	memcpy(this->fitPoints, pts, numpts * sizeof(dimeVec3));
 	this->numFitPoints = numpts;
+	this->setDirty();
+}
+
+//
+// limits for the number of line segments generated per knot span
+// when tessellating.
+//
+#define MAX_SPAN_SEGMENTS 1024
+
+//
+// a control point in homogeneous coordinates, used by the de Boor
+// evaluation.
+//
+struct dimeHomogeneousPoint
+{
+	dxfdouble x, y, z, w;
+};
+
+/*!
+  Returns \c true if the spline has enough data (degree, knots and
+  control points) for it to be evaluated.
+*/
+
+bool
+DimeSpline::canEvaluate() const
+{
+	return this->controlPoints != nullptr && this->knots != nullptr &&
+		this->degree >= 1 && this->numControlPoints > this->degree &&
+		this->numKnots == this->numControlPoints + this->degree + 1 &&
+		this->knots[this->degree] < this->knots[this->numControlPoints];
+}
+
+/*!
+  Returns the valid parameter range for the spline in \a tmin and
+  \a tmax. The spline must be evaluable.
+
+  \sa canEvaluate()
+*/
+
+void
+DimeSpline::getParameterRange(dxfdouble& tmin, dxfdouble& tmax) const
+{
+	assert(this->canEvaluate());
+	tmin = this->knots[this->degree];
+	tmax = this->knots[this->numControlPoints];
+}
+
+//
+// Returns the knot span index for parameter \a t. \a hint is the span
+// found for the previous parameter. Since parameters are normally
+// evaluated in increasing order, the span is searched for linearly
+// from the hint before falling back to a binary search.
+//
+int
+DimeSpline::findSpan(const dxfdouble t, int hint) const
+{
+	const int p = this->degree;
+	const int n = this->numControlPoints - 1;
+	const dxfdouble* U = this->knots;
+
+	if (t >= U[n + 1]) return n;
+	if (t <= U[p]) return p;
+
+	if (hint >= p && hint <= n && t >= U[hint])
+	{
+		for (int i = 0; i < 4 && hint <= n; i++, hint++)
+		{
+			if (t < U[hint + 1]) return hint;
+		}
+	}
+
+	int low = p;
+	int high = n + 1;
+	int mid = (low + high) / 2;
+	while (t < U[mid] || t >= U[mid + 1])
+	{
+		if (t < U[mid]) high = mid;
+		else low = mid;
+		mid = (low + high) / 2;
+	}
+	return mid;
+}
+
+/*!
+  Evaluates the spline at parameter \a t.
+
+  \sa evaluate(const dxfdouble*, int, dimeVec3*)
+*/
+
+dimeVec3
+DimeSpline::evaluate(const dxfdouble t) const
+{
+	dimeVec3 v;
+	this->evaluate(&t, 1, &v);
+	return v;
+}
+
+/*!
+  Evaluates the spline at \a numparams parameter values, and stores
+  the points in \a result. Rational splines are evaluated in
+  homogeneous coordinates using the control point weights.
+
+  This is the efficient way of evaluating many points, as the knot
+  span of the previous parameter is reused when searching for the next
+  one. For best performance, \a params should be sorted in increasing
+  order. The spline must be evaluable.
+
+  \sa canEvaluate(), getParameterRange()
+*/
+
+void
+DimeSpline::evaluate(const dxfdouble* params, const int numparams,
+                     dimeVec3* result) const
+{
+	assert(this->canEvaluate());
+
+	const int p = this->degree;
+	const dxfdouble* U = this->knots;
+	const dimeVec3* P = this->controlPoints;
+	const dxfdouble* W = this->weights;
+	const bool rational = W != nullptr;
+
+	dimeHomogeneousPoint stackbuf[16];
+	dimeHomogeneousPoint* d = p < 16 ? stackbuf :
+		new dimeHomogeneousPoint[p + 1];
+
+	int span = p;
+	for (int k = 0; k < numparams; k++)
+	{
+		const dxfdouble t = params[k];
+		span = this->findSpan(t, span);
+
+		int j;
+		for (j = 0; j <= p; j++)
+		{
+			const int idx = span - p + j;
+			const dxfdouble w = rational ? W[idx] : 1.0;
+			d[j].x = P[idx][0] * w;
+			d[j].y = P[idx][1] * w;
+			d[j].z = P[idx][2] * w;
+			d[j].w = w;
+		}
+
+		for (int r = 1; r <= p; r++)
+		{
+			for (j = p; j >= r; j--)
+			{
+				const int i = span - p + j;
+				const dxfdouble denom = U[i + p - r + 1] - U[i];
+				const dxfdouble alpha = denom != 0.0 ? (t - U[i]) / denom : 0.0;
+				const dxfdouble beta = 1.0 - alpha;
+				d[j].x = beta * d[j - 1].x + alpha * d[j].x;
+				d[j].y = beta * d[j - 1].y + alpha * d[j].y;
+				d[j].z = beta * d[j - 1].z + alpha * d[j].z;
+				d[j].w = beta * d[j - 1].w + alpha * d[j].w;
+			}
+		}
+
+		const dxfdouble w = d[p].w != 0.0 ? d[p].w : 1.0;
+		result[k] = dimeVec3(d[p].x / w, d[p].y / w, d[p].z / w);
+	}
+
+	if (d != stackbuf) delete [] d;
+}
+
+/*!
+  Tessellates the spline into a line strip, and stores the points in
+  \a verts. The number of segments for each knot span is chosen from
+  the second differences of the control points influencing the span,
+  which bound the curvature, so that the chord error stays below
+  \a maxerr. Straight parts of the spline will only get a single
+  segment per knot span. If \a maxerr <= 0.0, a tolerance of 1/1000 of
+  the control polygon size is used.
+
+  Splines without a valid knot vector are approximated by the fit
+  points, or by the control polygon if there are no fit points.
+
+  Returns \c false if the spline has no geometry.
+*/
+
+bool
+DimeSpline::tessellate(dimeArray<dimeVec3>& verts, dxfdouble maxerr) const
+{
+	verts.setCount(0);
+
+	if (!this->canEvaluate())
+	{
+		int i;
+		if (this->fitPoints && this->numFitPoints >= 2)
+		{
+			for (i = 0; i < this->numFitPoints; i++)
+			{
+				verts.append(this->fitPoints[i]);
+			}
+		}
+		else if (this->controlPoints && this->numControlPoints >= 2)
+		{
+			for (i = 0; i < this->numControlPoints; i++)
+			{
+				verts.append(this->controlPoints[i]);
+			}
+		}
+		return verts.count() >= 2;
+	}
+
+	const int p = this->degree;
+	const int n = this->numControlPoints - 1;
+	const dxfdouble* U = this->knots;
+	const dimeVec3* P = this->controlPoints;
+	int i, j;
+
+	if (maxerr <= 0.0)
+	{
+		dimeVec3 minv = P[0];
+		dimeVec3 maxv = P[0];
+		for (i = 1; i <= n; i++)
+		{
+			for (j = 0; j < 3; j++)
+			{
+				if (P[i][j] < minv[j]) minv[j] = P[i][j];
+				if (P[i][j] > maxv[j]) maxv[j] = P[i][j];
+			}
+		}
+		maxerr = (maxv - minv).length() * 0.001;
+		if (maxerr <= 0.0) maxerr = 0.001;
+	}
+
+	// the chord error of a degree p curve split into m segments is
+	// bounded by p(p-1)/8 * max|P[k+2] - 2P[k+1] + P[k]| / m^2
+	const dxfdouble factor = p * (p - 1) / (8.0 * maxerr);
+
+	dimeArray<dxfdouble> params(64);
+	params.append(U[p]);
+	for (int span = p; span <= n; span++)
+	{
+		const dxfdouble t0 = U[span];
+		const dxfdouble t1 = U[span + 1];
+		if (t1 <= t0) continue;
+
+		int m = 1;
+		if (p > 1 && !(this->flags & LINEAR))
+		{
+			dxfdouble maxdiff = 0.0;
+			for (i = span - p; i <= span - 2; i++)
+			{
+				dxfdouble len = (P[i + 2] - P[i + 1] * 2.0 + P[i]).length();
+				if (len > maxdiff) maxdiff = len;
+			}
+			if (this->weights)
+			{
+				// rational curves bend harder near heavy control points
+				dxfdouble wmin = this->weights[span - p];
+				dxfdouble wmax = wmin;
+				for (i = span - p + 1; i <= span; i++)
+				{
+					if (this->weights[i] < wmin) wmin = this->weights[i];
+					if (this->weights[i] > wmax) wmax = this->weights[i];
+				}
+				if (wmin > 0.0) maxdiff *= wmax / wmin;
+			}
+			dxfdouble num = ceil(sqrt(factor * maxdiff));
+			if (num > MAX_SPAN_SEGMENTS) num = MAX_SPAN_SEGMENTS;
+			if (num > 1.0) m = static_cast<int>(num);
+		}
+
+		const dxfdouble inc = (t1 - t0) / m;
+		for (i = 1; i < m; i++)
+		{
+			params.append(t0 + inc * i);
+		}
+		params.append(t1);
+	}
+
+	const int num = params.count();
+	for (i = 0; i < num; i++)
+	{
+		verts.append(dimeVec3(0, 0, 0));
+	}
+	this->evaluate(params.constArrayPointer(), num, verts.arrayPointer());
+	return true;
+}
+
+/*!
+  Tessellates the spline into a line strip using the default
+  tolerance. Splines are always returned as DimeEntity::LINES.
+
+  \sa tessellate()
+*/
+
+DimeEntity::GeometryType
+DimeSpline::extractGeometry(dimeArray<dimeVec3>& verts,
+                            dimeArray<int>& indices,
+                            dimeVec3& extrusionDir,
+                            dxfdouble& thickness)
+{
+	indices.setCount(0);
+	extrusionDir = dimeVec3(0, 0, 1);
+	thickness = 0.0;
+
+	if (!this->tessellate(verts, 0.0)) return NONE;
+	return LINES;
 }
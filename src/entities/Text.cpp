@@ -330,3 +330,18 @@ DimeText::countRecords() const
 
 	return cnt + DimeExtrusionEntity::countRecords();
 }
+
+//!
+
+size_t
+DimeText::countMemory(dimeMemoryUsage& usage) const
+{
+	size_t size = sizeof(DimeText);
+	if (this->text)
+	{
+		const size_t len = strlen(this->text) + 1;
+		usage.strings += len;
+		size += len;
+	}
+	return size + DimeExtrusionEntity::countMemory(usage);
+}
@@ -182,12 +182,14 @@ void
 DimeTrace::setThickness(const dxfdouble& thickness)
 {
 	this->thickness = thickness;
+	this->setDirty();
 }
 
 void
 DimeTrace::setExtrusionDir(const dimeVec3& ed)
 {
 	this->extrusionDir = ed;
+	this->setDirty();
 }
 
 //!
@@ -205,3 +207,11 @@ DimeTrace::countRecords() const
 	}
 	return cnt;
 }
+
+//!
+
+size_t
+DimeTrace::countMemory(dimeMemoryUsage& usage) const
+{
+	return sizeof(DimeTrace) + dimeFaceEntity::countMemory(usage);
+}
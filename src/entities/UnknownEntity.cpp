@@ -103,6 +103,21 @@ DimeUnknownEntity::countRecords() const
 
 //!
 
+size_t
+DimeUnknownEntity::countMemory(dimeMemoryUsage& usage) const
+{
+	size_t size = sizeof(DimeUnknownEntity);
+	if (this->entityName)
+	{
+		const size_t len = strlen(this->entityName) + 1;
+		usage.strings += len;
+		size += len;
+	}
+	return size + DimeEntity::countMemory(usage);
+}
+
+//!
+
 const char*
 DimeUnknownEntity::getEntityName() const
 {
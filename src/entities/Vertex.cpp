@@ -233,3 +233,11 @@ DimeVertex::countRecords() const
 	}
 	return cnt;
 }
+
+//!
+
+size_t
+DimeVertex::countMemory(dimeMemoryUsage& usage) const
+{
+	return sizeof(DimeVertex) + DimeEntity::countMemory(usage);
+}
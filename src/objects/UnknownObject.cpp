@@ -103,6 +103,21 @@ dimeUnknownObject::countRecords() const
 
 //!
 
+size_t
+dimeUnknownObject::countMemory(dimeMemoryUsage& usage) const
+{
+	size_t size = sizeof(dimeUnknownObject);
+	if (this->objectName)
+	{
+		const size_t len = strlen(this->objectName) + 1;
+		usage.strings += len;
+		size += len;
+	}
+	return size + DimeObject::countMemory(usage);
+}
+
+//!
+
 const char*
 dimeUnknownObject::getObjectName() const
 {
@@ -47,6 +47,9 @@
 #include <dime/records/Int8Record.h>
 #include <dime/records/Int16Record.h>
 #include <dime/records/Int32Record.h>
+#include <dime/Model.h>
+#include "../StatsData.h"
+#include <string.h>
 
 /*!
   \fn void dimeRecord::setValue(const dimeParam &param, dimeMemHandler * const memhandler = NULL) = 0
@@ -135,6 +138,55 @@ DimeRecord::write(DimeOutput* const out)
 	return out->writeGroupCode(groupCode);
 }
 
+/*!
+  Returns the number of bytes allocated for this record, including
+  its string. The bytes are also added to \e records and \e strings in
+  \a usage, but not to the total.
+*/
+
+size_t
+DimeRecord::countMemory(dimeMemoryUsage& usage) const
+{
+	size_t size;
+	switch (this->typeId())
+	{
+	case dimeInt8RecordType:
+		size = sizeof(dimeInt8Record);
+		break;
+	case dimeInt16RecordType:
+		size = sizeof(dimeInt16Record);
+		break;
+	case dimeInt32RecordType:
+		size = sizeof(dimeInt32Record);
+		break;
+	case dimeFloatRecordType:
+		size = sizeof(dimeFloatRecord);
+		break;
+	case dimeDoubleRecordType:
+		size = sizeof(dimeDoubleRecord);
+		break;
+	case dimeHexRecordType:
+		size = sizeof(dimeHexRecord);
+		break;
+	default:
+		size = sizeof(dimeStringRecord);
+		break;
+	}
+	usage.records += size;
+	if (this->typeId() == dimeStringRecordType || this->typeId() == dimeHexRecordType)
+	{
+		dimeParam param;
+		this->getValue(param);
+		if (param.string_data)
+		{
+			const size_t len = strlen(param.string_data) + 1;
+			usage.strings += len;
+			size += len;
+		}
+	}
+	return size;
+}
+
 // * static methods *******************************************************
 
 /*!
@@ -351,6 +403,16 @@ get_record_type(const int group_code)
 	return type;
 }
 
+struct dimeRecordTypeTable
+{
+	dimeRecordTypeTable()
+	{
+		for (int i = 0; i < 1072; i++) this->types[i] = get_record_type(i);
+	}
+
+	int types[1072];
+};
+
 /*!
   Static function that returns the record type based on
   the group code.
@@ -359,19 +421,11 @@ get_record_type(const int group_code)
 int
 DimeRecord::getRecordType(const int group_code)
 {
-	static int first = 1;
-	static int translation[1072];
-	if (first)
-	{
-		first = 0;
-		for (int i = 0; i < 1072; i++)
-		{
-			translation[i] = get_record_type(i);
-		}
-	}
+	// initialization of a local static is thread safe
+	static const dimeRecordTypeTable table;
 	if (group_code < 0 || group_code >= 1072)
 		return dimeStringRecordType;
-	return translation[group_code];
+	return table.types[group_code];
 }
 
 /*!
@@ -423,5 +477,7 @@ DimeRecord::readRecordData(DimeInput* const in, const int group_code,
 		ret = false;
 		break;
 	}
+	if (dimeStatsData* s = dimeStatsData::get(in->getStats()))
+		dimeStatsData::addType(s->records, type, 1);
 	return ret;
 }
@@ -80,7 +80,9 @@ dimeStringRecord::copy() const
 bool
 dimeStringRecord::setString(const char* const s)
 {
+	char* old = this->string;
 	DXF_STRCPY(this->string, s);
+	delete[] old;
 	return this->string != nullptr;
 }
 
@@ -159,8 +161,7 @@ dimeStringRecord::write(DimeOutput* const out)
 void
 dimeStringRecord::setValue(const dimeParam& param)
 {
-	this->string = new char[strlen(param.string_data) + 1];
-	if (this->string) strcpy(this->string, param.string_data);
+	this->setString(param.string_data);
 }
 
 //!
@@ -43,6 +43,8 @@
 #include <dime/Model.h>
 #include <dime/util/Array.h>
 #include <dime/Model.h>
+#include "../Diagnostic.h"
+#include <vector>
 
 static constexpr char sectionName[] = "BLOCKS";
 
@@ -83,9 +85,14 @@ DimeBlocksSection::read(DimeInput* const file)
 
 	while (true)
 	{
+		if (file->checkAborted())
+		{
+			ok = false;
+			break;
+		}
 		if (!file->readGroupCode(groupcode) || groupcode != 0)
 		{
-			fprintf(stderr, "Error reading groupcode: %d\n", groupcode);
+			dime_diagnostic("Error reading groupcode: %d\n", groupcode);
 			ok = false;
 			break;
 		}
@@ -93,20 +100,20 @@ DimeBlocksSection::read(DimeInput* const file)
 		if (!strcmp(string, "ENDSEC")) break;
 		if (strcmp(string, "BLOCK"))
 		{
-			fprintf(stderr, "Unexpected string.\n");
+			dime_diagnostic("Unexpected string.\n");
 			ok = false;
 			break;
 		}
 		block = static_cast<DimeBlock*>(DimeEntity::createEntity(string));
 		if (block == nullptr)
 		{
-			fprintf(stderr, "error creating block: %s\n", string);
+			dime_diagnostic("error creating block: %s\n", string);
 			ok = false;
 			break;
 		}
 		if (!block->read(file))
 		{
-			fprintf(stderr, "error reading block: %s.\n", string);
+			dime_diagnostic("error reading block: %s.\n", string);
 			ok = false;
 			break;
 		}
@@ -124,12 +131,9 @@ DimeBlocksSection::write(DimeOutput* const file)
 {
 	if (file->writeGroupCode(2) && file->writeString(sectionName))
 	{
-		int i;
-		for (i = 0; i < this->blocks.count(); i++)
-		{
-			if (!this->blocks[i]->write(file)) break;
-		}
-		if (i == this->blocks.count())
+		std::vector<DimeEntity*> entities(this->blocks.constArrayPointer(),
+		                                  this->blocks.constArrayPointer() + this->blocks.count());
+		if (file->writeEntities(entities.data(), this->blocks.count()))
 		{
 			return file->writeGroupCode(0) && file->writeString("ENDSEC");
 		}
@@ -174,6 +178,18 @@ DimeBlocksSection::countRecords() const
 
 //!
 
+size_t
+DimeBlocksSection::countMemory(dimeMemoryUsage& usage) const
+{
+	size_t size = sizeof(DimeBlocksSection) + this->blocks.allocSize() * sizeof(DimeBlock*);
+	const int n = this->blocks.count();
+	for (int i = 0; i < n; i++)
+		DimeEntity::countEntityMemory(this->blocks[i], usage);
+	return size;
+}
+
+//!
+
 const char*
 DimeBlocksSection::getSectionName() const
 {
@@ -208,6 +224,7 @@ DimeBlocksSection::getBlock(const int idx)
 void
 DimeBlocksSection::removeBlock(const int idx)
 {
+	this->setDirty();
 	assert(idx >= 0 && idx < this->blocks.count());
 	delete this->blocks[idx];
 	this->blocks.removeElem(idx);
@@ -221,6 +238,7 @@ DimeBlocksSection::removeBlock(const int idx)
 void
 DimeBlocksSection::insertBlock(DimeBlock* const block, const int idx)
 {
+	this->setDirty();
 	if (idx < 0) this->blocks.append(block);
 	else
 	{
@@ -42,6 +42,7 @@
 #include <dime/Model.h>
 #include <dime/classes/Class.h>
 #include <dime/Model.h>
+#include "../Diagnostic.h"
 
 #include <string.h>
 
@@ -107,7 +108,7 @@ DimeClassesSection::read(DimeInput* const file)
 	{
 		if (!file->readGroupCode(groupcode) || (groupcode != 9 && groupcode != 0))
 		{
-			fprintf(stderr, "Error reading classes groupcode: %d.\n", groupcode);
+			dime_diagnostic("Error reading classes groupcode: %d.\n", groupcode);
 			//      sim_warning("Error reading classes groupcode: %d.\n", groupcode);
 			ok = false;
 			break;
@@ -117,14 +118,14 @@ DimeClassesSection::read(DimeInput* const file)
 		myclass = DimeClass::createClass(string);
 		if (myclass == nullptr)
 		{
-			fprintf(stderr, "error creating class: %s.\n", string);
+			dime_diagnostic("error creating class: %s.\n", string);
 			//      sim_warning("error creating class: %s.\n", string);
 			ok = false;
 			break;
 		}
 		if (!myclass->read(file))
 		{
-			fprintf(stderr, "error reading class: %s.\n", string);
+			dime_diagnostic("error reading class: %s.\n", string);
 			//      sim_warning("error reading class: %s.\n", string);
 			ok = false;
 			break;
@@ -180,6 +181,18 @@ DimeClassesSection::countRecords() const
 
 //!
 
+size_t
+DimeClassesSection::countMemory(dimeMemoryUsage& usage) const
+{
+	size_t size = sizeof(DimeClassesSection) + this->classes.allocSize() * sizeof(DimeClass*);
+	const int n = this->classes.count();
+	for (int i = 0; i < n; i++)
+		size += this->classes[i]->countMemory(usage);
+	return size;
+}
+
+//!
+
 const char*
 DimeClassesSection::getSectionName() const
 {
@@ -214,6 +227,7 @@ DimeClassesSection::getClass(const int idx)
 void
 DimeClassesSection::removeClass(const int idx)
 {
+	this->setDirty();
 	assert(idx >= 0 && idx < this->classes.count());
 	delete this->classes[idx];
 	this->classes.removeElem(idx);
@@ -227,6 +241,7 @@ DimeClassesSection::removeClass(const int idx)
 void
 DimeClassesSection::insertClass(DimeClass* const myclass, const int idx)
 {
+	this->setDirty();
 	if (idx < 0) this->classes.append(myclass);
 	else
 	{
@@ -46,6 +46,7 @@
 #include <dime/entities/3DFace.h>
 #include <dime/entities/Insert.h>
 #include <dime/entities/Block.h>
+#include "../Diagnostic.h"
 
 #include <string.h>
 
@@ -103,28 +104,35 @@ DimeEntitiesSection::read(DimeInput* const file)
 
 	while (true)
 	{
+		if (file->checkAborted())
+		{
+			ok = false;
+			break;
+		}
 		if (!file->readGroupCode(groupcode) || groupcode != 0)
 		{
-			fprintf(stderr, "Error reading groupcode: %d.\n", groupcode);
+			dime_diagnostic("Error reading groupcode: %d.\n", groupcode);
 			ok = false;
 			break;
 		}
+		const long start = file->getGroupCodeOffset();
 		string = file->readString();
 		if (!strcmp(string, "ENDSEC")) break;
 
 		entity = DimeEntity::createEntity(string);
 		if (entity == nullptr)
 		{
-			fprintf(stderr, "Error creating entity: %s.\n", string);
+			dime_diagnostic("Error creating entity: %s.\n", string);
 			ok = false;
 			break;
 		}
 		if (!entity->read(file))
 		{
-			fprintf(stderr, "Error reading entity: %s.\n", string);
+			dime_diagnostic("Error reading entity: %s.\n", string);
 			ok = false;
 			break;
 		}
+		entity->sourceIndex = file->addSourceRange(entity, start, file->getGroupCodeOffset());
 		this->entities.append(entity);
 	}
 	return ok;
@@ -140,12 +148,7 @@ DimeEntitiesSection::write(DimeOutput* const file)
 	file->writeGroupCode(2);
 	file->writeString(sectionName);
 
-	int i, n = this->entities.count();
-	for (i = 0; i < n; i++)
-	{
-		if (!this->entities[i]->write(file)) break;
-	}
-	if (i == n)
+	if (file->writeEntities(this->entities.constArrayPointer(), this->entities.count()))
 	{
 		file->writeGroupCode(0);
 		file->writeString("ENDSEC");
@@ -189,6 +192,18 @@ DimeEntitiesSection::countRecords() const
 
 //!
 
+size_t
+DimeEntitiesSection::countMemory(dimeMemoryUsage& usage) const
+{
+	size_t size = sizeof(DimeEntitiesSection) + this->entities.allocSize() * sizeof(DimeEntity*);
+	const int n = this->entities.count();
+	for (int i = 0; i < n; i++)
+		DimeEntity::countEntityMemory(this->entities[i], usage);
+	return size;
+}
+
+//!
+
 const char*
 DimeEntitiesSection::getSectionName() const
 {
@@ -224,6 +239,7 @@ DimeEntitiesSection::getEntity(const int idx)
 void
 DimeEntitiesSection::removeEntity(const int idx)
 {
+	this->setDirty();
 	assert(idx >= 0 && idx < this->entities.count());
 	delete this->entities[idx];
 	this->entities.removeElem(idx);
@@ -232,6 +248,7 @@ DimeEntitiesSection::removeEntity(const int idx)
 /*!
   Inserts a new entity at index \a idx. If \a idx is negative, the
   entity will be inserted at the end of the list of entities.
+  The entity is marked as dirty, see DimeEntity::isDirty().
 
   Entities should never be allocated on the stack. Use the
   new and delete operators to create/destroy entities.
@@ -240,6 +257,8 @@ DimeEntitiesSection::removeEntity(const int idx)
 void
 DimeEntitiesSection::insertEntity(DimeEntity* const entity, const int idx)
 {
+	this->setDirty();
+	entity->setDirty();
 	if (idx < 0) this->entities.append(entity);
 	else
 	{
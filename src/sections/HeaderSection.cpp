@@ -104,6 +104,7 @@ DimeHeaderSection::setVariable(const char* const variableName,
                                const dimeParam* const params,
                                const int numparams)
 {
+	this->setDirty();
 	int i = findVariable(variableName);
 	if (i < 0)
 	{
@@ -229,6 +230,20 @@ DimeHeaderSection::countRecords() const
 	return this->records.count() + 2; // numrecords + SECTIONNAME + EOS
 }
 
+//!
+
+size_t
+DimeHeaderSection::countMemory(dimeMemoryUsage& usage) const
+{
+	const size_t array = this->records.allocSize() * sizeof(DimeRecord*);
+	usage.records += array;
+	size_t size = sizeof(DimeHeaderSection) + array;
+	const int n = this->records.count();
+	for (int i = 0; i < n; i++)
+		size += this->records[i]->countMemory(usage);
+	return size;
+}
+
 //
 // returns the index of the variable, or -1 if variable isn't found. 
 //
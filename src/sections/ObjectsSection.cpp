@@ -42,6 +42,7 @@
 #include <dime/Model.h>
 #include <dime/objects/Object.h>
 #include <dime/Model.h>
+#include "../Diagnostic.h"
 #include <string.h>
 
 static constexpr char sectionName[] = "OBJECTS";
@@ -105,7 +106,7 @@ DimeObjectsSection::read(DimeInput* const file)
 	{
 		if (!file->readGroupCode(groupcode) || groupcode != 0)
 		{
-			fprintf(stderr, "Error reading objects groupcode: %d.\n", groupcode);
+			dime_diagnostic("Error reading objects groupcode: %d.\n", groupcode);
 			//      sim_warning("Error reading objects groupcode: %d.\n", groupcode);
 			ok = false;
 			break;
@@ -115,14 +116,14 @@ DimeObjectsSection::read(DimeInput* const file)
 		object = DimeObject::createObject(string);
 		if (object == nullptr)
 		{
-			fprintf(stderr, "error creating object: %s.\n", string);
+			dime_diagnostic("error creating object: %s.\n", string);
 			//      sim_warning("error creating object: %s.\n", string);
 			ok = false;
 			break;
 		}
 		if (!object->read(file))
 		{
-			fprintf(stderr, "error reading object: %s.\n", string);
+			dime_diagnostic("error reading object: %s.\n", string);
 			//      sim_warning("error reading object: %s.\n", string);
 			ok = false;
 			break;
@@ -178,6 +179,18 @@ DimeObjectsSection::countRecords() const
 
 //!
 
+size_t
+DimeObjectsSection::countMemory(dimeMemoryUsage& usage) const
+{
+	size_t size = sizeof(DimeObjectsSection) + this->objects.allocSize() * sizeof(DimeObject*);
+	const int n = this->objects.count();
+	for (int i = 0; i < n; i++)
+		size += this->objects[i]->countMemory(usage);
+	return size;
+}
+
+//!
+
 const char*
 DimeObjectsSection::getSectionName() const
 {
@@ -212,6 +225,7 @@ DimeObjectsSection::getObject(const int idx)
 void
 DimeObjectsSection::removeObject(const int idx)
 {
+	this->setDirty();
 	assert(idx >= 0 && idx < this->objects.count());
 	delete this->objects[idx];
 	this->objects.removeElem(idx);
@@ -225,6 +239,7 @@ DimeObjectsSection::removeObject(const int idx)
 void
 DimeObjectsSection::insertObject(DimeObject* const object, const int idx)
 {
+	this->setDirty();
 	if (idx < 0) this->objects.append(object);
 	else
 	{
@@ -59,11 +59,28 @@
   Returns the number of records in this section. 
 */
 
+/*!
+  \fn bool DimeSection::isDirty() const
+  Returns \e true if the section has been changed since it was read.
+  New sections are always dirty. This is used by DimeModel::write() to
+  decide if a section can be copied from the source file, see
+  DimeModel::setPassthrough().
+*/
+
+/*!
+  \fn void DimeSection::setDirty(bool onOff)
+  Marks the section as changed. The section methods that insert or
+  remove items do this automatically, but changes made directly to
+  table entries, classes or objects are not tracked. Call this method
+  after making such changes.
+*/
+
 /*!
   Constructor
 */
 
 DimeSection::DimeSection()
+	: dirty(true), sourceIndex(-1)
 {
 }
 
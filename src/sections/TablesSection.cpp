@@ -42,6 +42,7 @@
 
 #include <dime/Model.h>
 #include <dime/util/Array.h>
+#include "../Diagnostic.h"
 
 static constexpr char sectionName[] = "TABLES";
 
@@ -75,7 +76,7 @@ DimeTablesSection::copy(DimeModel* const model) const
 		}
 		if (i < n)
 		{
-			fprintf(stderr, "Error copying TABLES section.\n");
+			dime_diagnostic("Error copying TABLES section.\n");
 			//      sim_warning("Error copying TABLES section.\n");
 			return nullptr;
 		}
@@ -101,7 +102,7 @@ DimeTablesSection::read(DimeInput* const file)
 	{
 		if (!file->readGroupCode(groupcode) || groupcode != 0)
 		{
-			fprintf(stderr, "Error reading groupcode: %d\n", groupcode);
+			dime_diagnostic("Error reading groupcode: %d\n", groupcode);
 			//      sim_warning("Error reading groupcode: %d\n", groupcode);
 			ok = false;
 			break;
@@ -110,7 +111,7 @@ DimeTablesSection::read(DimeInput* const file)
 		if (!strcmp(string, "ENDSEC")) break;
 		if (strcmp(string, "TABLE"))
 		{
-			fprintf(stderr, "unexpected string.\n");
+			dime_diagnostic("unexpected string.\n");
 			//      sim_warning("unexpected string.\n");
 			ok = false;
 			break;
@@ -119,14 +120,14 @@ DimeTablesSection::read(DimeInput* const file)
 		table = new DimeTable;
 		if (table == nullptr)
 		{
-			fprintf(stderr, "error creating table: %s\n", string);
+			dime_diagnostic("error creating table: %s\n", string);
 			//      sim_warning("error creating table: %s\n", string);
 			ok = false;
 			break;
 		}
 		if (!table->read(file))
 		{
-			fprintf(stderr, "error reading table: %s.\n", string);
+			dime_diagnostic("error reading table: %s.\n", string);
 			//      sim_warning("error reading table: %s.\n", string);
 			ok = false;
 			break;
@@ -178,6 +179,18 @@ DimeTablesSection::countRecords() const
 
 //!
 
+size_t
+DimeTablesSection::countMemory(dimeMemoryUsage& usage) const
+{
+	size_t size = sizeof(DimeTablesSection) + this->tables.allocSize() * sizeof(DimeTable*);
+	const int n = this->tables.count();
+	for (int i = 0; i < n; i++)
+		size += this->tables[i]->countMemory(usage);
+	return size;
+}
+
+//!
+
 const char*
 DimeTablesSection::getSectionName() const
 {
@@ -212,6 +225,7 @@ DimeTablesSection::getTable(const int idx)
 void
 DimeTablesSection::removeTable(const int idx)
 {
+	this->setDirty();
 	assert(idx >= 0 && idx < this->tables.count());
 	delete this->tables[idx];
 	this->tables.removeElem(idx);
@@ -227,6 +241,7 @@ DimeTablesSection::removeTable(const int idx)
 void
 DimeTablesSection::insertTable(DimeTable* const table, const int idx)
 {
+	this->setDirty();
 	if (idx < 0) this->tables.append(table);
 	else
 	{
@@ -42,6 +42,7 @@
 
 #include <dime/util/Array.h>
 #include <dime/Model.h>
+#include "../Diagnostic.h"
 
 #include <string.h>
 #include <stdio.h>
@@ -114,8 +115,8 @@ dimeUnknownSection::read(DimeInput* const file)
 		record = DimeRecord::readRecord(file);
 		if (record == nullptr)
 		{
-			fprintf(stderr, "could not create/read record (dimeUnknownSection.cpp)"
-			        "line: %d\n", file->getFilePosition());
+			dime_diagnostic("could not create/read record (dimeUnknownSection.cpp)"
+			                "line: %d\n", file->getFilePosition());
 			ok = false;
 			break;
 		}
@@ -170,6 +171,25 @@ dimeUnknownSection::countRecords() const
 
 //!
 
+size_t
+dimeUnknownSection::countMemory(dimeMemoryUsage& usage) const
+{
+	const size_t array = this->numRecords * sizeof(DimeRecord*);
+	usage.records += array;
+	size_t size = sizeof(dimeUnknownSection) + array;
+	if (this->sectionName)
+	{
+		const size_t len = strlen(this->sectionName) + 1;
+		usage.strings += len;
+		size += len;
+	}
+	for (int i = 0; i < this->numRecords; i++)
+		size += this->records[i]->countMemory(usage);
+	return size;
+}
+
+//!
+
 const char*
 dimeUnknownSection::getSectionName() const
 {
@@ -160,6 +160,23 @@ DimeLayerTable::countRecords() const
 	return cnt + DimeTableEntry::countRecords();
 }
 
+//!
+
+size_t
+DimeLayerTable::countMemory(dimeMemoryUsage& usage) const
+{
+	size_t size = sizeof(DimeLayerTable);
+	if (this->layerName)
+	{
+		const size_t len = strlen(this->layerName) + 1;
+		usage.strings += len;
+		size += len;
+	}
+	size += DimeTableEntry::countMemory(usage);
+	usage.layers += size;
+	return size;
+}
+
 /*!
   Sets the layer name.
 */
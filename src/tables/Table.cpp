@@ -284,6 +284,34 @@ DimeTable::countRecords() const
 	return cnt;
 }
 
+/*!
+  Returns the number of bytes allocated for this table, including its
+  table entries and records.
+  \sa DimeModel::getMemoryUsage()
+*/
+
+size_t
+DimeTable::countMemory(dimeMemoryUsage& usage) const
+{
+	size_t size = sizeof(DimeTable);
+	if (this->tablename)
+	{
+		const size_t len = strlen(this->tablename) + 1;
+		usage.strings += len;
+		size += len;
+	}
+	const size_t arrays = this->records.allocSize() * sizeof(DimeRecord*);
+	usage.records += arrays;
+	size += arrays + this->tableEntries.allocSize() * sizeof(DimeTableEntry*);
+	int i, n = this->records.count();
+	for (i = 0; i < n; i++)
+		size += this->records[i]->countMemory(usage);
+	n = this->tableEntries.count();
+	for (i = 0; i < n; i++)
+		size += this->tableEntries[i]->countMemory(usage);
+	return size;
+}
+
 /*!
   Returns the number of table entries in this table. 
 */
@@ -156,3 +156,11 @@ DimeUCSTable::countRecords() const
 	int cnt = 1 + 3 + 3 + 3; // header + origin + xaxis + yaxis
 	return cnt + DimeTableEntry::countRecords();
 }
+
+//!
+
+size_t
+DimeUCSTable::countMemory(dimeMemoryUsage& usage) const
+{
+	return sizeof(DimeUCSTable) + DimeTableEntry::countMemory(usage);
+}
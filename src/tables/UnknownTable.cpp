@@ -107,6 +107,21 @@ DimeUnknownTable::countRecords() const
 
 //!
 
+size_t
+DimeUnknownTable::countMemory(dimeMemoryUsage& usage) const
+{
+	size_t size = sizeof(DimeUnknownTable);
+	if (this->tableName)
+	{
+		const size_t len = strlen(this->tableName) + 1;
+		usage.strings += len;
+		size += len;
+	}
+	return size + DimeTableEntry::countMemory(usage);
+}
+
+//!
+
 const char*
 DimeUnknownTable::getTableName() const
 {
@@ -35,6 +35,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <float.h>
+#include "../StatsData.h"
 
 
 /*!
@@ -51,7 +52,7 @@ public:
 	dime_bspnode(dimeArray<dimeVec3>* array);
 	~dime_bspnode();
 
-	int addPoint(const dimeVec3& pt, int maxpts);
+	int addPoint(const dimeVec3& pt, int maxpts, dimeStatsData* stats);
 	int findPoint(const dimeVec3& pt) const;
 	int removePoint(const dimeVec3& pt);
 
@@ -100,18 +101,19 @@ dime_bspnode::leftOf(const dimeVec3& pt) const
 }
 
 int
-dime_bspnode::addPoint(const dimeVec3& pt, const int maxpts)
+dime_bspnode::addPoint(const dimeVec3& pt, const int maxpts, dimeStatsData* const stats)
 {
 	if (this->left)
 	{
 		// node has been split
-		if (this->leftOf(pt)) return this->left->addPoint(pt, maxpts);
-		return this->right->addPoint(pt, maxpts);
+		if (this->leftOf(pt)) return this->left->addPoint(pt, maxpts, stats);
+		return this->right->addPoint(pt, maxpts, stats);
 	}
 	if (this->indices.count() >= maxpts)
 	{
 		split();
-		return this->addPoint(pt, maxpts);
+		if (stats) dimeStatsData::add(stats->bspSplits, 1);
+		return this->addPoint(pt, maxpts, stats);
 	}
 	int n = this->indices.count();
 	int i;
@@ -278,6 +280,7 @@ dimeBSPTree::dimeBSPTree(const int maxnodepts, const int initsize)
 	this->boundingBox = new dimeBox;
 	this->topnode = new dime_bspnode(&this->pointsArray);
 	this->maxnodepoints = maxnodepts;
+	this->stats = nullptr;
 }
 
 /*!
@@ -309,6 +312,17 @@ dimeBSPTree::getPoint(const int idx, dimeVec3& pt)
 	this->pointsArray.getElem(idx, pt);
 }
 
+/*!
+  Returns a pointer to all the points in the BSP tree. The pointer is
+  invalidated when points are added or removed.
+  \sa dimeBSPTree::numPoints()
+*/
+const dimeVec3*
+dimeBSPTree::getPoints() const
+{
+	return this->pointsArray.constArrayPointer();
+}
+
 /*!
   Returns the user data for the point at index \a idx.
 */
@@ -329,6 +343,16 @@ dimeBSPTree::setUserData(const int idx, void* const data)
 	this->userdataArray[idx] = data;
 }
 
+/*!
+  Sets the statistics object that counts point insertions and node
+  splits. Set to \e nullptr (the default) to disable counting.
+*/
+void
+dimeBSPTree::setStats(DimeStats* const stats)
+{
+	this->stats = stats;
+}
+
 /*!
   Attempts to add a new point to the BSP tree. If a point
   with the same coordinates as \a pt already is in the tree,
@@ -340,7 +364,9 @@ int
 dimeBSPTree::addPoint(const dimeVec3& pt, void* const data)
 {
 	this->boundingBox->grow(pt);
-	int ret = this->topnode->addPoint(pt, this->maxnodepoints);
+	dimeStatsData* stats = dimeStatsData::get(this->stats);
+	if (stats) dimeStatsData::add(stats->bspInserts, 1);
+	int ret = this->topnode->addPoint(pt, this->maxnodepoints, stats);
 	if (ret == this->userdataArray.count())
 	{
 		this->userdataArray.append(data);
@@ -43,7 +43,9 @@
 */
 
 #include <dime/util/Dict.h>
+#include <dime/Model.h>
 #include <stdio.h>
+#include "../StatsData.h"
 
 /*!
   Constructor.  Creates \a entries buckets.
@@ -52,6 +54,7 @@
 dimeDict::dimeDict(const int entries)
 {
 	this->tableSize = entries;
+	this->stats = nullptr;
 	this->buckets = new dimeDictEntry*[tableSize];
 	for (int i = 0; i < tableSize; i++)
 		buckets[i] = nullptr;
@@ -189,6 +192,39 @@ dimeDict::remove(const char* const key)
 	return true;
 }
 
+/*!
+  Sets the statistics object that counts lookups and collisions. A
+  collision is counted for every entry with a different key passed in
+  a bucket. Set to \e nullptr (the default) to disable counting.
+*/
+
+void
+dimeDict::setStats(DimeStats* const stats)
+{
+	this->stats = stats;
+}
+
+/*!
+  Returns the number of bytes allocated for the dictionary, and adds
+  the keys to \e strings in \a usage.
+*/
+
+size_t
+dimeDict::countMemory(dimeMemoryUsage& usage) const
+{
+	size_t size = sizeof(dimeDict) + this->tableSize * sizeof(dimeDictEntry*);
+	for (int i = 0; i < this->tableSize; i++)
+	{
+		for (const dimeDictEntry* entry = this->buckets[i]; entry; entry = entry->next)
+		{
+			const size_t len = strlen(entry->key) + 1;
+			usage.strings += len;
+			size += sizeof(dimeDictEntry) + len;
+		}
+	}
+	return size;
+}
+
 // private funcs
 
 dimeDictEntry*&
@@ -198,10 +234,17 @@ dimeDict::findEntry(const char* const key) const
 
 	entry = &buckets[bucketNr(key) % tableSize];
 
+	int collisions = 0;
 	while (*entry != nullptr)
 	{
 		if (strcmp((*entry)->key, key) == 0) break;
 		entry = &(*entry)->next;
+		collisions++;
+	}
+	if (dimeStatsData* s = dimeStatsData::get(this->stats))
+	{
+		dimeStatsData::add(s->dictLookups, 1);
+		if (collisions) dimeStatsData::add(s->dictCollisions, collisions);
 	}
 	return *entry;
 }
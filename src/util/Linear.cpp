@@ -51,6 +51,11 @@
 #include <dime/util/Linear.h>
 #include <stdio.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DIME_HAVE_SSE2
+#endif
+
 #if 0 // OBSOLETED, was needed for old inverse() method
 
 #if defined(__sgi) || defined (__sparc)
@@ -101,16 +106,16 @@ dimeVec3::angle(const dimeVec3& v2)
 
 dimeMatrix::dimeMatrix(const dimeMatrix& m)
 {
-	dxfdouble* p1 = &this->matrix[0][0];
-	const dxfdouble* p2 = &m.matrix[0][0];
+	dxfmath* p1 = &this->matrix[0][0];
+	const dxfmath* p2 = &m.matrix[0][0];
 	int n = 16;
 	while (n--) *p1++ = *p2++;
 }
 
-dimeMatrix::dimeMatrix(dxfdouble a11, dxfdouble a12, dxfdouble a13, dxfdouble a14,
-                       dxfdouble a21, dxfdouble a22, dxfdouble a23, dxfdouble a24,
-                       dxfdouble a31, dxfdouble a32, dxfdouble a33, dxfdouble a34,
-                       dxfdouble a41, dxfdouble a42, dxfdouble a43, dxfdouble a44)
+dimeMatrix::dimeMatrix(dxfmath a11, dxfmath a12, dxfmath a13, dxfmath a14,
+                       dxfmath a21, dxfmath a22, dxfmath a23, dxfmath a24,
+                       dxfmath a31, dxfmath a32, dxfmath a33, dxfmath a34,
+                       dxfmath a41, dxfmath a42, dxfmath a43, dxfmath a44)
 {
 	this->matrix[0][0] = a11;
 	this->matrix[0][1] = a12;
@@ -133,7 +138,7 @@ dimeMatrix::dimeMatrix(dxfdouble a11, dxfdouble a12, dxfdouble a13, dxfdouble a1
 void
 dimeMatrix::transpose()
 {
-	dxfdouble tmp;
+	dxfmath tmp;
 	for (int i = 0; i < 3; i++)
 	{
 		for (int j = i + 1; j < 4; j++)
@@ -220,7 +225,7 @@ dimeMatrix::multRight(const dimeMatrix& m) // this = this * m
 {
 	dimeMatrix copy = *this;
 	auto mat1 = copy.matrix;
-	auto mat2 = (dxfdouble (*)[4])m.matrix;
+	auto mat2 = (dxfmath (*)[4])m.matrix;
 
 	int i, j, n;
 
@@ -239,7 +244,7 @@ dimeMatrix&
 dimeMatrix::multLeft(const dimeMatrix& m) // this = m * this
 {
 	dimeMatrix copy = *this;
-	auto mat1 = (dxfdouble (*)[4])m.matrix;
+	auto mat1 = (dxfmath (*)[4])m.matrix;
 	auto mat2 = copy.matrix;
 
 	int i, j, n;
@@ -260,8 +265,8 @@ dimeMatrix::multLeft(const dimeMatrix& m) // this = m * this
 void
 dimeMatrix::setRotate(const dimeVec3& rot)
 {
-	dxfdouble s = sin(DXFDEG2RAD(rot.z));
-	dxfdouble c = cos(DXFDEG2RAD(rot.z));
+	dxfmath s = sin(DXFDEG2RAD(rot.z));
+	dxfmath c = cos(DXFDEG2RAD(rot.z));
 	this->matrix[0][0] = c;
 	this->matrix[0][1] = -s;
 	this->matrix[1][0] = s;
@@ -291,9 +296,9 @@ dimeMatrix::setRotate(const dimeVec3& x, const dimeVec3& y, const dimeVec3& z)
 }
 
 void
-dimeMatrix::setRotation(const dimeVec3& u, const dxfdouble angle)
+dimeMatrix::setRotation(const dimeVec3& u, const dxfmath angle)
 {
-	dxfdouble cost, sint;
+	dxfmath cost, sint;
 
 	cost = cos(angle);
 	sint = sin(angle);
@@ -314,7 +319,7 @@ dimeMatrix::setRotation(const dimeVec3& u, const dxfdouble angle)
 }
 
 void
-dimeMatrix::setScale(const dxfdouble s)
+dimeMatrix::setScale(const dxfmath s)
 {
 	this->matrix[0][0] = this->matrix[1][1] = this->matrix[2][2] = s;
 }
@@ -347,7 +352,7 @@ dimeMatrix::multMatrixVec(dimeVec3& vec) const
 void
 dimeMatrix::multMatrixVec(const dimeVec3& src, dimeVec3& dst) const
 {
-	dxfdouble W =
+	dxfmath W =
 		src.x * matrix[3][0] +
 		src.y * matrix[3][1] +
 		src.z * matrix[3][2] +
@@ -369,11 +374,104 @@ dimeMatrix::multMatrixVec(const dimeVec3& src, dimeVec3& dst) const
 		matrix[2][3]) / W;
 }
 
+// Returns true if the matrix has no projective part, i.e. transformed
+// points need no division by W
+
+bool
+dimeMatrix::isAffine() const
+{
+	return
+		matrix[3][0] == 0.0f &&
+		matrix[3][1] == 0.0f &&
+		matrix[3][2] == 0.0f &&
+		matrix[3][3] == 1.0f;
+}
+
+// Transforms num points from src into dst, giving the same result as
+// multMatrixVec() on each point. src and dst may be the same array but
+// must otherwise not overlap. Affine matrices skip the division by W,
+// and with SSE2 two points are transformed at a time.
+
+void
+dimeMatrix::transformPoints(const dimeVec3* src, dimeVec3* dst,
+                            const int num) const
+{
+	int i = 0;
+	if (!this->isAffine())
+	{
+		for (; i < num; i++)
+		{
+			dimeVec3 copy = src[i];
+			this->multMatrixVec(copy, dst[i]);
+		}
+		return;
+	}
+
+#ifdef DIME_HAVE_SSE2
+	if (sizeof(dimeVec3) == 3 * sizeof(double))
+	{
+		// Each lane holds one point. Two consecutive points are six
+		// doubles, loaded as (x0 y0) (z0 x1) (y1 z1) and shuffled into
+		// (x0 x1) (y0 y1) (z0 z1). The terms are added in the same order
+		// as in multMatrixVec() so the results are bit identical.
+		const __m128d m00 = _mm_set1_pd(matrix[0][0]);
+		const __m128d m01 = _mm_set1_pd(matrix[0][1]);
+		const __m128d m02 = _mm_set1_pd(matrix[0][2]);
+		const __m128d m03 = _mm_set1_pd(matrix[0][3]);
+		const __m128d m10 = _mm_set1_pd(matrix[1][0]);
+		const __m128d m11 = _mm_set1_pd(matrix[1][1]);
+		const __m128d m12 = _mm_set1_pd(matrix[1][2]);
+		const __m128d m13 = _mm_set1_pd(matrix[1][3]);
+		const __m128d m20 = _mm_set1_pd(matrix[2][0]);
+		const __m128d m21 = _mm_set1_pd(matrix[2][1]);
+		const __m128d m22 = _mm_set1_pd(matrix[2][2]);
+		const __m128d m23 = _mm_set1_pd(matrix[2][3]);
+
+		for (; i + 2 <= num; i += 2)
+		{
+			const double* in = reinterpret_cast<const double*>(src + i);
+			double* out = reinterpret_cast<double*>(dst + i);
+			const __m128d p0 = _mm_loadu_pd(in);
+			const __m128d p1 = _mm_loadu_pd(in + 2);
+			const __m128d p2 = _mm_loadu_pd(in + 4);
+			const __m128d x = _mm_shuffle_pd(p0, p1, 2);
+			const __m128d y = _mm_shuffle_pd(p0, p2, 1);
+			const __m128d z = _mm_shuffle_pd(p1, p2, 2);
+
+			const __m128d rx =
+				_mm_add_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(x, m00),
+				                                 _mm_mul_pd(y, m01)),
+				                      _mm_mul_pd(z, m02)), m03);
+			const __m128d ry =
+				_mm_add_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(x, m10),
+				                                 _mm_mul_pd(y, m11)),
+				                      _mm_mul_pd(z, m12)), m13);
+			const __m128d rz =
+				_mm_add_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(x, m20),
+				                                 _mm_mul_pd(y, m21)),
+				                      _mm_mul_pd(z, m22)), m23);
+
+			_mm_storeu_pd(out, _mm_unpacklo_pd(rx, ry));
+			_mm_storeu_pd(out + 2, _mm_shuffle_pd(rz, rx, 2));
+			_mm_storeu_pd(out + 4, _mm_unpackhi_pd(ry, rz));
+		}
+	}
+#endif // DIME_HAVE_SSE2
+
+	for (; i < num; i++)
+	{
+		const dimeVec3 v = src[i];
+		dst[i].x = v.x * matrix[0][0] + v.y * matrix[0][1] + v.z * matrix[0][2] + matrix[0][3];
+		dst[i].y = v.x * matrix[1][0] + v.y * matrix[1][1] + v.z * matrix[1][2] + matrix[1][3];
+		dst[i].z = v.x * matrix[2][0] + v.y * matrix[2][1] + v.z * matrix[2][2] + matrix[2][3];
+	}
+}
+
 dimeMatrix&
 dimeMatrix::operator =(const dimeMatrix& m)
 {
-	dxfdouble* p1 = &this->matrix[0][0];
-	const dxfdouble* p2 = &m.matrix[0][0];
+	dxfmath* p1 = &this->matrix[0][0];
+	const dxfmath* p2 = &m.matrix[0][0];
 	int n = 16;
 	while (n--) *p1++ = *p2++;
 	return *this;
@@ -390,9 +488,9 @@ dimeMatrix::identity()
 }
 
 void
-dimeMatrix::operator*=(const dxfdouble s)
+dimeMatrix::operator*=(const dxfmath s)
 {
-	dxfdouble* ptr = &this->matrix[0][0];
+	dxfmath* ptr = &this->matrix[0][0];
 	int n = 16;
 	while (n--) *ptr++ *= s;
 }
@@ -402,7 +500,7 @@ dimeMatrix::inverse2()
 {
 #if 0 // OBSOLETED
   dimeMatrix A_;
-  dxfdouble detA;
+  dxfmath detA;
 
   A_.matrix[0][0]=determinant(0,0);
   A_.matrix[1][0]=-determinant(0,1);
@@ -437,11 +535,11 @@ dimeMatrix::inverse2()
 #endif // OBSOLETED
 }
 
-dxfdouble
+dxfmath
 dimeMatrix::determinant(const int i, const int j)
 {
 	int a, t;
-	dxfdouble det = 0.0f;
+	dxfmath det = 0.0f;
 
 	if (i == -1 && j == -1)
 	{
@@ -481,10 +579,10 @@ dimeMatrix::inverse()
 {
 	int n = 4;
 
-	dxfdouble (*a)[4];
-	a = (dxfdouble (*)[4])&this->matrix[0][0];
+	dxfmath (*a)[4];
+	a = (dxfmath (*)[4])&this->matrix[0][0];
 
-	dxfdouble max, s, h, q, pivot;
+	dxfmath max, s, h, q, pivot;
 	int p[4];
 	int i, j, k;
 
@@ -0,0 +1,193 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*!
+  \class dimePointSet
+  \brief The dimePointSet class stores unique points with single
+  precision coordinates.
+
+  It is used like dimeBSPTree, but the coordinates are stored as 32 bit
+  floats, and points are found with a hash table. Points are equal if
+  their coordinates are equal after conversion to float. This uses
+  about half the memory of a dimeBSPTree, and is intended for
+  coordinates relative to some nearby origin.
+*/
+
+#include <dime/util/PointSet.h>
+#include <assert.h>
+#include <string.h>
+
+/*!
+  Constructor. \a initsize is the number of points to allocate
+  room for.
+*/
+dimePointSet::dimePointSet(const int initsize)
+	: coords(initsize * 3), table(4)
+{
+	this->rehash(16);
+}
+
+/*!
+  Returns the number of points in the set.
+*/
+int
+dimePointSet::numPoints() const
+{
+	return this->coords.count() / 3;
+}
+
+/*!
+  Returns the coordinates for the point at index \a idx.
+*/
+void
+dimePointSet::getPoint(const int idx, dimeVec3& pt) const
+{
+	assert(idx < this->numPoints());
+	const float* p = this->coords.constArrayPointer() + 3 * idx;
+	pt.setValue(p[0], p[1], p[2]);
+}
+
+/*!
+  Returns a pointer to the coordinates of all the points, three floats
+  for each point. The pointer is invalidated when points are added.
+*/
+const float*
+dimePointSet::getPoints() const
+{
+	return this->coords.constArrayPointer();
+}
+
+/*!
+  Adds \a pt to the set, unless a point with the same coordinates is
+  already in it. Returns the index of the point.
+*/
+int
+dimePointSet::addPoint(const dimeVec3& pt)
+{
+	// adding 0 makes -0 and 0 equal
+	float xyz[3] = {
+		static_cast<float>(pt[0]) + 0.0f,
+		static_cast<float>(pt[1]) + 0.0f,
+		static_cast<float>(pt[2]) + 0.0f
+	};
+	int slot = this->lookup(xyz);
+	if (this->table[slot] >= 0) return this->table[slot];
+
+	const int idx = this->numPoints();
+	this->coords.append(xyz[0]);
+	this->coords.append(xyz[1]);
+	this->coords.append(xyz[2]);
+	if (2 * (idx + 1) > this->table.count())
+	{
+		this->rehash(2 * this->table.count());
+		slot = this->lookup(xyz);
+	}
+	this->table[slot] = idx;
+	return idx;
+}
+
+/*!
+  Searches for a point with coordinates \a pt. Returns the index if
+  found, -1 otherwise.
+*/
+int
+dimePointSet::findPoint(const dimeVec3& pt) const
+{
+	float xyz[3] = {
+		static_cast<float>(pt[0]) + 0.0f,
+		static_cast<float>(pt[1]) + 0.0f,
+		static_cast<float>(pt[2]) + 0.0f
+	};
+	return this->table[this->lookup(xyz)];
+}
+
+/*!
+  Removes all points.
+*/
+void
+dimePointSet::clear(const int initsize)
+{
+	this->coords.makeEmpty(initsize * 3);
+	this->table.makeEmpty(4);
+	this->rehash(16);
+}
+
+//
+// returns the slot for xyz, either the one containing it or the
+// empty slot where it should be inserted
+//
+int
+dimePointSet::lookup(const float* xyz) const
+{
+	const unsigned int mask = static_cast<unsigned int>(this->table.count()) - 1;
+	const int* tab = this->table.constArrayPointer();
+	const float* pts = this->coords.constArrayPointer();
+	unsigned int slot = this->hash(xyz) & mask;
+	for (;;)
+	{
+		const int idx = tab[slot];
+		if (idx < 0) return static_cast<int>(slot);
+		const float* p = pts + 3 * idx;
+		if (p[0] == xyz[0] && p[1] == xyz[1] && p[2] == xyz[2])
+		{
+			return static_cast<int>(slot);
+		}
+		slot = (slot + 1) & mask;
+	}
+}
+
+unsigned int
+dimePointSet::hash(const float* xyz) const
+{
+	uint32_t bits[3];
+	memcpy(bits, xyz, sizeof(bits));
+	uint32_t h = bits[0] * 0x9e3779b1u;
+	h ^= bits[1] * 0x85ebca77u + (h << 6) + (h >> 2);
+	h ^= bits[2] * 0xc2b2ae3du + (h << 6) + (h >> 2);
+	return h ^ (h >> 15);
+}
+
+//
+// resizes the hash table to size slots (a power of two)
+//
+void
+dimePointSet::rehash(const int size)
+{
+	this->table.makeEmpty(size);
+	for (int i = 0; i < size; i++) this->table.append(-1);
+	const int n = this->numPoints();
+	const float* pts = this->coords.constArrayPointer();
+	for (int i = 0; i < n; i++)
+	{
+		this->table[this->lookup(pts + 3 * i)] = i;
+	}
+}
@@ -0,0 +1,654 @@
+/**************************************************************************\
+ * Copyright (c) Kongsberg Oil & Gas Technologies AS
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 
+ * Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * 
+ * Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+\**************************************************************************/
+
+/*!
+  \class dimeTriangulator dime/util/Triangulator.h
+  \brief The dimeTriangulator class triangulates planar polygons with holes.
+
+  The first contour added is the outer boundary of the polygon, and
+  any following contours are holes. The orientation of the contours
+  does not matter. The polygon is triangulated in the XY plane, so
+  contours from planar entities should be in the entity's coordinate
+  system (OCS) when added.
+
+  The polygon is first split into y-monotone pieces with a plane sweep,
+  and each piece is then triangulated in linear time. This runs in
+  O(n log n), so polygons with many thousand vertices are handled
+  without problems.
+*/
+
+#include <dime/util/Triangulator.h>
+#include <algorithm>
+#include <set>
+#include <vector>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif // M_PI
+
+namespace {
+
+enum
+{
+	TRI_START,
+	TRI_END,
+	TRI_SPLIT,
+	TRI_MERGE,
+	TRI_REGULAR
+};
+
+struct tri_vertex
+{
+	dxfdouble x, y;
+	int index; // index of the point in the contour input
+	int prev, next;
+	int type;
+	int helper; // helper vertex for the edge starting in this vertex
+};
+
+struct tri_context;
+
+struct tri_edgeless
+{
+	const tri_context* ctx;
+	bool operator()(int a, int b) const;
+};
+
+typedef std::set<int, tri_edgeless> tri_status;
+
+struct tri_context
+{
+	std::vector<tri_vertex> v;
+	std::vector<tri_status::iterator> edgeit;
+	std::vector<char> instatus;
+	dxfdouble sweepx, sweepy;
+
+	// v[a] comes before v[b] in the sweep (from top to bottom)
+	bool above(int a, int b) const
+	{
+		if (v[a].y != v[b].y) return v[a].y > v[b].y;
+		if (v[a].x != v[b].x) return v[a].x < v[b].x;
+		return a < b;
+	}
+
+	dxfdouble cross(int a, int b, int c) const
+	{
+		return (v[b].x - v[a].x) * (v[c].y - v[b].y) -
+			(v[b].y - v[a].y) * (v[c].x - v[b].x);
+	}
+
+	// x coordinate of the edge starting in vertex e, at the sweep line.
+	// e == -1 is the current sweep point.
+	dxfdouble xAtSweep(int e) const
+	{
+		if (e < 0) return sweepx;
+		const tri_vertex& a = v[e];
+		const tri_vertex& b = v[a.next];
+		if (a.y == b.y)
+		{
+			dxfdouble minx = a.x < b.x ? a.x : b.x;
+			dxfdouble maxx = a.x < b.x ? b.x : a.x;
+			return sweepx < minx ? minx : (sweepx > maxx ? maxx : sweepx);
+		}
+		return a.x + (sweepy - a.y) * (b.x - a.x) / (b.y - a.y);
+	}
+
+	// change in x per unit the edge descends
+	dxfdouble descent(int e) const
+	{
+		int top = e;
+		int bot = v[e].next;
+		if (this->above(bot, top)) std::swap(top, bot);
+		dxfdouble dy = v[top].y - v[bot].y;
+		if (dy == 0.0) return v[bot].x > v[top].x ? 1e300 : -1e300;
+		return (v[bot].x - v[top].x) / dy;
+	}
+};
+
+bool
+tri_edgeless::operator()(const int a, const int b) const
+{
+	if (a == b) return false;
+	dxfdouble xa = ctx->xAtSweep(a);
+	dxfdouble xb = ctx->xAtSweep(b);
+	if (xa != xb) return xa < xb;
+	if (a < 0) return false;
+	if (b < 0) return true;
+	dxfdouble da = ctx->descent(a);
+	dxfdouble db = ctx->descent(b);
+	if (da != db) return da < db;
+	return a < b;
+}
+
+} // namespace
+
+/*!
+  Constructor.
+*/
+
+dimeTriangulator::dimeTriangulator()
+{
+}
+
+/*!
+  Destructor.
+*/
+
+dimeTriangulator::~dimeTriangulator()
+{
+}
+
+/*!
+  Removes all contours.
+*/
+
+void
+dimeTriangulator::clear()
+{
+	this->points.setCount(0);
+	this->contourStart.setCount(0);
+}
+
+/*!
+  Adds a closed contour with \a numpts points. The first contour is the
+  outer boundary, the rest are holes. The contour should not repeat
+  the first point at the end, but it does no harm if it does.
+*/
+
+void
+dimeTriangulator::addContour(const dimeVec3* pts, const int numpts)
+{
+	this->contourStart.append(this->points.count());
+	for (int i = 0; i < numpts; i++)
+	{
+		this->points.append(pts[i]);
+	}
+}
+
+/*!
+  Triangulates the polygon, and appends the triangles to \a indices.
+  Each triangle is stored as three indices into the added points,
+  followed by -1, which is the same layout as returned by
+  DimeEntity::extractGeometry() for polygons. All triangles are
+  counter-clockwise in the XY plane.
+
+  Returns \c false if the contours could not be triangulated, which
+  normally means that the polygon is self-intersecting. \a indices is
+  left unchanged in that case.
+*/
+
+bool
+dimeTriangulator::triangulate(dimeArray<int>& indices)
+{
+	const int numcontours = this->contourStart.count();
+	if (numcontours == 0) return false;
+
+	tri_context ctx;
+	std::vector<tri_vertex>& v = ctx.v;
+	v.reserve(this->points.count());
+
+	const dimeVec3* pts = this->points.constArrayPointer();
+	int numholes = 0;
+	int c;
+	for (c = 0; c < numcontours; c++)
+	{
+		int start = this->contourStart[c];
+		int end = c + 1 < numcontours ? this->contourStart[c + 1] :
+			this->points.count();
+
+		// skip repeated points
+		int first = static_cast<int>(v.size());
+		for (int i = start; i < end; i++)
+		{
+			if (static_cast<int>(v.size()) > first)
+			{
+				const tri_vertex& last = v.back();
+				if (last.x == pts[i][0] && last.y == pts[i][1]) continue;
+			}
+			tri_vertex tv;
+			tv.x = pts[i][0];
+			tv.y = pts[i][1];
+			tv.index = i;
+			v.push_back(tv);
+		}
+		while (static_cast<int>(v.size()) > first + 1 &&
+			v.back().x == v[first].x && v.back().y == v[first].y)
+		{
+			v.pop_back();
+		}
+		int num = static_cast<int>(v.size()) - first;
+		if (num < 3)
+		{
+			if (c == 0) return false;
+			v.resize(first);
+			continue;
+		}
+		if (c > 0) numholes++;
+
+		// the interior must be to the left of each edge, so the outer
+		// boundary is counter-clockwise and holes are clockwise.
+		dxfdouble area = 0.0;
+		int i;
+		for (i = 0; i < num; i++)
+		{
+			const tri_vertex& a = v[first + i];
+			const tri_vertex& b = v[first + (i + 1) % num];
+			area += a.x * b.y - b.x * a.y;
+		}
+		if (area == 0.0) return false;
+		bool reverse = (c == 0) != (area > 0.0);
+		for (i = 0; i < num; i++)
+		{
+			int p = first + (i + num - 1) % num;
+			int n = first + (i + 1) % num;
+			v[first + i].prev = reverse ? n : p;
+			v[first + i].next = reverse ? p : n;
+		}
+	}
+
+	const int numv = static_cast<int>(v.size());
+	std::vector<int> order(numv);
+	int i;
+	for (i = 0; i < numv; i++) order[i] = i;
+	std::sort(order.begin(), order.end(),
+	          [&ctx](int a, int b) { return ctx.above(a, b); });
+
+	for (i = 0; i < numv; i++)
+	{
+		tri_vertex& tv = v[i];
+		bool prevbelow = ctx.above(i, tv.prev);
+		bool nextbelow = ctx.above(i, tv.next);
+		bool convex = ctx.cross(tv.prev, i, tv.next) >= 0.0;
+		if (prevbelow && nextbelow) tv.type = convex ? TRI_START : TRI_SPLIT;
+		else if (!prevbelow && !nextbelow) tv.type = convex ? TRI_END : TRI_MERGE;
+		else tv.type = TRI_REGULAR;
+		tv.helper = -1;
+	}
+
+	//
+	// split into monotone polygons. Only edges with the polygon interior
+	// to their right are kept in the sweep status. Edges are identified
+	// by the index of their first vertex.
+	//
+	tri_edgeless less = {&ctx};
+	tri_status status(less);
+	ctx.edgeit.resize(numv);
+	ctx.instatus.assign(numv, 0);
+
+	std::vector<int> diagonals;
+
+	auto addDiagonal = [&diagonals](int a, int b)
+	{
+		diagonals.push_back(a);
+		diagonals.push_back(b);
+	};
+	auto insertEdge = [&](int e)
+	{
+		ctx.edgeit[e] = status.insert(e).first;
+		ctx.instatus[e] = 1;
+		v[e].helper = e;
+	};
+	auto eraseEdge = [&](int e) -> bool
+	{
+		if (!ctx.instatus[e]) return false;
+		status.erase(ctx.edgeit[e]);
+		ctx.instatus[e] = 0;
+		return true;
+	};
+	auto leftOf = [&]() -> int
+	{
+		auto it = status.lower_bound(-1);
+		if (it == status.begin()) return -1;
+		return *(--it);
+	};
+	auto isMerge = [&v](int h)
+	{
+		return h >= 0 && v[h].type == TRI_MERGE;
+	};
+
+	for (int k = 0; k < numv; k++)
+	{
+		const int cur = order[k];
+		const int prev = v[cur].prev;
+		int ej;
+		ctx.sweepx = v[cur].x;
+		ctx.sweepy = v[cur].y;
+
+		switch (v[cur].type)
+		{
+		case TRI_START:
+			insertEdge(cur);
+			break;
+		case TRI_END:
+			if (isMerge(v[prev].helper)) addDiagonal(cur, v[prev].helper);
+			if (!eraseEdge(prev)) return false;
+			break;
+		case TRI_SPLIT:
+			ej = leftOf();
+			if (ej < 0) return false;
+			addDiagonal(cur, v[ej].helper);
+			v[ej].helper = cur;
+			insertEdge(cur);
+			break;
+		case TRI_MERGE:
+			if (isMerge(v[prev].helper)) addDiagonal(cur, v[prev].helper);
+			if (!eraseEdge(prev)) return false;
+			ej = leftOf();
+			if (ej < 0) return false;
+			if (isMerge(v[ej].helper)) addDiagonal(cur, v[ej].helper);
+			v[ej].helper = cur;
+			break;
+		default:
+			if (ctx.above(prev, cur))
+			{
+				// interior is to the right of the vertex
+				if (isMerge(v[prev].helper)) addDiagonal(cur, v[prev].helper);
+				if (!eraseEdge(prev)) return false;
+				insertEdge(cur);
+			}
+			else
+			{
+				ej = leftOf();
+				if (ej < 0) return false;
+				if (isMerge(v[ej].helper)) addDiagonal(cur, v[ej].helper);
+				v[ej].helper = cur;
+			}
+			break;
+		}
+	}
+
+	//
+	// build the half edges for the monotone pieces. Boundary edges have
+	// the interior to their left, diagonals are added in both directions.
+	//
+	const int numdiag = static_cast<int>(diagonals.size()) / 2;
+	const int numhalf = numv + numdiag * 2;
+	std::vector<int> hfrom(numhalf), hto(numhalf);
+	for (i = 0; i < numv; i++)
+	{
+		hfrom[i] = i;
+		hto[i] = v[i].next;
+	}
+	for (i = 0; i < numdiag; i++)
+	{
+		int a = diagonals[i * 2];
+		int b = diagonals[i * 2 + 1];
+		hfrom[numv + i * 2] = a;
+		hto[numv + i * 2] = b;
+		hfrom[numv + i * 2 + 1] = b;
+		hto[numv + i * 2 + 1] = a;
+	}
+
+	// outgoing half edges for each vertex, sorted on angle
+	std::vector<int> outstart(numv + 1, 0);
+	for (i = 0; i < numhalf; i++) outstart[hfrom[i] + 1]++;
+	for (i = 0; i < numv; i++) outstart[i + 1] += outstart[i];
+	std::vector<int> out(numhalf);
+	std::vector<dxfdouble> angle(numhalf);
+	{
+		std::vector<int> fill(outstart.begin(), outstart.end() - 1);
+		for (i = 0; i < numhalf; i++)
+		{
+			out[fill[hfrom[i]]++] = i;
+			angle[i] = atan2(v[hto[i]].y - v[hfrom[i]].y,
+			                 v[hto[i]].x - v[hfrom[i]].x);
+		}
+	}
+	for (i = 0; i < numv; i++)
+	{
+		if (outstart[i + 1] - outstart[i] > 1)
+		{
+			std::sort(out.begin() + outstart[i], out.begin() + outstart[i + 1],
+			          [&angle](int a, int b) { return angle[a] < angle[b]; });
+		}
+	}
+
+	const int oldcount = indices.count();
+	int numtriangles = 0;
+
+	auto emit = [&](int a, int b, int c)
+	{
+		numtriangles++;
+		dxfdouble cr = ctx.cross(a, b, c);
+		if (cr == 0.0) return;
+		if (cr < 0.0) std::swap(b, c);
+		indices.append(v[a].index);
+		indices.append(v[b].index);
+		indices.append(v[c].index);
+		indices.append(-1);
+	};
+
+	std::vector<char> visited(numhalf, 0);
+	std::vector<int> face;
+	std::vector<int> sorted;
+	std::vector<char> chain;
+	std::vector<int> stack;
+
+	for (int h = 0; h < numhalf; h++)
+	{
+		if (visited[h]) continue;
+
+		// walk the face, always taking the next edge clockwise from
+		// the edge we came in on.
+		face.clear();
+		int cur = h;
+		int steps = 0;
+		do
+		{
+			if (visited[cur] || ++steps > numhalf)
+			{
+				indices.setCount(oldcount);
+				return false;
+			}
+			visited[cur] = 1;
+			face.push_back(hfrom[cur]);
+
+			int at = hto[cur];
+			dxfdouble inangle = atan2(v[hfrom[cur]].y - v[at].y,
+			                          v[hfrom[cur]].x - v[at].x);
+			int s = outstart[at];
+			int e = outstart[at + 1];
+			int next = -1;
+			for (int j = e - 1; j >= s; j--)
+			{
+				int cand = out[j];
+				if (hto[cand] == hfrom[cur] && cand != cur) continue;
+				if (angle[cand] < inangle)
+				{
+					next = cand;
+					break;
+				}
+			}
+			if (next < 0)
+			{
+				for (int j = e - 1; j >= s; j--)
+				{
+					int cand = out[j];
+					if (hto[cand] != hfrom[cur] || e - s == 1)
+					{
+						next = cand;
+						break;
+					}
+				}
+			}
+			cur = next;
+		} while (cur != h);
+
+		const int m = static_cast<int>(face.size());
+		if (m < 3) continue;
+		if (m == 3)
+		{
+			emit(face[0], face[1], face[2]);
+			continue;
+		}
+
+		//
+		// triangulate the monotone piece. The chain from the top vertex
+		// following the boundary is the left chain.
+		//
+		int top = 0, bot = 0;
+		for (i = 1; i < m; i++)
+		{
+			if (ctx.above(face[i], face[top])) top = i;
+			if (ctx.above(face[bot], face[i])) bot = i;
+		}
+		sorted.clear();
+		chain.clear();
+		sorted.push_back(face[top]);
+		chain.push_back(0);
+		int l = (top + 1) % m;
+		int r = (top + m - 1) % m;
+		while (l != bot || r != bot)
+		{
+			if (r == bot || (l != bot && ctx.above(face[l], face[r])))
+			{
+				sorted.push_back(face[l]);
+				chain.push_back(0);
+				l = (l + 1) % m;
+			}
+			else
+			{
+				sorted.push_back(face[r]);
+				chain.push_back(1);
+				r = (r + m - 1) % m;
+			}
+		}
+		sorted.push_back(face[bot]);
+		chain.push_back(1);
+
+		stack.clear();
+		stack.push_back(0);
+		stack.push_back(1);
+		for (int j = 2; j < m - 1; j++)
+		{
+			if (chain[j] != chain[stack.back()])
+			{
+				while (stack.size() > 1)
+				{
+					int s0 = stack.back();
+					stack.pop_back();
+					emit(sorted[j], sorted[s0], sorted[stack.back()]);
+				}
+				stack.clear();
+				stack.push_back(j - 1);
+				stack.push_back(j);
+			}
+			else
+			{
+				int last = stack.back();
+				stack.pop_back();
+				while (!stack.empty())
+				{
+					int a = sorted[stack.back()];
+					int b = sorted[last];
+					int cc = sorted[j];
+					bool inside = chain[j] == 0 ?
+						ctx.cross(a, b, cc) > 0.0 : ctx.cross(cc, b, a) > 0.0;
+					if (!inside) break;
+					emit(cc, b, a);
+					last = stack.back();
+					stack.pop_back();
+				}
+				stack.push_back(last);
+				stack.push_back(j);
+			}
+		}
+		while (stack.size() > 1)
+		{
+			int s0 = stack.back();
+			stack.pop_back();
+			emit(sorted[m - 1], sorted[s0], sorted[stack.back()]);
+		}
+	}
+
+	if (numtriangles != numv + 2 * numholes - 2)
+	{
+		indices.setCount(oldcount);
+		return false;
+	}
+	return true;
+}
+
+/*!
+  Tessellates the bulge arc of a polyline segment from \a p0 to \a p1,
+  and appends the points between \a p0 and \a p1 (both excluded) to
+  \a pts. \a bulge is the tangent of a quarter of the included angle,
+  and is positive for counter-clockwise arcs. The number of segments
+  is found from \a numsub (subdivisions for a full circle) if it is
+  positive, else from the maximum chord error \a maxerr.
+*/
+
+void
+dimeTriangulator::tessellateBulge(const dimeVec3& p0, const dimeVec3& p1,
+                                  const dxfdouble bulge, const dxfdouble maxerr,
+                                  const int numsub, dimeArray<dimeVec3>& pts)
+{
+	if (bulge == 0.0) return;
+
+	dxfdouble dx = p1[0] - p0[0];
+	dxfdouble dy = p1[1] - p0[1];
+	dxfdouble L = sqrt(dx * dx + dy * dy);
+	if (L == 0.0) return;
+
+	// the center lies on the left normal of the chord
+	dxfdouble offset = 0.5 * (1.0 - bulge * bulge) / (2.0 * bulge);
+	dxfdouble cx = (p0[0] + p1[0]) * 0.5 - dy * offset;
+	dxfdouble cy = (p0[1] + p1[1]) * 0.5 + dx * offset;
+
+	dxfdouble sweep = 4.0 * atan(bulge);
+	dxfdouble radius = sqrt((p0[0] - cx) * (p0[0] - cx) +
+		(p0[1] - cy) * (p0[1] - cy));
+	dxfdouble a0 = atan2(p0[1] - cy, p0[0] - cx);
+
+	int num;
+	if (numsub > 0)
+	{
+		num = static_cast<int>(ceil(numsub * fabs(sweep) / (2 * M_PI)));
+	}
+	else
+	{
+		dxfdouble err = maxerr;
+		if (err <= 0.0 || err >= radius) err = radius / 40.0;
+		dxfdouble step = 2.0 * acos(1.0 - err / radius);
+		num = static_cast<int>(ceil(fabs(sweep) / step));
+	}
+	if (num < 1) num = 1;
+
+	const dxfdouble inc = sweep / num;
+	for (int i = 1; i < num; i++)
+	{
+		dxfdouble a = a0 + inc * i;
+		pts.append(dimeVec3(cx + radius * cos(a),
+		                    cy + radius * sin(a),
+		                    p0[2]));
+	}
+}